@@ -0,0 +1,117 @@
+#pragma once
+#include <QObject>
+
+// Nested objects have different classes, because meta data doesn't parse nested objects of the same class
+class BenchLevel4 : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int value READ GetValue WRITE SetValue NOTIFY valueChanged)
+public:
+    Q_INVOKABLE BenchLevel4(QObject* parent = nullptr) : QObject(parent) {}
+
+    int  GetValue() const { return value_; }
+    void SetValue(int val)
+    {
+        value_ = val;
+        emit valueChanged();
+    }
+
+signals:
+    void valueChanged();
+
+private:
+    int value_ = 0;
+};
+
+class BenchLevel3 : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int value READ GetValue WRITE SetValue NOTIFY valueChanged)
+    Q_PROPERTY(BenchLevel4* child READ GetChild WRITE SetChild NOTIFY childChanged)
+public:
+    Q_INVOKABLE BenchLevel3(QObject* parent = nullptr) : QObject(parent) {}
+
+    int  GetValue() const { return value_; }
+    void SetValue(int val)
+    {
+        value_ = val;
+        emit valueChanged();
+    }
+
+    BenchLevel4* GetChild() const { return child_; }
+    void         SetChild(BenchLevel4* val)
+    {
+        child_ = val;
+        emit childChanged();
+    }
+
+signals:
+    void valueChanged();
+    void childChanged();
+
+private:
+    int          value_ = 0;
+    BenchLevel4* child_ = nullptr;
+};
+
+class BenchLevel2 : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int value READ GetValue WRITE SetValue NOTIFY valueChanged)
+    Q_PROPERTY(BenchLevel3* child READ GetChild WRITE SetChild NOTIFY childChanged)
+public:
+    Q_INVOKABLE BenchLevel2(QObject* parent = nullptr) : QObject(parent) {}
+
+    int  GetValue() const { return value_; }
+    void SetValue(int val)
+    {
+        value_ = val;
+        emit valueChanged();
+    }
+
+    BenchLevel3* GetChild() const { return child_; }
+    void         SetChild(BenchLevel3* val)
+    {
+        child_ = val;
+        emit childChanged();
+    }
+
+signals:
+    void valueChanged();
+    void childChanged();
+
+private:
+    int          value_ = 0;
+    BenchLevel3* child_ = nullptr;
+};
+
+class BenchLevel1 : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int value READ GetValue WRITE SetValue NOTIFY valueChanged)
+    Q_PROPERTY(BenchLevel2* child READ GetChild WRITE SetChild NOTIFY childChanged)
+public:
+    Q_INVOKABLE BenchLevel1(QObject* parent = nullptr) : QObject(parent) {}
+
+    int  GetValue() const { return value_; }
+    void SetValue(int val)
+    {
+        value_ = val;
+        emit valueChanged();
+    }
+
+    BenchLevel2* GetChild() const { return child_; }
+    void         SetChild(BenchLevel2* val)
+    {
+        child_ = val;
+        emit childChanged();
+    }
+
+signals:
+    void valueChanged();
+    void childChanged();
+
+private:
+    int          value_ = 0;
+    BenchLevel2* child_ = nullptr;
+};
@@ -0,0 +1,22 @@
+#include <QGuiApplication>
+#include <benchmark/benchmark.h>
+#include <cstdio>
+
+int main(int argc, char** argv)
+{
+    // бенчмарки запускаются без дисплея, сообщения о разборе метаданных не смешиваются с результатами
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    qInstallMessageHandler([](QtMsgType type, const QMessageLogContext&, const QString& message) {
+        if (type != QtDebugMsg && type != QtInfoMsg)
+            fprintf(stderr, "%s\n", qPrintable(message));
+    });
+
+    QGuiApplication app(argc, argv);
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
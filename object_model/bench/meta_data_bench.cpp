@@ -0,0 +1,66 @@
+#include "bench_object.h"
+
+#include <gui/object_model/object_meta_data.h>
+#include <benchmark/benchmark.h>
+
+using namespace om;
+
+namespace
+{
+const char* kDepthRoleNames[] = { "", "value", "child.value", "child.child.value", "child.child.child.value" };
+
+// Objects tree with depth 4
+struct BenchTree
+{
+    BenchTree()
+    {
+        auto level2 = new BenchLevel2(&root);
+        auto level3 = new BenchLevel3(&root);
+        auto level4 = new BenchLevel4(&root);
+        root.SetChild(level2);
+        level2->SetChild(level3);
+        level3->SetChild(level4);
+        level4->SetValue(4);
+    }
+
+    BenchLevel1 root;
+};
+
+// Reading roles object as before compiled paths: every parent object is read into QVariant
+QObject* GetRoleObjectRecursive(QObject* root, const ObjectMetaData::RoleInfo* info)
+{
+    return info->parent->id == ObjectMetaData::kItemRole ? root : info->parent->ReadFromItem(GetRoleObjectRecursive(root, info->parent)).value<QObject*>();
+}
+}  // namespace
+
+static void BM_ReadRoleRecursivePath(benchmark::State& state)
+{
+    BenchTree  tree;
+    auto       meta_data = ObjectMetaData::GetMetaData(&BenchLevel1::staticMetaObject);
+    const auto role      = meta_data->GetRoleInfo(QByteArray(kDepthRoleNames[state.range(0)]));
+    for (auto _ : state) benchmark::DoNotOptimize(role->ReadFromItem(GetRoleObjectRecursive(&tree.root, role)));
+}
+BENCHMARK(BM_ReadRoleRecursivePath)->DenseRange(1, 4)->ArgName("depth");
+
+static void BM_ReadRoleCompiledPath(benchmark::State& state)
+{
+    BenchTree  tree;
+    auto       meta_data = ObjectMetaData::GetMetaData(&BenchLevel1::staticMetaObject);
+    const auto role      = meta_data->GetRoleInfo(QByteArray(kDepthRoleNames[state.range(0)]));
+    for (auto _ : state) benchmark::DoNotOptimize(role->ReadFromRoot(&tree.root));
+}
+BENCHMARK(BM_ReadRoleCompiledPath)->DenseRange(1, 4)->ArgName("depth");
+
+// Result isn't kept, so meta data of the class is parsed on every call
+static void BM_GetMetaDataParse(benchmark::State& state)
+{
+    for (auto _ : state) benchmark::DoNotOptimize(ObjectMetaData::GetMetaData(&BenchLevel1::staticMetaObject));
+}
+BENCHMARK(BM_GetMetaDataParse);
+
+static void BM_GetMetaDataCached(benchmark::State& state)
+{
+    auto meta_data = ObjectMetaData::GetMetaData(&BenchLevel1::staticMetaObject);
+    for (auto _ : state) benchmark::DoNotOptimize(ObjectMetaData::GetMetaData(&BenchLevel1::staticMetaObject));
+}
+BENCHMARK(BM_GetMetaDataCached);
@@ -0,0 +1,100 @@
+#include "bench_object.h"
+
+#include <gui/object_model/object_model.h>
+#include <benchmark/benchmark.h>
+
+using namespace om;
+
+namespace
+{
+// Items with values equal to their rows. Model doesn't own them, so they are reused by insert and remove benchmarks
+struct ModelBenchItems
+{
+    explicit ModelBenchItems(int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            auto item = new BenchLevel1(&parent);
+            item->SetValue(i);
+            items.push_back(item);
+        }
+    }
+
+    QObject           parent;
+    QVector<QObject*> items;
+};
+}  // namespace
+
+static void BM_GetDataById(benchmark::State& state)
+{
+    ModelBenchItems items(1000);
+    ObjectRefModel  model(BenchLevel1::staticMetaObject);
+    model.AppendVector(items.items);
+    const auto role = model.GetRoleId("value");
+    int        row  = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(model.GetData(row, role));
+        row = (row + 1) % 1000;
+    }
+}
+BENCHMARK(BM_GetDataById);
+
+static void BM_GetDataByName(benchmark::State& state)
+{
+    ModelBenchItems  items(1000);
+    ObjectRefModel   model(BenchLevel1::staticMetaObject);
+    model.AppendVector(items.items);
+    const QByteArray role_name("value");
+    int              row = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(model.GetData(row, role_name));
+        row = (row + 1) % 1000;
+    }
+}
+BENCHMARK(BM_GetDataByName);
+
+// Search of the last row value: without index every item is read
+static void BM_IndexOf(benchmark::State& state)
+{
+    ModelBenchItems items(state.range(0));
+    ObjectRefModel  model(BenchLevel1::staticMetaObject);
+    model.AppendVector(items.items);
+    if (state.range(1))
+        model.CreateIndex("value");
+    const QVariant value(static_cast<int>(state.range(0) - 1));
+    for (auto _ : state) benchmark::DoNotOptimize(model.IndexOf("value", value));
+}
+BENCHMARK(BM_IndexOf)->ArgsProduct({ { 1000, 100000 }, { 0, 1 } })->ArgNames({ "rows", "indexed" });
+
+static void BM_AppendVectorRemove(benchmark::State& state)
+{
+    ModelBenchItems items(state.range(0));
+    ObjectRefModel  model(BenchLevel1::staticMetaObject);
+    for (auto _ : state)
+    {
+        model.AppendVector(items.items);
+        model.Remove(0, items.items.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AppendVectorRemove)->Arg(1000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+// Removes every second row, so removed rows are in many ranges
+static void BM_RemoveAll(benchmark::State& state)
+{
+    ModelBenchItems items(state.range(0));
+    for (int i = 1; i < items.items.size(); i += 2) static_cast<BenchLevel1*>(items.items[i])->SetValue(-1);
+    ObjectRefModel model(BenchLevel1::staticMetaObject);
+    const QVariant removed_value(-1);
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        model.SetItems(items.items);
+        state.ResumeTiming();
+        model.RemoveAll("value", removed_value);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RemoveAll)->Arg(1000)->Arg(100000)->Unit(benchmark::kMicrosecond);
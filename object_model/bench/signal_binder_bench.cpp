@@ -0,0 +1,65 @@
+#include "bench_object.h"
+
+#include <gui/object_model/signal_binder.h>
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <vector>
+
+using namespace om;
+
+namespace
+{
+class CountingReceiver : public SignalBinder::AbstractReceiver
+{
+public:
+    void OnSignalReceived(const SignalBinder::Binding&, void**) override { ++received; }
+
+    int64_t received = 0;
+};
+
+struct BinderBench
+{
+    explicit BinderBench(int count) : receiver(std::make_shared<CountingReceiver>()), binder(receiver)
+    {
+        for (int i = 0; i < count; ++i) senders.push_back(std::make_unique<BenchLevel1>());
+    }
+
+    void BindAll()
+    {
+        for (unsigned int i = 0; i < senders.size(); ++i) binder.Bind(i, senders[i].get(), signal_index);
+    }
+
+    std::shared_ptr<CountingReceiver>         receiver;
+    SignalBinder                              binder;
+    std::vector<std::unique_ptr<BenchLevel1>> senders;
+    const int                                 signal_index = BenchLevel1::staticMetaObject.indexOfSignal("valueChanged()");
+};
+}  // namespace
+
+static void BM_SignalBinderBind(benchmark::State& state)
+{
+    BinderBench bench(state.range(0));
+    for (auto _ : state)
+    {
+        bench.BindAll();
+        bench.binder.UnbindAll();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SignalBinderBind)->Arg(100)->Arg(10000);
+
+static void BM_SignalBinderDispatch(benchmark::State& state)
+{
+    BinderBench bench(state.range(0));
+    bench.BindAll();
+    int value = 0;
+    for (auto _ : state)
+    {
+        ++value;
+        for (auto& sender : bench.senders) sender->SetValue(value);
+    }
+    if (bench.receiver->received != state.iterations() * state.range(0))
+        state.SkipWithError("signals are lost");
+    state.SetItemsProcessed(bench.receiver->received);
+}
+BENCHMARK(BM_SignalBinderDispatch)->Arg(100)->Arg(10000);
@@ -0,0 +1,146 @@
+#include "bench_object.h"
+
+#include <gui/object_model/comparator.h>
+#include <gui/object_model/comparison_filter.h>
+#include <gui/object_model/enumeration_filter.h>
+#include <gui/object_model/object_model.h>
+#include <gui/object_model/regular_expression_filter.h>
+#include <gui/object_model/sort_filter_proxy_model.h>
+#include <QCoreApplication>
+#include <benchmark/benchmark.h>
+#include <random>
+
+using namespace om;
+
+namespace
+{
+struct SortBenchModel
+{
+    explicit SortBenchModel(int count, bool text_index = false)
+    {
+        if (text_index)
+            source.CreateTextIndex("objectName");
+        std::mt19937                       random(count);
+        std::uniform_int_distribution<int> distribution(0, count);
+        QVector<QObject*>                  items;
+        for (int i = 0; i < count; ++i)
+        {
+            auto item = new BenchLevel1();
+            item->SetValue(distribution(random));
+            item->setObjectName(QString("item%1").arg(distribution(random)));
+            items.push_back(item);
+        }
+        source.AppendVector(items);
+        proxy.setSourceModel(&source);
+        proxy.SetSortRole("value");
+        QCoreApplication::processEvents();
+    }
+
+    // every sort order change sorts all rows
+    void Sort()
+    {
+        proxy.ChangeSortOrder();
+        QCoreApplication::processEvents();
+    }
+
+    ObjectModel          source;  // owns items
+    SortFilterProxyModel proxy;
+};
+}  // namespace
+
+static void BM_SortVariantCompare(benchmark::State& state)
+{
+    SortBenchModel model(state.range(0));
+    // comparator on the sort role disables key extraction
+    auto comparator = new Comparator(
+        [](const QModelIndex& left, const QModelIndex& right, const Role& role) {
+            return AbstractFilterComparatorBase::DefaultVariantCompare(left.data(role.id), right.data(role.id));
+        },
+        &model.proxy);
+    comparator->SetRole("value");
+    model.proxy.SetComparator(comparator);
+    QCoreApplication::processEvents();
+    for (auto _ : state) model.Sort();
+}
+BENCHMARK(BM_SortVariantCompare)->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+static void BM_SortExtractedKeys(benchmark::State& state)
+{
+    SortBenchModel model(state.range(0));
+    for (auto _ : state) model.Sort();
+}
+BENCHMARK(BM_SortExtractedKeys)->Arg(1000)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+// Every change of the comparison value filters all rows again
+static void BM_FilterComparison(benchmark::State& state)
+{
+    SortBenchModel model(state.range(0));
+    auto           filter = new ComparisonFilter(&model.proxy);
+    model.proxy.SetFilter(filter);
+    filter->SetRole("value");
+    filter->SetComparisonOperator(ComparisonFilter::ComparisonOperator::LESS);
+    const QVariant values[] = { static_cast<int>(state.range(0) / 2), static_cast<int>(state.range(0) / 3) };
+    int            index    = 0;
+    for (auto _ : state)
+    {
+        filter->SetComparisonValue(values[index ^= 1]);
+        QCoreApplication::processEvents();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FilterComparison)->Arg(1000)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+// Every change of the substring searches all rows, with text index only the rows, that contain its trigrams, are checked
+static void BM_FilterSubstring(benchmark::State& state)
+{
+    SortBenchModel model(state.range(0), state.range(1));
+    auto           filter = new SubstringFilter(&model.proxy);
+    model.proxy.SetFilter(filter);
+    filter->SetRole("objectName");
+    const QString substrings[] = { "12345", "54321" };
+    int           index        = 0;
+    for (auto _ : state)
+    {
+        filter->SetSubstring(substrings[index ^= 1]);
+        QCoreApplication::processEvents();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+
+    auto statistics = model.source.GetTextIndexStatistics("objectName");
+    if (!statistics.isEmpty())
+    {
+        state.counters["index_build_ms"]  = statistics.value("buildTime").toLongLong() / 1e6;
+        state.counters["index_memory_mb"] = statistics.value("memoryUsage").toULongLong() / 1e6;
+    }
+}
+BENCHMARK(BM_FilterSubstring)->ArgsProduct({ { 100000, 500000 }, { 0, 1 } })->ArgNames({ "rows", "indexed" })->Unit(benchmark::kMillisecond);
+
+// Toggling one of 16 values refilters only the rows with this value
+static void BM_FilterEnumerationToggle(benchmark::State& state)
+{
+    ObjectModel       source;
+    QVector<QObject*> items;
+    for (int i = 0; i < state.range(0); ++i)
+    {
+        auto item = new BenchLevel1();
+        item->SetValue(i % 16);
+        items.push_back(item);
+    }
+    source.AppendVector(items);
+    SortFilterProxyModel proxy;
+    proxy.setSourceModel(&source);
+    auto filter = new EnumerationFilter(&proxy);
+    filter->SetRole("value");
+    filter->SetValues({ 0, 1, 2, 3, 4, 5, 6, 7 });
+    proxy.SetFilter(filter);
+    QCoreApplication::processEvents();
+
+    bool enabled = true;
+    for (auto _ : state)
+    {
+        filter->SetValue(3, enabled ^= true);
+        QCoreApplication::processEvents();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FilterEnumerationToggle)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
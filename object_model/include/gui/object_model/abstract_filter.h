@@ -12,6 +12,12 @@ class AbstractFilter : public AbstractFilterComparatorBase
     Q_PROPERTY(LogicalOperator logicalOperator READ GetLogicalOperator WRITE SetLogicalOperator NOTIFY logicalOperatorChanged)
     Q_PROPERTY(bool inverted READ IsInveted WRITE SetInverted NOTIFY invertedChanged)
 public:
+    // How accepted rows can change with filterChanged: NARROWED - only removed, WIDENED - only added,
+    // RANGE_MOVED - only rows with values between the old and the new bounds of a range filter are added or removed,
+    // VALUES_TOGGLED - only rows with the added or removed values of an enumeration filter are added or removed
+    enum class FilterChange { ANY, NARROWED, WIDENED, RANGE_MOVED, VALUES_TOGGLED };
+    Q_ENUM(FilterChange)
+
     AbstractFilter(QObject* parent = nullptr);
 
     LogicalOperator GetLogicalOperator() const;
@@ -22,6 +28,9 @@ public:
 
     virtual bool AcceptsRow(const QModelIndex& index, const IdsMap& role_ids_map) const;
 
+    // Change of the last filterChanged, so proxy refilters only accepted rows after narrowing and only rejected rows after widening
+    FilterChange GetLastChange() const;
+
 signals:
     void filterChanged();
     void logicalOperatorChanged();
@@ -29,10 +38,12 @@ signals:
 
 protected:
     virtual bool Accepts(const QModelIndex& index, const std::pair<QByteArray, int>& role) const = 0;
-    void         EmitFilterChanged();
+    // Change is given for the not inverted filter
+    void EmitFilterChanged(FilterChange change = FilterChange::ANY);
 
     LogicalOperator logical_operator_ = LogicalOperator::AND;
     bool            inverted_         = false;
+    FilterChange    last_change_      = FilterChange::ANY;
 };
 
 class AbstractRoleFilter : public AbstractFilter
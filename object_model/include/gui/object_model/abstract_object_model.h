@@ -18,6 +18,7 @@ class AbstractObjectModel : public QAbstractListModel, public ListModelAccess, p
     Q_PROPERTY(QVariant itemDataChangedRoles READ GetItemDataChangedRoles WRITE SetItemDataChangedRoles NOTIFY itemDataChangedRolesChanged)
     Q_PROPERTY(unsigned int itemDataChangedDelay READ GetItemDataChangedDelay WRITE SetItemDataChangedDelay FINAL)
     Q_PROPERTY(unsigned int itemDataChangedInterval READ GetItemDataChangedInterval WRITE SetItemDataChangedInterval FINAL)
+    Q_PROPERTY(QVariant cachedRoles READ GetCachedRoles WRITE SetCachedRoles NOTIFY cachedRolesChanged)
 public:
     static const int        kItemRole;
     static const QByteArray kItemRoleName;
@@ -50,6 +51,16 @@ public:
 
     bool IsNullRow(int row) const;
 
+    // Sorted rows of the items, whose roles are passed to itemDataChanged. Valid only while itemDataChanged is emitted
+    const QVector<int>& GetItemDataChangedRows() const;
+
+    // Typed access without QVariant, when type_id equals to the roles property type (int for enums)
+    bool ReadData(int row, int role, int type_id, void* out) const override;
+    int  ReadColumnData(int role, int first, int count, int type_id, void* out, size_t value_size) const override;
+
+    // Sorted rows, whose string values of the role can contain text. Returns false, if the role has no text index or text is too short for it
+    virtual bool FindTextRows(int role, const QString& text, QVector<int>& rows) const;
+
     // Overridden
     Id GetRoleId(const QByteArray& role_name) const override;
 
@@ -70,12 +81,20 @@ public:
     unsigned int GetItemDataChangedInterval() const;
     void         SetItemDataChangedInterval(unsigned int val);
 
+    // Roles whose values will be cached in typed columns and read without meta calls until their notifiers are emitted.
+    // Only int, enum, double, bool and QString roles with notifiers (or constant) can be cached. If set to DataRolesPolicy::ITEM_ROLE cache is disabled.
+    QVariant GetCachedRoles() const;
+    void     SetCachedRoles(const QVariant& val);
+
 public slots:
     int      GetCount() const override;
     QVariant GetData(int row, const QByteArray& role_name = AbstractObjectModel::kItemRoleName) const override;
     bool     SetData(int row, const QVariant& value, const QByteArray& role_name = AbstractObjectModel::kItemRoleName) override;
     bool     SetData(int row, const QVariantMap& values);
 
+    // role name, bytes allocated by the cached roles column
+    QVariantMap GetCachedRolesMemoryUsage() const;
+
 signals:
     // Notifiers
     void initialized();
@@ -83,6 +102,7 @@ signals:
     void dataRolesChanged();
     void itemDataChanged(const Ids& changed_roles);
     void itemDataChangedRolesChanged();
+    void cachedRolesChanged();
     void itemInstalled(QObject* item);
     void itemUninstalled(QObject* item);
 
@@ -97,8 +117,11 @@ protected:
     virtual bool     SetItemsProperty(QObject* item, const QVariant& value, const QByteArray& role_name) const;
 
     virtual void ItemAboutToBeDeleted(QObject*) {};
+    // Called synchronously when notifiers of the observed roles are emitted. Roles contain changed observed roles only
+    virtual void ItemRolesChanged(QObject*, const Ids&) {};
 
     virtual QObject* GetItem(int row) const         = 0;
+    virtual int      GetItemRow(QObject* item) const;  // -1 if model doesn't contain item. Rows are cached until the row signals
     virtual bool     SetItem(int row, QObject* val) = 0;
 
     void InitializeMetaObject(const QMetaObject* meta_object);
@@ -112,10 +135,15 @@ protected:
 
     void UpdateDataRoles();
     void UpdateDataChangeRoles();
+    void UpdateCachedRoles();
     void UpdateItemsConnections();
 
     void SetDynamicRoles(const Ids& val) override;
 
+    // Roles whose changes will be passed to ItemRolesChanged. Notifiers of the roles and their parent roles are connected immediately
+    void       SetObservedRoles(const Ids& val);
+    const Ids& GetObservedRoles() const;
+
 private:
 //    COMPONENT_LOGGER("ui.aom");
 
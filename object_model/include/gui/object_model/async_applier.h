@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QObject>
+#include <functional>
+#include <memory>
+
+class QThreadPool;
+
+namespace om
+{
+// Runs tasks of the object in the thread pool and calls their results in the object's thread.
+// Only the result of the last started task is called: results of the older tasks are dropped, even if they are ready first.
+// Must be used in the object's thread
+class AsyncApplier
+{
+public:
+    using Apply = std::function<void()>;
+    // Is called in the thread pool. Returns function, that is called in the object's thread, or empty function to drop the result
+    using Task = std::function<Apply()>;
+
+    explicit AsyncApplier(QObject* object);
+    // Results of the running tasks are dropped
+    ~AsyncApplier();
+    AsyncApplier(const AsyncApplier&) = delete;
+    AsyncApplier& operator=(const AsyncApplier&) = delete;
+
+    // Global thread pool by default
+    QThreadPool* GetThreadPool() const;
+    void         SetThreadPool(QThreadPool* pool);
+
+    void Start(Task task);
+    // Drops results of the started tasks
+    void Cancel();
+    bool IsRunning() const;  // result of the last started task isn't called yet
+
+    quint64 GetAppliedCount() const;
+    quint64 GetDroppedCount() const;  // results, dropped as stale or empty
+
+private:
+    struct State;
+
+    std::shared_ptr<State> state_;
+    QThreadPool*           pool_ = nullptr;
+};
+}  // namespace om
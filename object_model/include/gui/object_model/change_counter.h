@@ -0,0 +1,25 @@
+#pragma once
+
+#include <QtGlobal>
+
+class QObject;
+
+namespace om
+{
+// Counter of the changes of the object tree: a change of the object is counted by it and by all its QObject ancestors, that are counters too.
+// So equal counts mean, that nothing in the tree of the object has changed between them
+class ChangeCounter
+{
+public:
+    virtual ~ChangeCounter() = default;
+
+    quint64 GetChangeCount() const;
+
+protected:
+    // object - the counter itself, the change is counted up to the first ancestor, that isn't a counter
+    static void MarkChanged(QObject* object);
+
+private:
+    quint64 change_count_ = 0;
+};
+}  // namespace om
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QObject>
+#include <memory>
+#include <vector>
+
+namespace om
+{
+// Coalesces queued change notifications of many objects into one posted event per thread.
+// Objects with queued changes are linked into intrusive lists by their depth in the objects tree and flushed deepest first,
+// so the parent, that listens to changed() of its children, emits its own changed() once after all of them.
+// Object, that is changed in another thread (before it is moved to its own thread), is queued to the dispatcher of its thread by a posted event.
+// Dispatched objects must call Entry::OnThreadChange on QEvent::ThreadChange, so their queued flush moves with them to the new thread.
+// Objects, that are still queued, when the thread finishes, are flushed by the destructor of its dispatcher
+class ChangeDispatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Node of the list of objects with queued changes. Is a member of the dispatched object
+    class Entry
+    {
+    public:
+        using FlushFunction = void (*)(QObject* object);
+
+        Entry(QObject* object, FlushFunction flush);
+        ~Entry();
+        Entry(const Entry&) = delete;
+        Entry& operator=(const Entry&) = delete;
+
+        // Queues flush of the object to the dispatcher of the object's thread. Does nothing, if it is already queued
+        void Enqueue();
+        bool IsQueued() const;
+        // Must be called from event() of the object on QEvent::ThreadChange
+        void OnThreadChange();
+
+    private:
+        friend class ChangeDispatcher;
+
+        void PostEnqueue();  // Enqueue in the object's thread
+        void Unlink();
+        void LinkBefore(Entry* next);
+
+        QObject*      object_      = nullptr;
+        FlushFunction flush_       = nullptr;
+        Entry*        prev_        = nullptr;
+        Entry*        next_        = nullptr;  // nullptr, if entry isn't queued
+        int           depth_       = 0;        // depth of the object in the objects tree
+        quint64       flush_cycle_ = 0;        // last cycle, that flushed the object
+    };
+
+    ~ChangeDispatcher() override;
+
+    // Dispatcher of the current thread
+    static ChangeDispatcher* GetInstance();
+
+    int     GetLastFlushCount() const;  // number of objects, flushed by the last cycle
+    quint64 GetFlushCycle() const;      // number of flush cycles
+
+private:
+    ChangeDispatcher();
+
+    static bool IsEmpty(const Entry& list);
+
+    void   Enqueue(Entry* entry);
+    void   Flush();
+    void   PostFlush();
+    Entry* GetLevel(int depth);  // list of the queued objects with the depth
+
+    std::vector<std::unique_ptr<Entry>> levels_;                      // queued objects by their depth
+    Entry                               deferred_{ nullptr, nullptr };  // objects, that were changed again after their flush in the current cycle
+    int                                 max_depth_        = -1;       // maximal depth of the queued objects
+    bool                                flushing_         = false;
+    bool                                closing_          = false;  // thread finishes, all objects are flushed at once
+    bool                                flush_posted_     = false;
+    int                                 last_flush_count_ = 0;
+    quint64                             flush_cycle_      = 0;
+};
+}  // namespace om
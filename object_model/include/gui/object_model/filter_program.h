@@ -0,0 +1,209 @@
+#pragma once
+
+#include "abstract_filter_comparator_base.h"
+#include "comparison_filter.h"
+#include "roles.h"
+#include <QAbstractItemModel>
+#include <QBitArray>
+#include <QHash>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QStringMatcher>
+#include <QVector>
+#include <boost/container/flat_map.hpp>
+#include <boost/container/flat_set.hpp>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace om
+{
+class AbstractFilter;
+
+// Filter tree, compiled into a flat postfix program with resolved role ids.
+// Program is evaluated column at a time: values of each used role are read once for all rows into typed columns,
+// every instruction computes selection bitmap of the rows, bitmaps of the groups are combined by AND/OR.
+// Filters of other classes and filters with roles, that the model doesn't have, are called row by row through AcceptsRow.
+// Parameters of the filters are copied, so the program must be compiled again after filterChanged and rolesChanged.
+// Strings of the substring and regular expression roles (case folded for case insensitive substrings) are cached by source rows
+// while compiled filters search in them, so refining search doesn't read and fold them again on every keystroke.
+// If the source model has text index of the role, substrings and literal prefixes of the regular expressions are searched only in the rows,
+// that the index returns.
+// When compilation changes only bounds of the ranges or values of the enumerations, rows with values between the old and the new bounds
+// are found by sorted indexes of the range roles and rows with toggled values by bitmaps of the enumeration values, so they don't check all rows.
+// Enumerations of many rows are evaluated as OR of the bitmaps of their values. Bitmaps of the instructions are combined by 64-bit words.
+// Evaluation can be split: Read reads values, caches and indexes of the model and calls filters of other classes in the model's thread,
+// then the snapshot is evaluated in any thread (comparisons, substrings and regular expressions of all rows)
+class FilterProgram
+{
+public:
+    struct Snapshot;
+
+    void Compile(const AbstractFilter* filter, const IdsMap& role_ids_map);
+    void Clear();  // accepts all rows
+
+    void InvalidateCache(const QVector<int>& source_rows);  // values of the rows are changed
+    void ClearCache();                                      // rows are inserted, removed or moved
+    int  GetCachedRoleCount() const { return string_caches_.size(); }
+
+    // Sorted source rows, whose values are between the old and the new bounds of the ranges or equal to the added and removed values
+    // of the enumerations, changed by compilations since the last call or reset. Returns false, if compilations changed other instructions too,
+    // then any row can change
+    bool TakeChangedRows(const QAbstractItemModel* model, QVector<int>& source_rows);
+    void ResetChangedRows();
+
+    int GetInstructionCount() const { return instructions_.size(); }
+    int GetRowCallCount() const;  // instructions, that call AcceptsRow of the filter for every row
+
+    // Bit i is set, if source_rows[i] is accepted
+    QBitArray Evaluate(const QAbstractItemModel* model, const QVector<int>& source_rows) const;
+    // Copies the program with the values of the rows, so the snapshot doesn't depend on the program and the model
+    std::shared_ptr<const Snapshot> Read(const QAbstractItemModel* model, const QVector<int>& source_rows) const;
+    static QBitArray                Evaluate(const Snapshot& snapshot);
+
+private:
+    enum OpCode { ACCEPT_ALL, REJECT_ALL, COMPARE, RANGE, ENUMERATION, STRING_ENUMERATION, SUBSTRING, REGULAR_EXPRESSION, NOT_NULL_OBJECT, CALL_FILTER, AND, OR };
+    enum ColumnType { VARIANT_COLUMN, INT_COLUMN, DOUBLE_COLUMN, STRING_COLUMN };
+
+    struct Instruction
+    {
+        OpCode op       = ACCEPT_ALL;
+        int    column   = -1;     // index of the role column
+        int    operands = 0;      // bitmaps, combined by AND/OR
+        bool   inverted = false;  // result is inverted
+        bool   folded   = false;  // substring is searched in case folded strings
+
+        QString indexed_text;  // every matching string contains it, candidate rows are found by the text index of the model
+
+        QVariant                                    value;
+        ComparisonFilter::ComparisonOperator        comparison_operator = ComparisonFilter::ComparisonOperator::EQUAL;
+        double                                      from                = 0;
+        double                                      to                  = 0;
+        AbstractFilterComparatorBase::RangeCheckType range_check_type   = AbstractFilterComparatorBase::RangeCheckType::INSIDE;
+        boost::container::flat_set<int>             ints;
+        boost::container::flat_set<QString>         strings;
+        QStringMatcher                              matcher;
+        QRegularExpression                          regular_expression;
+        const AbstractFilter*                       filter = nullptr;  // is removed from the tree with recompilation before deletion
+    };
+
+    // Bits of the rows in 64-bit words, operations on bitmaps of the same size are word loops, that compiler vectorizes
+    struct Bitmap
+    {
+        explicit Bitmap(int size = 0, bool value = false);
+
+        bool TestBit(int i) const { return words[i >> 6] >> (i & 63) & 1; }
+        void SetBit(int i) { words[i >> 6] |= quint64(1) << (i & 63); }
+        void ClearBit(int i) { words[i >> 6] &= ~(quint64(1) << (i & 63)); }
+
+        Bitmap& operator&=(const Bitmap& other);
+        Bitmap& operator|=(const Bitmap& other);
+        void    Invert();
+
+        template <typename Function>
+        void      ForEachSetBit(Function function) const;
+        QBitArray ToBitArray() const;
+
+        int                  size = 0;
+        std::vector<quint64> words;
+    };
+
+    struct StringCache
+    {
+        enum State : quint8 { EMPTY = 0x0, STRING = 0x1, FOLDED = 0x2 };
+
+        std::vector<quint8>  states;  // index = source row
+        std::vector<QString> strings;
+        std::vector<QString> folded;
+    };
+
+    struct RangeIndex
+    {
+        std::vector<std::pair<double, int>> entries;     // value, source row. Sorted, without not numeric values
+        std::vector<double>                 values;      // index = source row, NaN for not numeric values
+        std::vector<int>                    stale_rows;  // values of the rows are changed
+    };
+
+    struct ValueIndex
+    {
+        // Index of the value bitmap, -1 for values, that enumeration doesn't accept
+        int GetValueId(const QString& key, int row_count);
+
+        QHash<QString, int> value_ids;   // key of the value, index of its bitmap
+        std::vector<Bitmap> bitmaps;     // source rows with the value
+        std::vector<int>    row_values;  // index = source row, value id
+        std::vector<int>    stale_rows;  // values of the rows are changed
+    };
+
+    struct ChangedValues
+    {
+        Id          role = kInvalidId;
+        OpCode      op   = RANGE;  // RANGE - values in the closed interval, ENUMERATION and STRING_ENUMERATION - values with the keys
+        double      from = 0;
+        double      to   = 0;
+        QStringList keys;
+    };
+
+    struct Column
+    {
+        ColumnType            type    = VARIANT_COLUMN;
+        int                   type_id = QMetaType::UnknownType;  // common type of the values
+        std::vector<QVariant> values;
+        std::vector<qint64>   ints;
+        std::vector<double>   doubles;
+        std::vector<QString>  strings;
+    };
+
+    // Prepared input of the instruction: bitmap, selected in the model's thread, or strings and candidates of the text search
+    struct Operand
+    {
+        bool                 selected = false;
+        Bitmap               bits;
+        bool                 indexed = false;
+        Bitmap               candidates;
+        std::vector<QString> strings;
+    };
+
+public:
+    struct Snapshot
+    {
+        int                      count = 0;
+        std::vector<Instruction> instructions;
+        std::vector<Column>      columns;
+        std::vector<Operand>     operands;  // index = instruction
+    };
+
+private:
+    void CompileFilter(const AbstractFilter* filter);
+    void CompileRoleFilter(const AbstractFilter* filter, const Instruction& instruction);
+    void Push(OpCode op, int operands, bool inverted = false);
+    int  GetColumnIndex(Id role);
+    void UpdateChangedValues(const std::vector<Instruction>& old_instructions, const std::vector<Id>& old_column_roles);
+    const RangeIndex& GetRangeIndex(const QAbstractItemModel* model, Id role);
+    const ValueIndex& GetValueIndex(const QAbstractItemModel* model, Id role, OpCode op) const;
+    // Empty key for the values, that enumeration doesn't accept
+    static QString ReadEnumerationKey(const QAbstractItemModel* model, int source_row, Id role, OpCode op);
+
+    static void ReadColumn(const QAbstractItemModel* model, const QVector<int>& source_rows, Id role, Column& column);
+    // strings - strings of the rows for the substring and regular expression instructions
+    static void SelectRows(const Instruction& instruction, const Column& column, const std::vector<QString>& strings, Bitmap& bits);
+    // Bit i is set, if source_rows[i] contains text by the text index of the model. Returns false, if the index can't be used
+    static bool SelectCandidates(const QAbstractItemModel* model, const QVector<int>& source_rows, Id role, const QString& text, Bitmap& candidates);
+    // Enumeration by the bitmaps of its values. Returns false for a few rows, that are checked faster by their values
+    bool SelectValueRows(const QAbstractItemModel* model, const QVector<int>& source_rows, const Instruction& instruction, Bitmap& bits) const;
+    // Values of the column are used for the rows, that are not cached, if they are read. Strings of not candidates are empty and not read
+    void ReadCachedStrings(const QAbstractItemModel* model, const QVector<int>& source_rows, Id role, bool folded, const Column& column,
+                           const Bitmap* candidates, std::vector<QString>& strings) const;
+
+    std::vector<Instruction> instructions_;
+    std::vector<Id>          column_roles_;
+    std::vector<char>        column_values_;  // values of the column are read by instructions, that don't use the cache
+    IdsMap                   role_ids_map_;
+
+    mutable boost::container::flat_map<Id, StringCache>                    string_caches_;
+    boost::container::flat_map<Id, RangeIndex>                             range_indexes_;
+    mutable boost::container::flat_map<std::pair<Id, OpCode>, ValueIndex> value_indexes_;
+    std::vector<ChangedValues>                                             changed_values_;
+    bool                                                                   changed_values_valid_ = true;
+};
+}  // namespace om
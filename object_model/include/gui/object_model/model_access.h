@@ -25,5 +25,39 @@ public:
     virtual QVariant GetData(int row, const QByteArray& role_name) const { return GetData(row, GetRoleId(role_name)); };
     virtual bool     SetData(int, const QVariant&, int) { return false; };
     virtual bool     SetData(int row, const QVariant& value, const QByteArray& role_name) { return SetData(row, value, GetRoleId(role_name)); };
+
+    // Typed access. Models can read values directly to the callers storage, without QVariant. T must be registered in meta type system
+    template <typename T>
+    T GetValue(int row, int role) const
+    {
+        T res{};
+        ReadData(row, role, qMetaTypeId<T>(), &res);
+        return res;
+    }
+
+    // Reads values of the rows [first, first + count) to out. Returns number of read values, values that weren't read stay unchanged
+    template <typename T>
+    int ReadColumn(int role, int first, int count, T* out) const
+    {
+        return ReadColumnData(role, first, count, qMetaTypeId<T>(), out, sizeof(T));
+    }
+
+    // Reads value to the already constructed object of type_id type
+    virtual bool ReadData(int row, int role, int type_id, void* out) const
+    {
+        auto val = GetData(row, role);
+        if (!val.isValid() || (val.userType() != type_id && !val.convert(type_id)))
+            return false;
+        QMetaType::destruct(type_id, out);
+        QMetaType::construct(type_id, out, val.constData());
+        return true;
+    }
+
+    virtual int ReadColumnData(int role, int first, int count, int type_id, void* out, size_t value_size) const
+    {
+        int res = 0;
+        for (int i = 0; i < count; ++i) res += ReadData(first + i, role, type_id, static_cast<char*>(out) + i * value_size);
+        return res;
+    }
 };
 }  // namespace om
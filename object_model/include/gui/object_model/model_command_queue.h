@@ -0,0 +1,89 @@
+#pragma once
+
+#include <QBasicTimer>
+#include <QHash>
+#include <QMap>
+#include <QObject>
+#include <QPointer>
+#include <QVector>
+#include <atomic>
+#include <functional>
+
+namespace om
+{
+class ObjectRefModel;
+
+// Queue of the model changes, that any threads push without locking and the model's thread applies once per timer tick.
+// Consecutive appends are applied by one AppendVector, repeated sets of the same row between other changes are applied by one Set.
+// Items, that don't get into the model (replaced by the collapsed sets, rejected by the unique indexes or left after the model is deleted),
+// are deleted, if the model is ObjectModel, that owns its items, otherwise they are returned by itemsDiscarded.
+// Items must be moved to the model's thread before they are pushed
+class ModelCommandQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Command = std::function<void(ObjectRefModel* model)>;
+
+    // Queue is moved to the model's thread and drains every interval milliseconds
+    explicit ModelCommandQueue(ObjectRefModel* model, int interval = 16);
+    // Applies the remaining commands, if the model still exists. Must be called in the model's thread, other threads delete the queue by deleteLater
+    ~ModelCommandQueue() override;
+
+    void PushAppend(QObject* item);
+    void PushSet(int row, QObject* item);
+    // Sets item instead of prev, the row of prev is found on drain
+    void PushReplace(QObject* prev, QObject* item);
+    // Is called as is after all previous commands
+    void Push(Command command);
+
+    // Applies all pushed commands. Must be called in the model's thread
+    void Drain();
+
+    int     GetInterval() const;
+    int     GetQueueDepth() const;           // pushed commands, that are not drained yet
+    qint64  GetLastDrainTime() const;        // nanoseconds
+    int     GetLastDrainCommands() const;    // commands, drained by the last drain
+    int     GetLastDrainOperations() const;  // model changes, made by the last drain
+    quint64 GetDrainCount() const;
+
+signals:
+    // Items of ObjectRefModel, that the queue didn't add to the model. Caller owns them
+    void itemsDiscarded(const QVector<QObject*>& items);
+
+protected:
+    void timerEvent(QTimerEvent* event) override;
+
+private:
+    struct Node;
+
+    void Push(Node* node);
+    void Apply(Node* node);
+    void AppendPending(QObject* item);
+    void SetPending(int row, QObject* item);
+    void ReplacePending(QObject* prev, QObject* item);
+    void FlushPending();
+    void DiscardPending();
+    void Discard(QVector<QObject*> items);
+
+    QPointer<ObjectRefModel> model_;
+    QBasicTimer              timer_;
+    int                      interval_   = 16;
+    bool                     owns_items_ = true;  // элементы, не попавшие в модель, удаляются
+
+    std::atomic<Node*> head_{ nullptr };  // стек добавленных команд, последняя - первая
+    std::atomic<int>   depth_{ 0 };
+
+    // Отложенные изменения текущей выборки, применяются перед любой другой командой
+    QVector<QObject*>     appends_;
+    QHash<QObject*, int>  append_rows_;  // элемент, индекс в appends_
+    QMap<int, QObject*>   sets_;         // строка, элемент
+    QHash<QObject*, int>  set_rows_;     // элемент, строка
+
+    qint64  last_drain_time_       = 0;
+    int     last_drain_commands_   = 0;
+    int     last_drain_operations_ = 0;
+    int     operations_            = 0;
+    quint64 drain_count_           = 0;
+};
+}  // namespace om
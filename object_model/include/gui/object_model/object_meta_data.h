@@ -30,6 +30,12 @@ public:
         {
             if (parent)
                 inherited = parent->parent ? parent->inherited : property.propertyIndex() < parent->meta_object->propertyOffset();
+            if (parent && parent->parent)
+            {
+                path = parent->path;
+                path.push_back(parent->property.propertyIndex());
+                path_compiled = parent->path_compiled && QMetaType::typeFlags(parent->property.userType()).testFlag(QMetaType::PointerToQObject);
+            }
         }
 
         Id                           id = kInvalidId;
@@ -41,13 +47,20 @@ public:
         std::vector<const RoleInfo*> children;
         Ids                          dependent_role_ids;  // own role id and all ids of the children tree
         bool                         inherited = false;
+        // property indexes of the parent objects from the root to the roles object. Not compiled if some parent isn't a QObject pointer
+        boost::container::small_vector<int, 4> path;
+        bool                                   path_compiled = true;
 
         inline bool IsSignal() const;
         inline bool IsObjectName() const;
 
+        // Returns object that contains roles property
+        QObject* GetObjectFromRoot(QObject* root) const;
         // Can not move this methods to ObjectMetaData, because we don't always have a pointer to its instance.
         QVariant ReadFromRoot(QObject* root) const;
         QVariant ReadFromItem(QObject* item) const;
+        // Reads property directly to the constructed object of the property type (int for enums)
+        bool ReadFromRoot(QObject* root, void* data) const;
         bool     WriteToRoot(QObject* root, const QVariant& val) const;
         bool     WriteToItem(QObject* item, const QVariant& val) const;
     };
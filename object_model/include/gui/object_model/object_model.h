@@ -1,6 +1,8 @@
 #pragma once
 
 #include "abstract_object_model.h"
+#include "role_index.h"
+#include "trigram_index.h"
 
 #include <QQmlListProperty>
 
@@ -12,6 +14,7 @@ class ObjectRefModel : public AbstractObjectModel
     Q_OBJECT
     Q_PROPERTY(QVector<QObject*> itemList READ GetItems WRITE SetItems)
     Q_PROPERTY(QStringList itemNames READ GetItemNames)
+    Q_PROPERTY(double removeResetRatio READ GetRemoveResetRatio WRITE SetRemoveResetRatio FINAL)
 
 public:
     using const_iterator = QVector<QObject*>::const_iterator;
@@ -38,6 +41,12 @@ public:
 
     QString DebugString() const;
 
+    bool FindTextRows(int role, const QString& text, QVector<int>& rows) const override;
+
+    // When RemoveAll/RemoveAllIf removes at least this part of the rows in more than one range, model is reset instead of emitting rowsRemoved for every range
+    double GetRemoveResetRatio() const { return remove_reset_ratio_; }
+    void   SetRemoveResetRatio(double val) { remove_reset_ratio_ = val; }
+
 public slots:
     QObject* At(int row) const;
     QObject* First() const;
@@ -62,6 +71,21 @@ public slots:
     QVector<QObject*> Find(const QByteArray& property_name, const QVariant& val) const;
     QVector<QObject*> Find(const QVariantMap& props) const;
 
+    // Search functions will use hash index of the role values, instead of reading property of every item.
+    // Index is updated on item's notifiers, so role must have notifier. Use "objectName" role to index search by object names.
+    // Unique index makes Insert, Append, Set and SetItems reject items, whose value equals the value of another item.
+    // Values, that the items change later, can't be rejected, their duplicates are logged
+    bool CreateIndex(const QByteArray& role_name, bool unique = false);
+    void RemoveIndex(const QByteArray& role_name);
+    bool HasIndex(const QByteArray& role_name) const;
+
+    // SubstringFilter and literal prefixes of RegularExpressionFilter patterns of SortFilterProxyModel will check only rows,
+    // whose values contain all trigrams of the searched text. Index is updated on item's notifiers, so string role must have notifier
+    bool        CreateTextIndex(const QByteArray& role_name);
+    void        RemoveTextIndex(const QByteArray& role_name);
+    bool        HasTextIndex(const QByteArray& role_name) const;
+    QVariantMap GetTextIndexStatistics(const QByteArray& role_name) const;  // items, trigrams, buildTime (ns), memoryUsage (bytes)
+
     QObject* Take(int row);
     QObject* TakeFirst();
     QObject* TakeLast();
@@ -75,6 +99,7 @@ public slots:
     void     AppendModel(ObjectRefModel* items);
     QObject* Insert(int row, QObject* item = nullptr);
     QObject* Set(int row, QObject* item = nullptr);
+    // Moves count items from the row from, so that the first of them is at the row to after the move
     void     Move(int from, int to, int count = 1);
     void     Remove(int row, int count = 1);
     void     Remove(QObject* item);
@@ -90,19 +115,47 @@ protected:
 //    COMPONENT_LOGGER("ui.orm");
 
     void ItemAboutToBeDeleted(QObject* item) override;
+    void ItemRolesChanged(QObject* item, const Ids& roles) override;
 
     QObject* GetItem(int row) const override;
     bool     SetItem(int row, QObject* val) override;
 
     bool removeRows(int row, int count, const QModelIndex& parent = QModelIndex());
+    // Removes rows with one signal per contiguous range or with model reset. Rows must be sorted
+    void RemoveSortedRows(const QVector<int>& rows);
+    // Called by the model reset of RemoveSortedRows after the items are compacted, before modelReset.
+    // removed_ranges - sorted first row and count of the removed rows before the compaction
+    virtual void ItemsCompacted(const QVector<QPair<int, int>>& removed_ranges) { Q_UNUSED(removed_ranges) }
+    // Rearranges items with minimal row signals. new_to_old[new_row] is the current row of the item or -1 for the item created by create_item.
+    // Rows, that are not in new_to_old, are removed. Items of the longest increasing subsequence of the kept rows are not moved,
+    // the others are moved one by one or, if there are many of them, with one layout change. Created items are inserted by contiguous ranges
+    void SyncItems(const QVector<int>& new_to_old, const std::function<QObject*(int row)>& create_item);
     bool moveRows(const QModelIndex& sourceParent, int sourceRow, int count, const QModelIndex& destinationParent, int destinationChild);
 
     virtual bool CanAddItem(QObject* item) const;
     bool         CanAddItems(const QVector<QObject*>& items) const;
+    // Values of the unique indexes roles differ between items and from the model items (except replaced, if it isn't nullptr)
+    bool HasUniqueValues(const QVector<QObject*>& items, bool check_model_items = true, QObject* replaced = nullptr) const;
 
     virtual void InstallItem(int row) override;
+    virtual void UninstallItem(int row, bool taken = false) override;
+
+    // Indexes
+    void UpdateIndexes();
+    // Returns false, if role has no index. Rows are sorted
+    bool FindIndexedRows(const QByteArray& role_name, const QVariant& val, QVector<int>& rows) const;
+    bool FindIndexedRows(const QVariantMap& props, QVector<int>& rows) const;
+    int  GetItemRow(QObject* item) const override;
+    void InvalidateItemRows(int row);
 
     QVector<QObject*> items_;
+
+private:
+    QHash<QByteArray, RoleIndex>    indexes_;       // role name, index
+    QHash<QByteArray, TrigramIndex> text_indexes_;  // role name, index
+    mutable QHash<QObject*, int>    item_rows_;
+    mutable int                     item_rows_valid_ = 0;  // rows before this one are valid in item_rows_
+    double                          remove_reset_ratio_ = 0.5;
 };
 
 // Class for basic QML/c++ model that that returns item class object pointer to QML, providing easy access to it, both from QML and c++.
@@ -120,7 +120,9 @@ template <typename Key, typename T>
 T *ObjectModelMapWrapper<Key, T>::Take(const Key &key)
 {
     auto res = map_.take(key);
-    if (res)
+    if (res && this->queue_)
+        this->queue_->Push([res](ObjectRefModel *model) { model->Take(model->IndexOf(res)); });
+    else if (res)
         QMetaObject::invokeMethod(this->model_, "Take", Qt::AutoConnection, Q_ARG(int, this->model_->IndexOf(res)));
     return res;
 }
@@ -135,7 +137,12 @@ void ObjectModelMapWrapper<Key, T>::Insert(const Key &key, T *item)
         item->moveToThread(QGuiApplication::instance()->thread());
 
     const auto prev_item = map_.value(key, nullptr);
-    if (prev_item)
+    // в режиме очереди строка заменяемого элемента находится при применении команды, повторные вставки ключа схлопываются
+    if (this->queue_ && prev_item)
+        this->queue_->PushReplace(prev_item, item);
+    else if (this->queue_)
+        this->queue_->PushAppend(item);
+    else if (prev_item)
         QMetaObject::invokeMethod(this->model_, "Set", Qt::AutoConnection, Q_ARG(int, this->model_->IndexOf(prev_item)), Q_ARG(QObject *, item));
     else
         QMetaObject::invokeMethod(this->model_, "Append", Qt::AutoConnection, Q_ARG(QObject *, item));
@@ -145,21 +152,32 @@ void ObjectModelMapWrapper<Key, T>::Insert(const Key &key, T *item)
 template <typename Key, typename T>
 void ObjectModelMapWrapper<Key, T>::Remove(const Key &key)
 {
-    if (map_.contains(key))
-        QMetaObject::invokeMethod(this->model_, "Remove", Qt::AutoConnection, Q_ARG(QObject *, map_[key]));
+    if (!map_.contains(key))
+        return;
+    auto item = map_[key];
+    if (this->queue_)
+        this->queue_->Push([item](ObjectRefModel *model) { model->Remove(item); });
+    else
+        QMetaObject::invokeMethod(this->model_, "Remove", Qt::AutoConnection, Q_ARG(QObject *, item));
 }
 
 template <typename Key, typename T>
 void ObjectModelMapWrapper<Key, T>::Remove(T *item)
 {
-    QMetaObject::invokeMethod(this->model_, "Remove", Qt::AutoConnection, Q_ARG(QObject *, item));
+    if (this->queue_)
+        this->queue_->Push([item](ObjectRefModel *model) { model->Remove(item); });
+    else
+        QMetaObject::invokeMethod(this->model_, "Remove", Qt::AutoConnection, Q_ARG(QObject *, item));
 }
 
 template <typename Key, typename T>
 void ObjectModelMapWrapper<Key, T>::Clear()
 {
     map_.clear();
-    QMetaObject::invokeMethod(this->model_, "Clear", Qt::AutoConnection);
+    if (this->queue_)
+        this->queue_->Push([](ObjectRefModel *model) { model->Clear(); });
+    else
+        QMetaObject::invokeMethod(this->model_, "Clear", Qt::AutoConnection);
 }
 
 template <typename Key, typename T>
@@ -86,7 +86,9 @@ template <typename T>
 T *ObjectModelVectorWrapper<T>::Take(int row)
 {
     auto res = this->At(row);
-    if (res)
+    if (res && this->queue_)
+        this->queue_->Push([row](ObjectRefModel *model) { model->Take(row); });
+    else if (res)
         QMetaObject::invokeMethod(this->model_, "Take", Qt::AutoConnection, Q_ARG(int, row));
     return res;
 }
@@ -95,7 +97,9 @@ template <typename T>
 T *ObjectModelVectorWrapper<T>::TakeFirst()
 {
     auto res = this->First();
-    if (res)
+    if (res && this->queue_)
+        this->queue_->Push([](ObjectRefModel *model) { model->TakeFirst(); });
+    else if (res)
         QMetaObject::invokeMethod(this->model_, "TakeFirst", Qt::AutoConnection);
     return res;
 }
@@ -104,7 +108,9 @@ template <typename T>
 T *ObjectModelVectorWrapper<T>::TakeLast()
 {
     auto res = this->Last();
-    if (res)
+    if (res && this->queue_)
+        this->queue_->Push([](ObjectRefModel *model) { model->TakeLast(); });
+    else if (res)
         QMetaObject::invokeMethod(this->model_, "TakeLast", Qt::AutoConnection);
     return res;
 }
@@ -114,7 +120,12 @@ void ObjectModelVectorWrapper<T>::Set(int row, T *item /*= nullptr*/)
 {
     if (item && item->thread() != QGuiApplication::instance()->thread())
         item->moveToThread(QGuiApplication::instance()->thread());
-    QMetaObject::invokeMethod(this->model_, "Set", Qt::AutoConnection, Q_ARG(int, row), Q_ARG(QObject *, item));
+    if (this->queue_ && item)
+        this->queue_->PushSet(row, item);
+    else if (this->queue_)
+        this->queue_->Push([row](ObjectRefModel *model) { model->Set(row); });
+    else
+        QMetaObject::invokeMethod(this->model_, "Set", Qt::AutoConnection, Q_ARG(int, row), Q_ARG(QObject *, item));
 }
 
 template <typename T>
@@ -122,7 +133,12 @@ void ObjectModelVectorWrapper<T>::Append(T *item /*= nullptr*/)
 {
     if (item && item->thread() != QGuiApplication::instance()->thread())
         item->moveToThread(QGuiApplication::instance()->thread());
-    QMetaObject::invokeMethod(this->model_, "Append", Qt::AutoConnection, Q_ARG(QObject *, item));
+    if (this->queue_ && item)
+        this->queue_->PushAppend(item);
+    else if (this->queue_)
+        this->queue_->Push([](ObjectRefModel *model) { model->Append(); });
+    else
+        QMetaObject::invokeMethod(this->model_, "Append", Qt::AutoConnection, Q_ARG(QObject *, item));
 }
 
 template <typename T>
@@ -136,6 +152,12 @@ void ObjectModelVectorWrapper<T>::Append(QVector<T *> items)
             item->moveToThread(QGuiApplication::instance()->thread());
         temp.push_back(item);
     }
+    // очередь объединяет последовательные добавления в один AppendVector
+    if (this->queue_)
+    {
+        for (auto item : temp) this->queue_->PushAppend(item);
+        return;
+    }
     QMetaObject::invokeMethod(this->model_, "Append", Qt::AutoConnection, Q_ARG(QVector<QObject *>, temp));
 }
 
@@ -144,31 +166,46 @@ void ObjectModelVectorWrapper<T>::Insert(int row, T *item /*= nullptr*/)
 {
     if (item->thread() != QGuiApplication::instance()->thread())
         item->moveToThread(QGuiApplication::instance()->thread());
-    QMetaObject::invokeMethod(this->model_, "Insert", Qt::AutoConnection, Q_ARG(int, row), Q_ARG(QObject *, item));
+    if (this->queue_)
+        this->queue_->Push([row, item](ObjectRefModel *model) { model->Insert(row, item); });
+    else
+        QMetaObject::invokeMethod(this->model_, "Insert", Qt::AutoConnection, Q_ARG(int, row), Q_ARG(QObject *, item));
 }
 
 template <typename T>
 void ObjectModelVectorWrapper<T>::Move(int from, int to)
 {
-    QMetaObject::invokeMethod(this->model_, "Move", Qt::AutoConnection, Q_ARG(int, from), Q_ARG(int, to));
+    if (this->queue_)
+        this->queue_->Push([from, to](ObjectRefModel *model) { model->Move(from, to); });
+    else
+        QMetaObject::invokeMethod(this->model_, "Move", Qt::AutoConnection, Q_ARG(int, from), Q_ARG(int, to));
 }
 
 template <typename T>
 void ObjectModelVectorWrapper<T>::Remove(int row)
 {
-    QMetaObject::invokeMethod(this->model_, "Remove", Qt::AutoConnection, Q_ARG(int, row));
+    if (this->queue_)
+        this->queue_->Push([row](ObjectRefModel *model) { model->Remove(row); });
+    else
+        QMetaObject::invokeMethod(this->model_, "Remove", Qt::AutoConnection, Q_ARG(int, row));
 }
 
 template <typename T>
 void ObjectModelVectorWrapper<T>::Remove(T *item)
 {
-    QMetaObject::invokeMethod(this->model_, "Remove", Qt::AutoConnection, Q_ARG(QObject *, item));
+    if (this->queue_)
+        this->queue_->Push([item](ObjectRefModel *model) { model->Remove(item); });
+    else
+        QMetaObject::invokeMethod(this->model_, "Remove", Qt::AutoConnection, Q_ARG(QObject *, item));
 }
 
 template <typename T>
 void ObjectModelVectorWrapper<T>::Clear()
 {
-    QMetaObject::invokeMethod(this->model_, "Clear", Qt::AutoConnection);
+    if (this->queue_)
+        this->queue_->Push([](ObjectRefModel *model) { model->Clear(); });
+    else
+        QMetaObject::invokeMethod(this->model_, "Clear", Qt::AutoConnection);
 }
 
 template <typename T>
@@ -182,12 +219,18 @@ void ObjectModelVectorWrapper<T>::Reset(QVector<T *> items)
             item->moveToThread(QGuiApplication::instance()->thread());
         temp.push_back(item);
     }
-    QMetaObject::invokeMethod(this->model_, "Reset", Qt::AutoConnection, Q_ARG(QVector<QObject *>, temp));
+    if (this->queue_)
+        this->queue_->Push([temp](ObjectRefModel *model) { model->SetItems(temp); });
+    else
+        QMetaObject::invokeMethod(this->model_, "Reset", Qt::AutoConnection, Q_ARG(QVector<QObject *>, temp));
 }
 
 template <typename T>
 void ObjectModelVectorWrapper<T>::Resize(int size)
 {
-    QMetaObject::invokeMethod(this->model_, "Resize", Qt::AutoConnection, Q_ARG(int, size));
+    if (this->queue_)
+        this->queue_->Push([size](ObjectRefModel *model) { static_cast<ObjectModel *>(model)->Resize(size); });
+    else
+        QMetaObject::invokeMethod(this->model_, "Resize", Qt::AutoConnection, Q_ARG(int, size));
 }
 }  // namespace om
@@ -1,10 +1,13 @@
 #pragma once
 
+#include "model_command_queue.h"
 #include "object_model.h"
 
 #include <QGuiApplication>
 #include <QPointer>
+#include <QThread>
 
+#include <memory>
 #include <stdexcept>
 #include <type_traits>
 
@@ -21,12 +24,31 @@ public:
 
     virtual ~ObjectModelWrapper()
     {
-        if (delete_model_)
+        // очередь применяет оставшиеся команды в потоке модели, пока модель существует
+        ReleaseCommandQueue();
+        if (!delete_model_ || !this->model_)
+            return;
+        if (this->model_->thread() == QThread::currentThread())
             delete this->model_;
+        else
+            this->model_->deleteLater();  // после очереди, удаление которой поставлено в очередь событий раньше
     }
 
     ObjectModel *GetModel() const { return this->model_; }
 
+    // In the command queue mode changes are pushed into the lock-free queue instead of posting an event per change,
+    // and the model's thread applies them once per interval milliseconds (see ModelCommandQueue).
+    // Must be switched in the model's thread, while no other threads change the model through the wrapper
+    void EnableCommandQueue(int interval = 16)
+    {
+        if (!queue_)
+            queue_ = std::make_unique<ModelCommandQueue>(this->model_, interval);
+    }
+    // Applies the queued changes in the model's thread: at once, if it is called there, otherwise by the next event of that thread
+    void                     DisableCommandQueue() { ReleaseCommandQueue(); }
+    bool                     IsCommandQueueEnabled() const { return queue_ != nullptr; }
+    const ModelCommandQueue *GetCommandQueue() const { return queue_.get(); }
+
     T *          At(int index) const { return static_cast<T *>(this->model_->At(index)); }
     T *          FindFirst(char *property_name, const QVariant &val) const { return static_cast<T *>(this->model_->FindFirst(property_name, val)); }
     QVector<T *> Find(char *property_name, const QVariant &val) const
@@ -62,8 +84,18 @@ protected:
         delete_model_ = true;
     }
 
-    bool                  delete_model_;
-    QPointer<ObjectModel> model_;
+    // Queue is destroyed in its own thread, so its timer is stopped and the model is changed in the model's thread
+    void ReleaseCommandQueue()
+    {
+        if (!queue_ || queue_->thread() == QThread::currentThread())
+            queue_.reset();
+        else
+            queue_.release()->deleteLater();
+    }
+
+    bool                               delete_model_;
+    QPointer<ObjectModel>              model_;
+    std::unique_ptr<ModelCommandQueue> queue_;
 };
 
 template <typename T>
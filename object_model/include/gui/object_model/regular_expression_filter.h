@@ -64,6 +64,9 @@ protected:
     bool Accepts(const QModelIndex& index, const std::pair<QByteArray, int>& role) const override;
 
 private:
+    // Literal patterns are searched as substrings, so extending or shortening them narrows or widens the filter
+    FilterChange GetPatternChange(const QString& old_pattern, const QString& new_pattern) const;
+
     QRegularExpression regular_expression_;
 };
 }  // namespace om
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "roles.h"
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QVariant>
+
+namespace om
+{
+// Hash index of the model items by role value.
+// QVariant has no hash and compares values with conversion (true == 1 == "1"), so values are hashed by normalized keys:
+// numbers, booleans, enumerations and numeric strings by their numeric value, other strings by text, lists by their elements,
+// other types by their QDataStream form or only by their type, if they can't be streamed.
+// Find converts the searched value to the types of the indexed values before hashing, as QVariant comparison does
+// (other numbers are rounded for integer values, values, that can't be converted, are compared with all values of the type).
+// So Find returns candidates, that must be checked with QVariant comparison.
+// Unique index only marks the role: the model checks values of the added items (see ObjectRefModel::CreateIndex).
+class RoleIndex
+{
+public:
+    using Items = boost::container::small_vector<QObject*, 1>;
+
+    RoleIndex(Id role_id = kInvalidId, bool unique = false) : role_id_(role_id), unique_(unique) {}
+
+    Id   GetRoleId() const { return role_id_; }
+    bool IsUnique() const { return unique_; }
+
+    // Inserts item or updates its value
+    void Insert(QObject* item, const QVariant& val);
+    void Remove(QObject* item);
+    void Clear();
+
+    Items Find(const QVariant& val) const;
+    int   GetSize() const { return keys_.size(); }
+
+    static uint GetKey(const QVariant& val);
+
+private:
+    struct Key
+    {
+        uint hash = 0;
+        int  type = QMetaType::UnknownType;
+    };
+
+    enum class Match { kKey, kNone, kAll };  // равные значения имеют ключ key, равных значений нет, равным может быть любое значение
+
+    // Ключ искомого значения для значений типа type
+    Match GetKey(const QVariant& val, int type, uint& key) const;
+    void AppendItems(Items& found, uint key, int type) const;
+
+    Id                   role_id_ = kInvalidId;
+    bool                 unique_  = false;
+    QHash<uint, Items>   items_;
+    QHash<QObject*, Key> keys_;
+    QHash<int, int>      types_;  // тип значения, количество элементов
+};
+}  // namespace om
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "object_meta_data.h"
+#include <QString>
+#include <QVariant>
+#include <optional>
+#include <vector>
+
+namespace om
+{
+// Columnar cache of item role values. Each cached role has its own typed column, indexed by cache slot (one slot per installed item).
+// Only int (and enum), double, bool and QString roles, whose values can't change without notification, can be cached.
+class RoleValueCache
+{
+public:
+    enum ColumnType { INT_COLUMN, DOUBLE_COLUMN, BOOL_COLUMN, STRING_COLUMN };
+
+    static std::optional<ColumnType> GetColumnType(const ObjectMetaData::RoleInfo* role);
+    static bool                      IsCacheable(const ObjectMetaData::RoleInfo* role);
+
+    // Slots are preserved, all cached values are dropped. Roles that can not be cached are ignored
+    void       SetRoles(const ObjectMetaData* meta_data, const Ids& roles);
+    const Ids& GetRoles() const { return roles_; }
+    // Notifiers of the cached roles and of all their parent roles. They must be connected to keep cache valid
+    const Ids& GetNotifiers() const { return notifiers_; }
+
+    bool IsEmpty() const { return columns_.empty(); }
+    bool Contains(Id role) const { return GetColumnIndex(role) >= 0; }
+    bool ContainsNotifier(int notifier_id) const { return notifiers_.contains(notifier_id); }
+
+    int  AllocateSlot();
+    void ReleaseSlot(int slot);
+    void Clear();  // releases all slots
+
+    // Drops values of the roles, that depend on notifier
+    void Invalidate(int slot, int notifier_id);
+
+    bool Read(int slot, Id role, QVariant& val) const;
+    void Write(int slot, Id role, const QVariant& val);
+
+    size_t GetMemoryUsage(Id role) const;  // bytes, allocated by roles column
+
+private:
+    enum CellState : quint8 { EMPTY_CELL, VALID_CELL, NULL_CELL };
+
+    struct Column
+    {
+        Id                   role_id = kInvalidId;
+        ColumnType           type    = INT_COLUMN;
+        std::vector<quint8>  states;
+        std::vector<int>     ints;
+        std::vector<double>  doubles;
+        std::vector<quint8>  bools;
+        std::vector<QString> strings;
+
+        void Resize(size_t size);
+        void Reset(int slot);
+    };
+
+    int GetColumnIndex(Id role) const;
+
+    Ids                           roles_;
+    Ids                           notifiers_;
+    std::vector<Column>           columns_;
+    std::vector<int>              column_indexes_;     // index = role ID - kItemRole
+    std::vector<std::vector<int>> notifier_columns_;  // index = notifier ID
+    std::vector<int>              free_slots_;
+    int                           slot_count_ = 0;
+};
+}  // namespace om
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+#include <functional>
+
+namespace om
+{
+// File of serialized rows, that is read through the memory mapping, so the number of rows is known right after opening
+// and every row is read only when it is needed.
+// Format (little endian): header (magic "OMSNAPSH", uint32 version, uint32 rows count), index (uint64 offset of every record from the file start),
+// records (uint32 size and data of the size)
+class SnapshotFile
+{
+public:
+    using RecordSize   = std::function<quint32(int row)>;
+    // Writes exactly size bytes of the row record into data
+    using RecordWriter = std::function<void(int row, char* data, quint32 size)>;
+
+    SnapshotFile() = default;
+    ~SnapshotFile();
+    SnapshotFile(const SnapshotFile&) = delete;
+    SnapshotFile& operator=(const SnapshotFile&) = delete;
+
+    // Maps the file and checks its header and index size
+    bool Open(const QString& file_path);
+    void Close();
+    bool IsOpened() const;
+
+    int GetCount() const;
+    // Data of the row record in the mapping, nullptr if the record is out of the file
+    const char* GetRecord(int row, int* size) const;
+
+    // Writes count records into the temporary file, that replaces file_path only after all records are written
+    static bool Write(const QString& file_path, int count, const RecordSize& record_size, const RecordWriter& write_record);
+
+private:
+    QFile        file_;
+    const uchar* data_  = nullptr;
+    qint64       size_  = 0;
+    int          count_ = 0;
+};
+}  // namespace om
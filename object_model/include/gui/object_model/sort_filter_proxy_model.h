@@ -4,23 +4,41 @@
 #include "abstract_filter.h"
 #include "abstract_object_model.h"
 #include "dynamic_roles.h"
+#include "filter_program.h"
 #include "model_access.h"
 
+#include <QAbstractProxyModel>
 #include <QPointer>
-#include <QSortFilterProxyModel>
+#include <optional>
 
 namespace om
 {
-class SortFilterProxyModel : public QSortFilterProxyModel, public ListModelAccess, public AbstractDynamicRolesProvider
+// Sorting and filtering list proxy. Keeps its own proxy <-> source row mapping, so changes of a few source rows are applied incrementally:
+// changed rows are refiltered and moved to their new sorted positions with binary search, emitting rowsMoved/Inserted/Removed for them only.
+// Rows with equal sort values keep the source order.
+// In async mode full sorts run on the thread pool: sort role values are extracted on the GUI thread, sorted rows are applied with one layout change.
+// Filter tree is compiled into FilterProgram on filterChanged/rolesChanged and is evaluated for all changed rows at once.
+// In async mode filtering of all rows reads values of the filter roles (and calls filters of other classes, that are QObjects) on the GUI thread,
+// then the compiled program selects the rows on the thread pool. Custom comparators compare QModelIndexes, so their sorts stay on the GUI thread.
+// When the filter is narrowed (a search substring is extended) only accepted rows are filtered again, when it is widened - only rejected rows
+// It is a QAbstractProxyModel, not a QSortFilterProxyModel. For compatibility it keeps lessThan, filterAcceptsRow, sortRole, filterRole,
+// dynamicSortFilter and invalidate of QSortFilterProxyModel. Subclasses compare and filter rows only through the virtual lessThan and filterAcceptsRow
+// (without typed keys, async sorting and filter program), unless they call SetVirtualSortFilter(false).
+// The rest of the QSortFilterProxyModel API (filterRegExp, filterKeyColumn, case sensitivity, recursive filtering) is not available
+class SortFilterProxyModel : public QAbstractProxyModel, public ListModelAccess, public AbstractDynamicRolesProvider
 {
     Q_OBJECT
     Q_PROPERTY(bool enabled READ IsEnabled WRITE SetEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(bool async READ IsAsync WRITE SetAsync NOTIFY asyncChanged)
+    Q_PROPERTY(bool busy READ IsBusy NOTIFY busyChanged)
     Q_PROPERTY(QAbstractItemModel* model READ sourceModel WRITE setSourceModel NOTIFY modelChanged)
     Q_PROPERTY(AbstractComparator* comparator READ GetComparator WRITE SetComparator NOTIFY comparatorChanged)
     Q_PROPERTY(AbstractFilter* filter READ GetFilter WRITE SetFilter NOTIFY filterChanged)
     Q_PROPERTY(QStringList sortRoles READ GetSortRoles WRITE SetSortRoles NOTIFY sortRolesChanged)
     Q_PROPERTY(QByteArray sortRole READ GetSortRole WRITE SetSortRole NOTIFY sortRolesChanged)
     Q_PROPERTY(Qt::SortOrder sortOrder READ GetSortOrder WRITE SetSortOrder NOTIFY sortOrderChanged)
+    Q_PROPERTY(int filterRole READ filterRole WRITE setFilterRole NOTIFY filterRoleChanged)
+    Q_PROPERTY(bool dynamicSortFilter READ dynamicSortFilter WRITE setDynamicSortFilter NOTIFY dynamicSortFilterChanged)
     Q_PROPERTY(int count READ rowCount NOTIFY rowCountChanged)
 public:
     SortFilterProxyModel(QObject* parent = nullptr);
@@ -29,6 +47,10 @@ public:
     bool IsEnabled() const;
     void SetEnabled(bool val);
 
+    bool IsAsync() const;
+    void SetAsync(bool val);
+    bool IsBusy() const;  // async sort or filtering is running
+
     AbstractComparator* GetComparator() const;
     void                SetComparator(AbstractComparator* val);
 
@@ -46,8 +68,27 @@ public:
     Qt::SortOrder GetSortOrder() const;
     void          SetSortOrder(Qt::SortOrder val);
 
+    // QSortFilterProxyModel compatibility. Sort role is the first of the sort roles
+    int  sortRole() const;
+    void setSortRole(int role);
+    // Filter role isn't used by the proxy itself, rows are filtered by filter
+    int  filterRole() const;
+    void setFilterRole(int role);
+    // Proxy always updates changed rows, the value is only stored
+    bool dynamicSortFilter() const;
+    void setDynamicSortFilter(bool val);
+
     void setSourceModel(QAbstractItemModel* val) override;
 
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex& child) const override;
+    int         rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int         columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    bool        hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex mapToSource(const QModelIndex& proxy_index) const override;
+    QModelIndex mapFromSource(const QModelIndex& source_index) const override;
+    void        sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
     QVariant sourceData(const QModelIndex& index, int role = Qt::DisplayRole) const;
 
     QVariant GetData(int row, int role) const override;
@@ -60,6 +101,7 @@ public slots:
     void Filter();
     void Invalidate();
     void ChangeSortOrder();
+    void invalidate();
 
     int MapFromSource(int source_row);
     int MapToSource(int row);
@@ -73,11 +115,17 @@ public slots:
 
 signals:
     void enabledChanged();
+    void asyncChanged();
+    void busyChanged();
+    void sorted();
+    void filtered();
     void modelChanged();
     void comparatorChanged();
     void filterChanged();
     void sortRolesChanged();
     void sortOrderChanged();
+    void filterRoleChanged(int role);
+    void dynamicSortFilterChanged(bool val);
     void rowCountChanged();
     void dynamicRolesChanged();
 
@@ -87,14 +135,67 @@ protected slots:
     void UpdateRoleIds();
     void UpdateSortRoleIds();
     void UpdateFilterRoleIds();
+    void CompileFilter();
     void OnItemDataChanged(const Ids& roles = Ids());
     void OnDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles = QVector<int>());
+    void OnFilterChanged();
     void OnFilterRolesChanged();
+    void OnSourceRowsAboutToBeRemoved(const QModelIndex& parent, int first, int last);
+    void OnSourceRowsRemoved(const QModelIndex& parent, int first, int last);
+    void OnSourceRowsInserted(const QModelIndex& parent, int first, int last);
+    void OnSourceRowsMoved(const QModelIndex& parent, int first, int last, const QModelIndex& destination, int destination_row);
+    void OnSourceModelReset();
 
 protected:
-    bool lessThan(const QModelIndex& source_left, const QModelIndex& source_right) const override;
-    bool filterAcceptsRow(int source_row, const QModelIndex& source_parent) const override;
-    void OnDynamicRolesChanged() override;
+    // QSortFilterProxyModel compatibility: strict order of the rows by the sort roles and filter check of one row.
+    // They are called by the proxy only for subclasses (see SetVirtualSortFilter)
+    virtual bool lessThan(const QModelIndex& source_left, const QModelIndex& source_right) const;
+    virtual bool filterAcceptsRow(int source_row, const QModelIndex& source_parent) const;
+    void         invalidateFilter();
+    // By default true for subclasses, that may override lessThan and filterAcceptsRow. Subclass, that doesn't override them, may set false
+    // to compare rows by typed keys (and in async mode on the thread pool) and filter them by the filter program
+    bool IsVirtualSortFilter() const;
+    void SetVirtualSortFilter(bool val);
+
+    // Bit i is set, if source_rows[i] is accepted by the filter. Rows are filtered by the compiled filter program column at a time
+    // or by filterAcceptsRow (see SetVirtualSortFilter)
+    virtual QBitArray FilterAcceptsRows(const QVector<int>& source_rows) const;
+    void         OnDynamicRolesChanged() override;
+    // Filtered values of the rows are changed, empty rows - unknown rows
+    void OnFilterRowsChanged(const QVector<int>& source_rows);
+    void Filter(AbstractFilter::FilterChange change);
+
+    AbstractFilterComparatorBase::ComparisonResult CompareRows(const QModelIndex& source_left, const QModelIndex& source_right) const;
+    // Strict order of the proxy rows: sort roles and order, then source row
+    bool LessThan(int source_left, int source_right) const;
+    // Sorts by LessThan, sort role values are read once per row when they can be compared as typed keys
+    void SortSourceRows(QVector<int>& source_rows) const;
+
+    void RebuildMapping();  // without signals, for model reset
+    void UpdateSourceToProxy(int first_row = 0);
+    // Position of the source row in proxy rows sorted by LessThan. Rows marked as dirty are not sorted and are skipped
+    int  FindInsertPosition(int source_row, const QVector<char>& dirty = QVector<char>()) const;
+    void InsertSourceRows(QVector<int> source_rows);  // source rows must be accepted and not mapped
+    void RemoveProxyRows(const QVector<int>& rows);   // sorted proxy rows
+    void MoveChangedRows(const QVector<int>& source_rows);
+    void UpdateSourceRows(const QVector<int>& source_rows, bool refilter, bool resort);
+    void EmitDataChanged(const QVector<int>& source_rows, const QVector<int>& roles);
+    // Bit i of accepted_rows is set, if source_rows[i] is accepted
+    void ApplyFilteredRows(const QVector<int>& source_rows, const QBitArray& accepted_rows);
+    void ApplySortedRows(const QVector<int>& source_rows);  // with layout change
+
+    // Returns false, if rows can't be sorted outside of the GUI thread
+    bool StartSortJob();
+    void CancelSortJob();
+    // Sorted rows of the running job became stale
+    void RestartSortJob();
+    // Returns false, if rows can't be filtered outside of the GUI thread
+    bool StartFilterJob(const QVector<int>& source_rows);
+    // Returns false, if the job isn't running
+    bool CancelFilterJob();
+    // Source rows or their filtered values are changed while the job is running
+    void RestartFilterJob();
+    void SetBusy(bool val);
 
 private:
 //    COMPONENT_LOGGER("ui.sfpm");
@@ -105,15 +206,31 @@ private:
     QPointer<AbstractComparator>  comparator_;
     QPointer<AbstractFilter>      filter_;
 
-    RolesVector sort_roles_;
-    Ids         sort_role_ids_;
-    om::IdsMap  filter_roles_;
-    Ids         filter_role_ids_;
+    RolesVector   sort_roles_;
+    Ids           sort_role_ids_;
+    om::IdsMap    filter_roles_;
+    Ids           filter_role_ids_;
+    FilterProgram filter_program_;
 
     Qt::SortOrder sort_order_ = Qt::AscendingOrder;
 
+    QVector<int> proxy_to_source_;
+    QVector<int> source_to_proxy_;  // -1 for filtered out rows
+
+    int                 filter_role_         = Qt::DisplayRole;
+    bool                dynamic_sort_filter_ = true;
+    std::optional<bool> virtual_sort_filter_;  // empty - by the class of the object
+
     bool enabled_            = true;
+    bool async_              = false;
+    bool busy_               = false;
+    int  sort_job_           = 0;  // results of the previous jobs are dropped
+    int  filter_job_         = 0;
+    bool sort_job_running_   = false;
+    bool filter_job_running_ = false;
     bool sorting_required_   = false;
     bool filtering_required_ = false;
+    // Direction of the filter changes since the last filtering: after narrowing only accepted rows are checked, after widening - only rejected
+    AbstractFilter::FilterChange filter_change_ = AbstractFilter::FilterChange::ANY;
 };
 }  // namespace om
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "roles.h"
+#include <QAbstractItemModel>
+#include <QString>
+#include <QVector>
+#include <vector>
+
+namespace om
+{
+class AbstractComparator;
+
+// Sort role values of the source rows, read once before sorting (Schwartzian transform) into typed columns.
+// Values are ordered like AbstractFilterComparatorBase::DefaultVariantCompare does, strings are compared ordinally.
+// Integer columns are packed into one 64-bit composite key, when their value ranges fit.
+// Extracted keys don't depend on the model, so Sort can be called from any thread
+class SortKeys
+{
+public:
+    enum ColumnType { INT_COLUMN, DOUBLE_COLUMN, STRING_COLUMN };
+
+    // Returns false, if some role can't be extracted: its values are compared by comparator, are null or are not of one supported type
+    bool Extract(const QAbstractItemModel* model, const QVector<int>& source_rows, const RolesVector& roles, const AbstractComparator* comparator = nullptr);
+    void Clear();
+
+    bool IsPacked() const { return !packed_keys_.empty(); }
+    int  GetSize() const { return source_rows_.size(); }
+
+    // Returns extracted source rows in sort order. Rows with equal keys keep the source order.
+    // With several threads rows are sorted in chunks on the global thread pool, then the chunks are merged
+    QVector<int> Sort(Qt::SortOrder order, int thread_count = 1) const;
+
+private:
+    struct Column
+    {
+        ColumnType           type = INT_COLUMN;
+        std::vector<qint64>  ints;
+        std::vector<double>  doubles;
+        std::vector<QString> strings;
+    };
+
+    static bool GetColumnType(int type_id, ColumnType& type);
+
+    bool Pack();
+    int  Compare(int left, int right) const;  // by indexes of the extracted rows
+
+    QVector<int>         source_rows_;
+    std::vector<Column>  columns_;
+    std::vector<quint64> packed_keys_;
+};
+}  // namespace om
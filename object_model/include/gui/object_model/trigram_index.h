@@ -0,0 +1,61 @@
+#pragma once
+
+#include "roles.h"
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <boost/container/flat_set.hpp>
+#include <vector>
+
+namespace om
+{
+// Trigram index of the string role values for substring search.
+// Strings are case folded, every 3 consecutive UTF-16 characters of a string are its trigram. Find returns items, whose strings contain
+// all trigrams of the text, so they are candidates, that must be checked by the search itself. Texts shorter than a trigram aren't indexed.
+class TrigramIndex
+{
+public:
+    static const int kTrigramSize = 3;
+
+    TrigramIndex(Id role_id = kInvalidId) : role_id_(role_id) {}
+
+    Id GetRoleId() const { return role_id_; }
+
+    // Inserts item or updates its string
+    void Insert(QObject* item, const QString& val);
+    void Remove(QObject* item);
+    void Clear();
+
+    // Returns false, if text is shorter than a trigram and all items are candidates
+    bool Find(const QString& text, QVector<QObject*>& items) const;
+    int  GetSize() const { return slots_.size(); }
+    int  GetTrigramCount() const { return postings_.size(); }
+
+    qint64 GetBuildTime() const { return build_time_; }  // nanoseconds spent in Insert and Remove since creation or Clear
+    size_t GetMemoryUsage() const;                       // approximate bytes allocated by the index
+
+private:
+    using Trigram  = quint64;
+    using Postings = boost::container::flat_set<int>;  // slots of the items
+
+    struct Entry
+    {
+        QObject* item = nullptr;
+        QString  folded;  // trigrams are taken from it again on update and remove
+    };
+
+    // Sorted unique trigrams
+    static std::vector<Trigram> GetTrigrams(const QString& folded);
+
+    void AddPostings(int slot, const std::vector<Trigram>& trigrams);
+    void RemovePostings(int slot, const std::vector<Trigram>& trigrams);
+
+    Id                        role_id_ = kInvalidId;
+    QHash<Trigram, Postings>  postings_;
+    QHash<QObject*, int>      slots_;
+    std::vector<Entry>        entries_;  // index = slot
+    std::vector<int>          free_slots_;
+    qint64                    build_time_ = 0;
+};
+}  // namespace om
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "abstract_object_model.h"
+#include "object_meta_data.h"
+
+#include <QVector>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace om
+{
+// Model of the items, whose data is stored outside of the item objects (protobuf messages for example).
+// Item objects are created on demand: by At, by item role, by writing data and by reading roles of the nested objects.
+// Plain roles (own not object properties of the item class) of the rows without objects are read from the row reader - one object, that is pointed to the rows data.
+// Created objects are deleted when their number exceeds maxItems, least recently used first. Objects with connected notifiers (QML bindings) are not deleted.
+// So pointers returned by At are valid until the return to the event loop
+class VirtualObjectModel : public AbstractObjectModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int maxItems READ GetMaxItems WRITE SetMaxItems NOTIFY maxItemsChanged)
+    Q_PROPERTY(int itemsCount READ GetItemsCount)
+
+public:
+    static const int kDefaultMaxItems;
+
+    VirtualObjectModel(const QMetaObject& meta_object, QObject* parent = nullptr);
+    ~VirtualObjectModel() override;
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+
+    // -1 - created objects are never deleted
+    int  GetMaxItems() const;
+    void SetMaxItems(int val);
+    int  GetItemsCount() const;  // number of created objects
+    bool HasItem(int row) const;
+
+    using AbstractObjectModel::GetData;
+    using AbstractObjectModel::SetData;
+    QVariant GetData(int row, int role) const override;
+    bool     SetData(int row, const QVariant& value, int role) override;
+    bool     ReadData(int row, int role, int type_id, void* out) const override;
+    int      ReadColumnData(int role, int first, int count, int type_id, void* out, size_t value_size) const override;
+
+public slots:
+    QObject* At(int row) const;
+    QObject* First() const;
+    QObject* Last() const;
+
+    // Deletes created objects, that are not used
+    void ReleaseItems();
+
+signals:
+    void maxItemsChanged();
+
+protected:
+    // Object for the rows data. Model becomes its parent
+    virtual QObject* CreateItem(int row) const = 0;
+    // Object pointed to the rows data. Only plain roles are read from it
+    virtual QObject* GetRowReader(int row) const = 0;
+    // Object can be deleted: it isn't used by QML bindings
+    virtual bool IsItemIdle(QObject* item) const;
+
+    QObject* GetItem(int row) const override;  // nullptr, if object of the row isn't created
+    int      GetItemRow(QObject* item) const override;
+    bool     SetItem(int row, QObject* val) override;
+
+    void ItemAboutToBeDeleted(QObject* item) override;
+
+    // Must be called by the subclasses to change rows of the data. Data is changed by change_data between begin and end signals.
+    // Objects of the removed rows are deleted, objects of the other rows must stay pointed to their data
+    void InsertDataRows(int row, int count, const std::function<void()>& change_data = {});
+    void RemoveDataRows(int row, int count, const std::function<void()>& change_data = {});
+    void ResetDataRows(int count, const std::function<void()>& change_data = {});
+
+    bool IsPlainRole(int role) const;
+
+private:
+    QObject* GetOrCreateItem(int row) const;
+    void     DeleteItem(int row);
+    void     EnqueueTrim() const;
+    void     Trim();
+    void     UpdatePlainRoles();
+
+//    COMPONENT_LOGGER("ui.vom");
+
+    mutable QVector<QObject*>        items_;         // nullptr for the rows without objects
+    mutable QHash<QObject*, quint64> items_access_;  // last access stamp of the created objects
+    mutable quint64                  access_counter_ = 0;
+    mutable bool                     trim_queued_    = false;
+    int                              max_items_      = kDefaultMaxItems;
+    std::shared_ptr<ObjectMetaData>  meta_data_;
+    std::vector<char>                plain_roles_;  // index = role - kItemRole
+
+    mutable QHash<QObject*, int>     item_rows_;
+    mutable int                      item_rows_valid_ = 0;  // rows before this one are valid in item_rows_
+};
+}  // namespace om
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QtGlobal>
+#include <vector>
+
+namespace om
+{
+// Bytes of the serialized protobuf message. Values of the nested message fields are found by the field numbers in the bytes of their parent
+// by skipping the wire format without parsing, so the message tree is serialized once and every nested message is compared by its own bytes.
+// Doesn't own the data
+class WireBytes
+{
+public:
+    WireBytes() = default;  // unknown bytes
+    WireBytes(const char* data, int size) : data_(data), size_(size) {}
+
+    bool        IsValid() const { return size_ >= 0; }
+    const char* GetData() const { return data_; }
+    int         GetSize() const { return size_; }
+    // Both bytes are known and equal, so their messages are equal too
+    bool IsSame(const WireBytes& other) const;
+
+    // Value of the length-delimited field (not repeated message field). Unknown bytes, if the field is absent, occurs many times or bytes are malformed
+    WireBytes GetField(int number) const;
+    // Values of all occurrences of the length-delimited field in their order (elements of repeated message field). Empty for malformed bytes
+    std::vector<WireBytes> GetFields(int number) const;
+
+private:
+    const char* data_ = nullptr;
+    int         size_ = -1;
+};
+}  // namespace om
@@ -60,12 +60,22 @@ void AbstractFilter::SetInverted(bool val)
         return;
     inverted_ = val;
     emit invertedChanged();
+    EmitFilterChanged();
+}
+
+AbstractFilter::FilterChange AbstractFilter::GetLastChange() const
+{
+    return last_change_;
 }
 
-void AbstractFilter::EmitFilterChanged()
+void AbstractFilter::EmitFilterChanged(FilterChange change /*= FilterChange::ANY*/)
 {
     if (!enabled_)
         return;
+    // инвертированный фильтр отклоняет строки, которые принял бы без инверсии
+    if (inverted_ && (change == FilterChange::NARROWED || change == FilterChange::WIDENED))
+        change = change == FilterChange::NARROWED ? FilterChange::WIDENED : FilterChange::NARROWED;
+    last_change_ = change;
     emit filterChanged();
 }
 
@@ -1,4 +1,5 @@
 ﻿#include "abstract_object_model.h"
+#include "role_value_cache.h"
 #include "signal_binder.h"
 #include "signal_timer.h"
 #include <QBasicTimer>
@@ -31,18 +32,33 @@ struct AbstractObjectModel::Impl
     std::shared_ptr<ObjectMetaData> meta_data;
 
     Ids                    changed_roles;
+    QSet<QObject*>         changed_items;
+    QVector<int>           changed_rows;  // filled while itemDataChanged is emitted
     Ids                    dynamic_roles;
     Ids                    dynamic_roles_notifiers;
+    Ids                    observed_roles;
+    Ids                    observed_roles_notifiers;
+    Ids                    connected_notifiers;  // dynamic, cached and observed roles notifiers
     bool                   update_item_connections_queued = false;
     QVariant               data_roles                     = Role::ITEM_ROLE;
     QVariant               data_change_roles              = Role::ITEM_ROLE;
+    QVariant               cached_roles                   = Role::ITEM_ROLE;
     QHash<int, QByteArray> role_names                     = { { kItemRole, kItemRoleName } };
 
     QHash<QObject*, SignalBinder*>                  item_connections;
+    QHash<const SignalBinder*, QObject*>            connected_items;
     std::shared_ptr<SignalBinder::AbstractReceiver> connections_receiver;
 
     SignalTimer data_changed_timer;
 
+    RoleValueCache                  value_cache;
+    QHash<const SignalBinder*, int> cache_slots;
+    std::vector<int>                row_cache_slots;  // index = row
+    bool                            rows_changing = false;
+
+    QHash<QObject*, int> item_rows;
+    int                  item_rows_valid = 0;  // rows before this one are valid in item_rows
+
     Impl(AbstractObjectModel* model) : model(model)
     {
         auto connections_callback = [=](const SignalBinder::Binding& binding, void**) { OnPropertyChanged(binding); };
@@ -52,7 +68,7 @@ struct AbstractObjectModel::Impl
 
     bool ConnectItem(QObject* item, SignalBinder* connections = nullptr, const ObjectMetaData::RoleInfo* role = nullptr)
     {
-        if (!(item || connections) || dynamic_roles_notifiers.empty())
+        if (!(item || connections) || connected_notifiers.empty())
             return false;
 
         if (!role)
@@ -68,30 +84,181 @@ struct AbstractObjectModel::Impl
             connections = connections_it.value();
         }
 
-        return connections->Bind(item, role, dynamic_roles_notifiers);
+        return connections->Bind(item, role, connected_notifiers);
+    }
+
+    void UpdateConnectedNotifiers()
+    {
+        connected_notifiers = dynamic_roles_notifiers;
+        connected_notifiers.insert(value_cache.GetNotifiers().begin(), value_cache.GetNotifiers().end());
+        connected_notifiers.insert(observed_roles_notifiers.begin(), observed_roles_notifiers.end());
     }
 
     void OnPropertyChanged(const SignalBinder::Binding& binding)
     {
-        bool enqueue_signal = false;
-        auto notifier       = meta_data->GetNotifier(binding.id);
+        bool enqueue_signal  = false;
+        bool cached_notifier = value_cache.ContainsNotifier(binding.id);
+        auto notifier        = meta_data->GetNotifier(binding.id);
+        Ids  changed_observed_roles;
         for (auto role : notifier->roles)
         {
-            if (SetIntersection(dynamic_roles, role->dependent_role_ids, changed_roles))
-            {
-                enqueue_signal = true;
-                if (role->meta_object)
-                    ConnectItem(role->ReadFromItem(binding.sender).value<QObject*>(), binding.binder, role);
-            }
+            auto dynamic_role  = SetIntersection(dynamic_roles, role->dependent_role_ids, changed_roles);
+            auto observed_role = SetIntersection(observed_roles, role->dependent_role_ids, changed_observed_roles);
+            enqueue_signal     = enqueue_signal || dynamic_role;
+            if (dynamic_role)
+                changed_items.insert(connected_items.value(binding.binder));
+            if ((dynamic_role || observed_role || cached_notifier) && role->meta_object)
+                ConnectItem(role->ReadFromItem(binding.sender).value<QObject*>(), binding.binder, role);
         }
+        if (cached_notifier)
+            value_cache.Invalidate(cache_slots.value(binding.binder, -1), binding.id);
+        if (!changed_observed_roles.empty())
+            model->ItemRolesChanged(connected_items.value(binding.binder), changed_observed_roles);
         if (enqueue_signal)
             EnqueueItemDataChanged();
     }
 
+    // Returns role info, if role can be read directly to the object of type_id type
+    const ObjectMetaData::RoleInfo* GetDirectlyReadableRoleInfo(int role, int type_id) const
+    {
+        if (role <= kItemRole || role - kItemRole >= static_cast<int>(meta_data->GetRoleInfos().size()))
+            return nullptr;
+        auto info = meta_data->GetRoleInfo(role);
+        if (info->IsSignal() || !(info->property.userType() == type_id || (info->property.isEnumType() && type_id == QMetaType::Int)))
+            return nullptr;
+        return info;
+    }
+
+    // Value cache
+    int GetCacheSlot(QObject* item) const { return item ? cache_slots.value(item_connections.value(item), -1) : -1; }
+
+    int GetCacheSlot(int row) const
+    {
+        // while rows are changing or items are not connected yet, cached values can be stale
+        if (value_cache.IsEmpty() || rows_changing || update_item_connections_queued || row >= static_cast<int>(row_cache_slots.size()))
+            return -1;
+        return row_cache_slots[row];
+    }
+
+    bool ReadCachedValue(int row, int role, QVariant& val) const
+    {
+        auto slot = GetCacheSlot(row);
+        return slot >= 0 && value_cache.Read(slot, role, val);
+    }
+
+    void WriteCachedValue(int row, int role, const QVariant& val)
+    {
+        if (auto slot = GetCacheSlot(row); slot >= 0)
+            value_cache.Write(slot, role, val);
+    }
+
+    bool IsRowCacheSlotsSynchronized() const { return !rows_changing && static_cast<int>(row_cache_slots.size()) == model->rowCount(); }
+
+    void AllocateCacheSlot(int row, const SignalBinder* connections)
+    {
+        if (value_cache.IsEmpty())
+            return;
+        auto slot = value_cache.AllocateSlot();
+        cache_slots.insert(connections, slot);
+        // when rows are inserted, slots will be placed by OnRowsInserted
+        if (IsRowCacheSlotsSynchronized())
+            row_cache_slots[row] = slot;
+    }
+
+    void ReleaseCacheSlot(int row, const SignalBinder* connections)
+    {
+        auto slot = cache_slots.find(connections);
+        if (slot == cache_slots.end())
+            return;
+        value_cache.ReleaseSlot(slot.value());
+        cache_slots.erase(slot);
+        if (IsRowCacheSlotsSynchronized())
+            row_cache_slots[row] = -1;
+    }
+
+    void UpdateCacheSlots()
+    {
+        if (value_cache.IsEmpty())
+        {
+            value_cache.Clear();
+            cache_slots.clear();
+            row_cache_slots.clear();
+            return;
+        }
+
+        for (auto connections : item_connections)
+            if (!cache_slots.contains(connections))
+                cache_slots.insert(connections, value_cache.AllocateSlot());
+        UpdateRowCacheSlots();
+    }
+
+    void UpdateRowCacheSlots()
+    {
+        row_cache_slots.assign(model->rowCount(), -1);
+        for (int row = 0; row < model->rowCount(); ++row) row_cache_slots[row] = GetCacheSlot(model->GetItem(row));
+    }
+
+    void OnRowsInserted(int first, int last)
+    {
+        rows_changing   = false;
+        item_rows_valid = qMin(item_rows_valid, first);
+        if (value_cache.IsEmpty())
+            return;
+        if (static_cast<int>(row_cache_slots.size()) + last - first + 1 != model->rowCount())
+            return UpdateRowCacheSlots();
+
+        row_cache_slots.insert(row_cache_slots.begin() + first, last - first + 1, -1);
+        for (int row = first; row <= last; ++row) row_cache_slots[row] = GetCacheSlot(model->GetItem(row));
+    }
+
+    void OnRowsRemoved(int first, int last)
+    {
+        rows_changing   = false;
+        item_rows_valid = qMin(item_rows_valid, first);
+        if (value_cache.IsEmpty())
+            return;
+        if (static_cast<int>(row_cache_slots.size()) - (last - first + 1) != model->rowCount())
+            return UpdateRowCacheSlots();
+
+        row_cache_slots.erase(row_cache_slots.begin() + first, row_cache_slots.begin() + last + 1);
+    }
+
+    void OnRowsMoved(int first, int last, int destination)
+    {
+        rows_changing   = false;
+        item_rows_valid = qMin(item_rows_valid, qMin(first, destination));
+        if (value_cache.IsEmpty())
+            return;
+        if (static_cast<int>(row_cache_slots.size()) != model->rowCount())
+            return UpdateRowCacheSlots();
+
+        auto begin = row_cache_slots.begin();
+        if (destination > last)
+            std::rotate(begin + first, begin + last + 1, begin + destination);
+        else if (destination < first)
+            std::rotate(begin + destination, begin + first, begin + last + 1);
+    }
+
+    void OnRowsReset()
+    {
+        rows_changing   = false;
+        item_rows_valid = 0;
+        item_rows.clear();
+        if (!value_cache.IsEmpty())
+            UpdateRowCacheSlots();
+    }
+
     void EmitItemDataChanged()
     {
+        for (auto item : changed_items)
+            if (auto row = model->GetItemRow(item); row >= 0)
+                changed_rows.push_back(row);
+        std::sort(changed_rows.begin(), changed_rows.end());
+        changed_items.clear();
+
         model->itemDataChanged(changed_roles);
         changed_roles.clear();
+        changed_rows.clear();
     }
 
     void EnqueueItemDataChanged() { data_changed_timer.Start(); }
@@ -127,6 +294,21 @@ AbstractObjectModel::AbstractObjectModel(QObject* parent /*= nullptr*/) : QAbstr
             d->meta_data  = nullptr;
         }
     });
+
+    // value cache rows
+    const auto on_rows_about_to_be_changed = [this] { d->rows_changing = true; };
+    connect(this, &AbstractObjectModel::rowsAboutToBeInserted, this, on_rows_about_to_be_changed);
+    connect(this, &AbstractObjectModel::rowsAboutToBeRemoved, this, on_rows_about_to_be_changed);
+    connect(this, &AbstractObjectModel::rowsAboutToBeMoved, this, on_rows_about_to_be_changed);
+    connect(this, &AbstractObjectModel::modelAboutToBeReset, this, on_rows_about_to_be_changed);
+    connect(this, &AbstractObjectModel::layoutAboutToBeChanged, this, on_rows_about_to_be_changed);
+    connect(this, &AbstractObjectModel::rowsInserted, this, [this](const QModelIndex&, int first, int last) { d->OnRowsInserted(first, last); });
+    connect(this, &AbstractObjectModel::rowsRemoved, this, [this](const QModelIndex&, int first, int last) { d->OnRowsRemoved(first, last); });
+    connect(this, &AbstractObjectModel::rowsMoved, this, [this](const QModelIndex&, int first, int last, const QModelIndex&, int destination) {
+        d->OnRowsMoved(first, last, destination);
+    });
+    connect(this, &AbstractObjectModel::modelReset, this, [this] { d->OnRowsReset(); });
+    connect(this, &AbstractObjectModel::layoutChanged, this, [this] { d->OnRowsReset(); });
 }
 
 AbstractObjectModel::AbstractObjectModel(const QMetaObject* static_meta_object, QObject* parent /*= nullptr*/) : AbstractObjectModel(parent)
@@ -167,7 +349,13 @@ QVariant AbstractObjectModel::GetData(int row, int role) const
     if (role == kItemRole)
         return QVariant::fromValue(GetItem(row));
 
-    return GetItemsProperty(GetItem(row), role);
+    QVariant res;
+    if (d->ReadCachedValue(row, role, res))
+        return res;
+
+    res = GetItemsProperty(GetItem(row), role);
+    d->WriteCachedValue(row, role, res);
+    return res;
 }
 
 QVariant AbstractObjectModel::data(const QModelIndex& index, int role /*= Qt::DisplayRole*/) const
@@ -269,11 +457,80 @@ bool AbstractObjectModel::SetItemsProperty(QObject* item, const QVariant& value,
     return d->meta_data->GetRoleInfo(role_name)->WriteToRoot(item, value);
 }
 
+// Typed data
+bool AbstractObjectModel::ReadData(int row, int role, int type_id, void* out) const
+{
+    if (!d->meta_data || row < 0 || row >= rowCount())
+        return false;
+
+    if (role == kItemRole && type_id == QMetaType::QObjectStar)
+    {
+        *static_cast<QObject**>(out) = GetItem(row);
+        return true;
+    }
+
+    auto info = d->GetDirectlyReadableRoleInfo(role, type_id);
+    return info ? info->ReadFromRoot(GetItem(row), out) : ListModelAccess::ReadData(row, role, type_id, out);
+}
+
+int AbstractObjectModel::ReadColumnData(int role, int first, int count, int type_id, void* out, size_t value_size) const
+{
+    if (!d->meta_data || first < 0 || count <= 0)
+        return 0;
+    count = qMin(count, rowCount() - first);
+
+    auto info = d->GetDirectlyReadableRoleInfo(role, type_id);
+    if (!info)
+        return ListModelAccess::ReadColumnData(role, first, count, type_id, out, value_size);
+
+    int  res  = 0;
+    auto data = static_cast<char*>(out);
+    for (int row = first; row < first + count; ++row, data += value_size) res += info->ReadFromRoot(GetItem(row), data);
+    return res;
+}
+
 bool AbstractObjectModel::IsNullRow(int row) const
 {
     return GetItem(row) == nullptr;
 }
 
+const QVector<int>& AbstractObjectModel::GetItemDataChangedRows() const
+{
+    return d->changed_rows;
+}
+
+bool AbstractObjectModel::FindTextRows(int /*role*/, const QString& /*text*/, QVector<int>& /*rows*/) const
+{
+    return false;
+}
+
+int AbstractObjectModel::GetItemRow(QObject* item) const
+{
+    if (!item)
+        return -1;
+    if (d->item_rows_valid < rowCount())
+    {
+        for (int row = d->item_rows_valid; row < rowCount(); ++row)
+            if (auto row_item = GetItem(row))
+                d->item_rows.insert(row_item, row);
+        d->item_rows_valid = rowCount();
+    }
+
+    auto row = d->item_rows.value(item, -1);
+    if (row >= 0 && row < rowCount() && GetItem(row) == item)
+        return row;
+    // item is set to its row without row signals (by SetItem)
+    for (row = 0; row < rowCount(); ++row)
+    {
+        if (GetItem(row) == item)
+        {
+            d->item_rows.insert(item, row);
+            return row;
+        }
+    }
+    return -1;
+}
+
 // Meta object
 void AbstractObjectModel::InitializeMetaObject(const QMetaObject* meta_object)
 {
@@ -281,6 +538,7 @@ void AbstractObjectModel::InitializeMetaObject(const QMetaObject* meta_object)
     d->meta_data  = ObjectMetaData::GetMetaData(meta_object);
     UpdateDataRoles();
     UpdateDataChangeRoles();
+    UpdateCachedRoles();
     emit initialized();
 }
 
@@ -322,6 +580,8 @@ void AbstractObjectModel::InstallItem(int row)
         std::cout << (std::logic_error(error_message), error_message);
     }
     connections = new SignalBinder(d->connections_receiver);
+    d->connected_items.insert(connections, item);
+    d->AllocateCacheSlot(row, connections);
 
     connect(item, &QObject::destroyed, this, &AbstractObjectModel::ItemAboutToBeDeleted);
     d->ConnectItem(item, connections);
@@ -348,6 +608,10 @@ void AbstractObjectModel::UninstallItem(int row, bool)
         auto error_message = QString("Item at row = %1 already uninstalled").arg(row).toStdString();
         std::cout << (std::logic_error(error_message), error_message);
     }
+    d->ReleaseCacheSlot(row, connections.value());
+    d->connected_items.remove(connections.value());
+    d->changed_items.remove(item);
+    d->item_rows.remove(item);
     delete connections.value();
     d->item_connections.erase(connections);
 
@@ -429,6 +693,41 @@ void AbstractObjectModel::UpdateDataChangeRoles()
     SetDynamicRoles(d->meta_data->ConvertToRoleIds(d->data_change_roles));
 }
 
+// cached roles
+QVariant AbstractObjectModel::GetCachedRoles() const
+{
+    return d->cached_roles;
+}
+
+void AbstractObjectModel::SetCachedRoles(const QVariant& val)
+{
+    if (d->cached_roles == val)
+        return;
+    d->cached_roles = val;
+    UpdateCachedRoles();
+    emit cachedRolesChanged();
+}
+
+void AbstractObjectModel::UpdateCachedRoles()
+{
+    if (!IsInitialized())
+        return;
+    d->value_cache.SetRoles(d->meta_data.get(), d->meta_data->ConvertToRoleIds(d->cached_roles));
+    d->UpdateCacheSlots();
+    d->UpdateConnectedNotifiers();
+    UpdateItemsConnections();
+}
+
+QVariantMap AbstractObjectModel::GetCachedRolesMemoryUsage() const
+{
+    QVariantMap res;
+    if (!IsInitialized())
+        return res;
+    for (auto role : d->value_cache.GetRoles())
+        res.insert(QString::fromUtf8(d->meta_data->GetRoleInfo(role)->name), QVariant::fromValue<qulonglong>(d->value_cache.GetMemoryUsage(role)));
+    return res;
+}
+
 unsigned int AbstractObjectModel::GetItemDataChangedDelay() const
 {
     return d->data_changed_timer.GetDelay();
@@ -459,9 +758,33 @@ void AbstractObjectModel::SetDynamicRoles(const Ids& val)
         if (auto notifier = d->meta_data->GetRoleInfo(role)->notifier)
             d->dynamic_roles_notifiers.insert(notifier->id);
     }
+    d->UpdateConnectedNotifiers();
     UpdateItemsConnections();
 }
 
+// observed roles
+void AbstractObjectModel::SetObservedRoles(const Ids& val)
+{
+    d->observed_roles = val;
+    d->observed_roles_notifiers.clear();
+    if (IsInitialized())
+    {
+        for (auto role : d->observed_roles)
+            for (auto info = d->meta_data->GetRoleInfo(role); info && info->id != kItemRole; info = info->parent)
+                if (info->notifier)
+                    d->observed_roles_notifiers.insert(info->notifier->id);
+    }
+    d->UpdateConnectedNotifiers();
+    // items are connected immediately, so no changes of the observed roles will be missed
+    for (auto connections = d->item_connections.begin(); connections != d->item_connections.end(); ++connections)
+        d->ConnectItem(connections.key(), connections.value());
+}
+
+const Ids& AbstractObjectModel::GetObservedRoles() const
+{
+    return d->observed_roles;
+}
+
 void AbstractObjectModel::UpdateItemsConnections()
 {
     if (d->update_item_connections_queued)
@@ -0,0 +1,110 @@
+#include "async_applier.h"
+#include <QRunnable>
+#include <QThreadPool>
+#include <atomic>
+#include <mutex>
+
+using namespace om;
+
+struct AsyncApplier::State
+{
+    // Защищает object: результат ставится в очередь объекта только пока объект существует
+    std::mutex           mutex;
+    QObject*             object = nullptr;
+    std::atomic<quint64> generation{ 0 };  // номер последней запущенной задачи
+    std::atomic<quint64> finished{ 0 };    // номер последней задачи, результат которой вызван или отброшен
+    std::atomic<quint64> dropped{ 0 };
+    quint64              applied = 0;  // используется только в потоке объекта
+
+    bool IsStale(quint64 task_generation) const { return generation.load(std::memory_order_acquire) != task_generation; }
+
+    void Drop(quint64 task_generation)
+    {
+        ++dropped;
+        // устаревшая задача не отменяет ожидание более новой
+        if (!IsStale(task_generation))
+            finished.store(task_generation, std::memory_order_release);
+    }
+};
+
+namespace
+{
+class TaskRunnable : public QRunnable
+{
+public:
+    explicit TaskRunnable(std::function<void()> run) : run_(std::move(run)) {}
+    void run() override { run_(); }
+
+private:
+    std::function<void()> run_;
+};
+}  // namespace
+
+AsyncApplier::AsyncApplier(QObject* object) : state_(std::make_shared<State>()), pool_(QThreadPool::globalInstance())
+{
+    state_->object = object;
+}
+
+AsyncApplier::~AsyncApplier()
+{
+    Cancel();
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->object = nullptr;
+}
+
+QThreadPool* AsyncApplier::GetThreadPool() const
+{
+    return pool_;
+}
+
+void AsyncApplier::SetThreadPool(QThreadPool* pool)
+{
+    pool_ = pool ? pool : QThreadPool::globalInstance();
+}
+
+void AsyncApplier::Start(Task task)
+{
+    auto generation = ++state_->generation;
+    auto state      = state_;
+    pool_->start(new TaskRunnable([state, generation, task = std::move(task)] {
+        // задача, замененная более новой до запуска, не выполняется
+        if (state->IsStale(generation))
+            return state->Drop(generation);
+        auto apply = task();
+
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (!apply || !state->object || state->IsStale(generation))
+            return state->Drop(generation);
+        QMetaObject::invokeMethod(
+            state->object,
+            [state, generation, apply] {
+                // более новая задача запущена, пока результат ждал в очереди
+                if (state->IsStale(generation))
+                    return state->Drop(generation);
+                ++state->applied;
+                state->finished.store(generation, std::memory_order_release);
+                apply();
+            },
+            Qt::QueuedConnection);
+    }));
+}
+
+void AsyncApplier::Cancel()
+{
+    state_->finished.store(++state_->generation, std::memory_order_release);
+}
+
+bool AsyncApplier::IsRunning() const
+{
+    return state_->finished.load(std::memory_order_acquire) != state_->generation.load(std::memory_order_acquire);
+}
+
+quint64 AsyncApplier::GetAppliedCount() const
+{
+    return state_->applied;
+}
+
+quint64 AsyncApplier::GetDroppedCount() const
+{
+    return state_->dropped.load(std::memory_order_relaxed);
+}
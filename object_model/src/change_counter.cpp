@@ -0,0 +1,21 @@
+#include "change_counter.h"
+#include <QObject>
+
+using namespace om;
+
+quint64 ChangeCounter::GetChangeCount() const
+{
+    return change_count_;
+}
+
+void ChangeCounter::MarkChanged(QObject* object)
+{
+    // вложенные объекты и модели - дети своих родителей, поэтому изменение поднимается по дереву QObject
+    for (; object; object = object->parent())
+    {
+        auto counter = dynamic_cast<ChangeCounter*>(object);
+        if (!counter)
+            return;
+        ++counter->change_count_;
+    }
+}
@@ -0,0 +1,179 @@
+#include "change_dispatcher.h"
+#include <QThread>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+using namespace om;
+
+namespace
+{
+// Остается действительным до конца деструктора диспетчера, объекты, сброшенные им, могут снова ставить себя в очередь
+thread_local ChangeDispatcher* current_dispatcher = nullptr;
+}  // namespace
+
+// Entry
+ChangeDispatcher::Entry::Entry(QObject* object, FlushFunction flush) : object_(object), flush_(flush)
+{}
+
+ChangeDispatcher::Entry::~Entry()
+{
+    Unlink();
+}
+
+void ChangeDispatcher::Entry::Enqueue()
+{
+    if (IsQueued())
+        return;
+    // объект, измененный в другом потоке (до переноса в свой поток), ставится в очередь диспетчера своего потока отложенным событием.
+    // Оно переносится вместе с объектом, если объект будет перенесен в другой поток до его обработки
+    if (object_->thread() != QThread::currentThread())
+        PostEnqueue();
+    else
+        ChangeDispatcher::GetInstance()->Enqueue(this);
+}
+
+void ChangeDispatcher::Entry::OnThreadChange()
+{
+    if (!IsQueued())
+        return;
+    Unlink();
+    PostEnqueue();
+}
+
+bool ChangeDispatcher::Entry::IsQueued() const
+{
+    return next_ != nullptr;
+}
+
+void ChangeDispatcher::Entry::Unlink()
+{
+    if (!next_)
+        return;
+    prev_->next_ = next_;
+    next_->prev_ = prev_;
+    prev_        = nullptr;
+    next_        = nullptr;
+}
+
+void ChangeDispatcher::Entry::PostEnqueue()
+{
+    QMetaObject::invokeMethod(object_, [this] { Enqueue(); }, Qt::QueuedConnection);
+}
+
+void ChangeDispatcher::Entry::LinkBefore(Entry* next)
+{
+    prev_        = next->prev_;
+    next_        = next;
+    prev_->next_ = this;
+    next->prev_  = this;
+}
+
+// Dispatcher
+ChangeDispatcher::ChangeDispatcher()
+{
+    // пустой список - кольцо из одного заголовка
+    deferred_.prev_ = deferred_.next_ = &deferred_;
+    current_dispatcher = this;
+}
+
+ChangeDispatcher::~ChangeDispatcher()
+{
+    // поток завершается: объекты, оставшиеся в очереди, сбрасываются сразу, иначе их флаги ожидания сигналов не будут сняты
+    // и они больше не испустят сигналы. Повторно измененные объекты сбрасываются в том же цикле
+    closing_ = true;
+    Flush();
+    current_dispatcher = nullptr;
+}
+
+ChangeDispatcher* ChangeDispatcher::GetInstance()
+{
+    static thread_local std::unique_ptr<ChangeDispatcher> instance(new ChangeDispatcher());
+    return current_dispatcher ? current_dispatcher : instance.get();
+}
+
+int ChangeDispatcher::GetLastFlushCount() const
+{
+    return last_flush_count_;
+}
+
+quint64 ChangeDispatcher::GetFlushCycle() const
+{
+    return flush_cycle_;
+}
+
+bool ChangeDispatcher::IsEmpty(const Entry& list)
+{
+    return list.next_ == &list;
+}
+
+ChangeDispatcher::Entry* ChangeDispatcher::GetLevel(int depth)
+{
+    while (static_cast<int>(levels_.size()) <= depth)
+    {
+        levels_.push_back(std::make_unique<Entry>(nullptr, nullptr));
+        levels_.back()->prev_ = levels_.back()->next_ = levels_.back().get();
+    }
+    return levels_[depth].get();
+}
+
+void ChangeDispatcher::Enqueue(Entry* entry)
+{
+    entry->depth_ = 0;
+    for (auto parent = entry->object_->parent(); parent; parent = parent->parent()) ++entry->depth_;
+
+    // объект, измененный повторно после своего сброса в текущем цикле, сбрасывается следующим событием, иначе цикл может не закончиться
+    if (flushing_ && !closing_ && entry->flush_cycle_ == flush_cycle_)
+    {
+        entry->LinkBefore(&deferred_);
+        return;
+    }
+    entry->LinkBefore(GetLevel(entry->depth_));
+    max_depth_ = std::max(max_depth_, entry->depth_);
+    if (!flushing_)
+        PostFlush();
+}
+
+void ChangeDispatcher::PostFlush()
+{
+    if (flush_posted_)
+        return;
+    flush_posted_ = true;
+    QMetaObject::invokeMethod(this, [this] { Flush(); }, Qt::QueuedConnection);
+}
+
+void ChangeDispatcher::Flush()
+{
+    flush_posted_ = false;
+    flushing_     = true;
+    ++flush_cycle_;
+
+    // всегда сбрасывается самый глубокий объект: родители, поставленные в очередь дочерними объектами, сбрасываются после всех них.
+    // Объекты могут быть удалены обработчиками сигналов, поэтому очередь разбирается по одному объекту
+    int count = 0;
+    for (;;)
+    {
+        while (max_depth_ >= 0 && IsEmpty(*levels_[max_depth_])) --max_depth_;
+        if (max_depth_ < 0)
+            break;
+        auto entry = levels_[max_depth_]->next_;
+        entry->Unlink();
+        entry->flush_cycle_ = flush_cycle_;
+        ++count;
+        entry->flush_(entry->object_);
+    }
+
+    flushing_         = false;
+    last_flush_count_ = count;
+
+    if (closing_ || IsEmpty(deferred_))
+        return;
+    while (!IsEmpty(deferred_))
+    {
+        auto entry = deferred_.next_;
+        entry->Unlink();
+        entry->LinkBefore(GetLevel(entry->depth_));
+        max_depth_ = std::max(max_depth_, entry->depth_);
+    }
+    PostFlush();
+}
@@ -26,7 +26,7 @@ void EnumerationFilter::SetValues(const QVariantList& values)
             throw std::logic_error("Can not convert value to int");
     }
     emit valuesChanged();
-    EmitFilterChanged();
+    EmitFilterChanged(FilterChange::VALUES_TOGGLED);
 }
 
 bool EnumerationFilter::HasValue(int val)
@@ -48,7 +48,7 @@ void EnumerationFilter::AddValue(int val)
         return;
     values_.insert(val);
     emit valuesChanged();
-    EmitFilterChanged();
+    EmitFilterChanged(FilterChange::VALUES_TOGGLED);
 }
 
 void EnumerationFilter::RemoveValue(int val)
@@ -57,14 +57,14 @@ void EnumerationFilter::RemoveValue(int val)
         return;
     values_.erase(val);
     emit valuesChanged();
-    EmitFilterChanged();
+    EmitFilterChanged(FilterChange::VALUES_TOGGLED);
 }
 
 void EnumerationFilter::ClearValues()
 {
     values_.clear();
     emit valuesChanged();
-    EmitFilterChanged();
+    EmitFilterChanged(FilterChange::VALUES_TOGGLED);
 }
 
 bool EnumerationFilter::Accepts(const QModelIndex& index, const std::pair<QByteArray, int>& role) const
@@ -87,7 +87,7 @@ void StringEnumerationFilter::SetValues(const QStringList& values)
 {
     values_ = boost::container::flat_set<QString>(values.begin(), values.end());
     emit valuesChanged();
-    EmitFilterChanged();
+    EmitFilterChanged(FilterChange::VALUES_TOGGLED);
 }
 
 bool StringEnumerationFilter::HasValue(const QString& val)
@@ -109,7 +109,7 @@ void StringEnumerationFilter::AddValue(const QString& val)
         return;
     values_.insert(val);
     emit valuesChanged();
-    EmitFilterChanged();
+    EmitFilterChanged(FilterChange::VALUES_TOGGLED);
 }
 
 void StringEnumerationFilter::RemoveValue(const QString& val)
@@ -118,14 +118,14 @@ void StringEnumerationFilter::RemoveValue(const QString& val)
         return;
     values_.erase(val);
     emit valuesChanged();
-    EmitFilterChanged();
+    EmitFilterChanged(FilterChange::VALUES_TOGGLED);
 }
 
 void StringEnumerationFilter::ClearValues()
 {
     values_.clear();
     emit valuesChanged();
-    EmitFilterChanged();
+    EmitFilterChanged(FilterChange::VALUES_TOGGLED);
 }
 
 bool StringEnumerationFilter::Accepts(const QModelIndex& index, const std::pair<QByteArray, int>& role) const
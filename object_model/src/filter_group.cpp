@@ -24,7 +24,11 @@ void FilterGroup::UpdateRoles()
 
 void FilterGroup::ConnectFilter(AbstractFilter* filter)
 {
-    connect(filter, &AbstractFilter::filterChanged, this, &FilterGroup::filterChanged);
+    // группы AND и OR сохраняют направление изменения вложенного фильтра
+    connect(filter, &AbstractFilter::filterChanged, this, [=] {
+        last_change_ = filter->GetLastChange();
+        emit filterChanged();
+    });
     connect(filter, &AbstractFilter::rolesChanged, this, &FilterGroup::rolesChanged);
     connect(filter, &AbstractFilter::destroyed, this, [=] { Remove(filter); });
 }
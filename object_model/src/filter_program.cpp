@@ -0,0 +1,884 @@
+#include "filter_program.h"
+#include "abstract_object_model.h"
+#include "enumeration_filter.h"
+#include "filter_group.h"
+#include "null_object_filter.h"
+#include "range_filter.h"
+#include "regular_expression_filter.h"
+#include "trigram_index.h"
+
+#include <QtAlgorithms>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+using namespace om;
+
+namespace
+{
+using ComparisonResult   = AbstractFilterComparatorBase::ComparisonResult;
+using ComparisonOperator = ComparisonFilter::ComparisonOperator;
+using RangeCheckType     = AbstractFilterComparatorBase::RangeCheckType;
+
+// Как в ComparisonFilter::Accepts
+bool MatchesComparison(ComparisonOperator comparison_operator, ComparisonResult res)
+{
+    switch (comparison_operator)
+    {
+    case ComparisonOperator::EQUAL:
+        return res == ComparisonResult::EQUAL;
+    case ComparisonOperator::INEQUAL:
+        return res != ComparisonResult::EQUAL;
+    case ComparisonOperator::LESS:
+        return res == ComparisonResult::LESS;
+    case ComparisonOperator::LESS_OR_EQUAL:
+        return res == ComparisonResult::LESS || res == ComparisonResult::EQUAL;
+    case ComparisonOperator::GREATER:
+        return res == ComparisonResult::GREATER;
+    case ComparisonOperator::GREATER_OR_EQUAL:
+        return res == ComparisonResult::GREATER || res == ComparisonResult::EQUAL;
+    default:
+        return false;
+    }
+}
+
+// Как в RangeFilter::Accepts
+bool InRange(RangeCheckType type, double from, double to, double value)
+{
+    switch (type)
+    {
+    case RangeCheckType::INSIDE:
+        return value > from && value < to;
+    case RangeCheckType::OUTSIDE:
+        return value < from || value > to;
+    case RangeCheckType::INSIDE_OR_EQUAL:
+        return value >= from && value <= to;
+    case RangeCheckType::OUTSIDE_OR_EQUAL:
+        return value <= from || value >= to;
+    }
+    return true;
+}
+
+// Индекс не ищется для нескольких измененных строк
+constexpr int kMinIndexedRowCount = 256;
+
+// Литеральное начало выражения, которое содержит любое его совпадение. Пустое, если такого начала нет
+QString GetLiteralPrefix(const QRegularExpression& regular_expression)
+{
+    if (regular_expression.patternOptions().testFlag(QRegularExpression::ExtendedPatternSyntaxOption))
+        return QString();
+
+    // альтернатива может совпасть без начала
+    const auto pattern = regular_expression.pattern();
+    for (int i = 0; i < pattern.size(); ++i)
+    {
+        if (pattern[i] == '\\')
+            ++i;
+        else if (pattern[i] == '|')
+            return QString();
+    }
+
+    static const QString kMetaCharacters = QStringLiteral("\\^$.|?*+()[]{}");
+    QString              res;
+    for (int i = pattern.startsWith('^') ? 1 : 0; i < pattern.size(); ++i)
+    {
+        auto c = pattern[i];
+        // экранированные буквы и цифры - классы символов и ссылки
+        if (c == '\\' && i + 1 < pattern.size() && !pattern[i + 1].isLetterOrNumber())
+            c = pattern[++i];
+        else if (kMetaCharacters.contains(c))
+        {
+            // квантификатор может убрать последний символ из совпадения
+            if ((c == '?' || c == '*' || c == '{') && !res.isEmpty())
+                res.chop(res.size() > 1 && res.back().isLowSurrogate() && res[res.size() - 2].isHighSurrogate() ? 2 : 1);
+            break;
+        }
+        res.append(c);
+    }
+    return res;
+}
+
+// Как в RangeFilter::Accepts, нечисловые значения не попадают ни в один диапазон
+double ReadRangeValue(const QAbstractItemModel* model, int source_row, Id role)
+{
+    bool ok    = false;
+    auto value = model->data(model->index(source_row, 0), role).toDouble(&ok);
+    return ok ? value : std::numeric_limits<double>::quiet_NaN();
+}
+
+template <typename Bits, typename Predicate>
+void Select(int count, Bits& bits, Predicate predicate)
+{
+    for (int i = 0; i < count; ++i)
+        if (predicate(i))
+            bits.SetBit(i);
+}
+
+// Строки идут подряд от первой строки модели
+bool IsAllRows(const QAbstractItemModel* model, const QVector<int>& source_rows)
+{
+    return source_rows.size() == model->rowCount() && source_rows.front() == 0 &&
+           std::adjacent_find(source_rows.begin(), source_rows.end(), std::greater_equal<int>()) == source_rows.end();
+}
+}  // namespace
+
+FilterProgram::Bitmap::Bitmap(int size /*= 0*/, bool value /*= false*/) : size(size), words((size + 63) / 64, value ? ~quint64(0) : 0)
+{
+    if (value && size % 64)
+        words.back() &= (quint64(1) << size % 64) - 1;
+}
+
+FilterProgram::Bitmap& FilterProgram::Bitmap::operator&=(const Bitmap& other)
+{
+    auto       data       = words.data();
+    const auto other_data = other.words.data();
+    for (size_t i = 0, count = words.size(); i < count; ++i) data[i] &= other_data[i];
+    return *this;
+}
+
+FilterProgram::Bitmap& FilterProgram::Bitmap::operator|=(const Bitmap& other)
+{
+    auto       data       = words.data();
+    const auto other_data = other.words.data();
+    for (size_t i = 0, count = words.size(); i < count; ++i) data[i] |= other_data[i];
+    return *this;
+}
+
+void FilterProgram::Bitmap::Invert()
+{
+    for (auto& word : words) word = ~word;
+    // биты за последней строкой остаются нулевыми
+    if (size % 64)
+        words.back() &= (quint64(1) << size % 64) - 1;
+}
+
+template <typename Function>
+void FilterProgram::Bitmap::ForEachSetBit(Function function) const
+{
+    for (size_t i = 0; i < words.size(); ++i)
+        for (auto word = words[i]; word; word &= word - 1) function(static_cast<int>(i * 64 + qCountTrailingZeroBits(word)));
+}
+
+QBitArray FilterProgram::Bitmap::ToBitArray() const
+{
+    QBitArray res(size);
+    ForEachSetBit([&](int i) { res.setBit(i); });
+    return res;
+}
+
+void FilterProgram::Compile(const AbstractFilter* filter, const IdsMap& role_ids_map)
+{
+    if (role_ids_map != role_ids_map_)
+        ClearCache();
+    auto old_instructions = std::move(instructions_);
+    auto old_column_roles = std::move(column_roles_);
+    instructions_.clear();
+    column_roles_.clear();
+    column_values_.clear();
+    role_ids_map_ = role_ids_map;
+    if (filter)
+        CompileFilter(filter);
+    UpdateChangedValues(old_instructions, old_column_roles);
+
+    // поиск по роли закончен, когда в ней больше не ищут подстроку или выражение, индексы - когда роль не фильтруется ими
+    Ids                                               searched_roles, range_roles;
+    boost::container::flat_set<std::pair<Id, OpCode>> enumeration_roles;
+    for (const auto& instruction : instructions_)
+    {
+        if (instruction.op == SUBSTRING || instruction.op == REGULAR_EXPRESSION)
+            searched_roles.insert(column_roles_[instruction.column]);
+        else if (instruction.op == RANGE)
+            range_roles.insert(column_roles_[instruction.column]);
+        else if (instruction.op == ENUMERATION || instruction.op == STRING_ENUMERATION)
+            enumeration_roles.insert({ column_roles_[instruction.column], instruction.op });
+    }
+    for (auto it = string_caches_.begin(); it != string_caches_.end();)
+        it = searched_roles.contains(it->first) ? std::next(it) : string_caches_.erase(it);
+    for (auto it = range_indexes_.begin(); it != range_indexes_.end();)
+        it = range_roles.contains(it->first) ? std::next(it) : range_indexes_.erase(it);
+    for (auto it = value_indexes_.begin(); it != value_indexes_.end();)
+        it = enumeration_roles.contains(it->first) ? std::next(it) : value_indexes_.erase(it);
+}
+
+void FilterProgram::Clear()
+{
+    instructions_.clear();
+    column_roles_.clear();
+    column_values_.clear();
+    role_ids_map_.clear();
+    ClearCache();
+    changed_values_.clear();
+    changed_values_valid_ = false;
+}
+
+void FilterProgram::InvalidateCache(const QVector<int>& source_rows)
+{
+    for (auto& cache : string_caches_)
+        for (auto source_row : source_rows)
+            if (source_row >= 0 && source_row < static_cast<int>(cache.second.states.size()))
+                cache.second.states[source_row] = StringCache::EMPTY;
+    // индекс со многими измененными строками строится заново при следующем использовании
+    for (auto& index : range_indexes_)
+    {
+        index.second.stale_rows.insert(index.second.stale_rows.end(), source_rows.begin(), source_rows.end());
+        if (index.second.stale_rows.size() > index.second.values.size() / 16)
+            index.second = RangeIndex();
+    }
+    for (auto& index : value_indexes_)
+    {
+        index.second.stale_rows.insert(index.second.stale_rows.end(), source_rows.begin(), source_rows.end());
+        if (index.second.stale_rows.size() > index.second.row_values.size() / 16)
+            index.second = ValueIndex();
+    }
+}
+
+void FilterProgram::ClearCache()
+{
+    string_caches_.clear();
+    range_indexes_.clear();
+    value_indexes_.clear();
+}
+
+bool FilterProgram::TakeChangedRows(const QAbstractItemModel* model, QVector<int>& source_rows)
+{
+    auto changed_values = std::exchange(changed_values_, {});
+    if (!std::exchange(changed_values_valid_, true))
+        return false;
+
+    for (const auto& changed : changed_values)
+    {
+        if (changed.op == RANGE)
+        {
+            const auto& entries = GetRangeIndex(model, changed.role).entries;
+            auto        first   = std::lower_bound(entries.begin(), entries.end(), std::make_pair(changed.from, std::numeric_limits<int>::min()));
+            auto        last    = std::upper_bound(first, entries.end(), std::make_pair(changed.to, std::numeric_limits<int>::max()));
+            for (auto it = first; it != last; ++it) source_rows.push_back(it->second);
+            continue;
+        }
+
+        // только строки с добавленными и удаленными значениями
+        const auto& index = GetValueIndex(model, changed.role, changed.op);
+        for (const auto& key : changed.keys)
+            if (auto value_id = index.value_ids.find(key); value_id != index.value_ids.end())
+                index.bitmaps[value_id.value()].ForEachSetBit([&](int source_row) { source_rows.push_back(source_row); });
+    }
+    std::sort(source_rows.begin(), source_rows.end());
+    source_rows.erase(std::unique(source_rows.begin(), source_rows.end()), source_rows.end());
+    return true;
+}
+
+void FilterProgram::ResetChangedRows()
+{
+    changed_values_.clear();
+    changed_values_valid_ = true;
+}
+
+int FilterProgram::GetRowCallCount() const
+{
+    return std::count_if(instructions_.begin(), instructions_.end(), [](const Instruction& instruction) { return instruction.op == CALL_FILTER; });
+}
+
+void FilterProgram::CompileFilter(const AbstractFilter* filter)
+{
+    if (!filter->IsEnabled())
+        return Push(ACCEPT_ALL, 0);
+
+    // подклассы могут переопределять Accepts, поэтому компилируются только фильтры известных классов
+    const auto meta_object = filter->metaObject();
+    if (meta_object == &FilterGroup::staticMetaObject)
+    {
+        // как в FilterGroup::AcceptsRow: выключенные фильтры не влияют на результат, инверсия группы не учитывается
+        auto group    = static_cast<const FilterGroup*>(filter);
+        auto operands = 0;
+        for (auto child : group->GetFilters())
+        {
+            if (!child->IsEnabled())
+                continue;
+            CompileFilter(child);
+            ++operands;
+        }
+        auto is_and = group->GetLogicalOperator() == AbstractFilter::LogicalOperator::AND;
+        if (operands == 0)
+            Push(is_and ? ACCEPT_ALL : REJECT_ALL, 0);
+        else if (operands > 1)
+            Push(is_and ? AND : OR, operands);
+        return;
+    }
+
+    Instruction instruction;
+    if (meta_object == &ComparisonFilter::staticMetaObject)
+    {
+        auto comparison_filter          = static_cast<const ComparisonFilter*>(filter);
+        instruction.op                  = COMPARE;
+        instruction.value               = comparison_filter->GetComparisonValue();
+        instruction.comparison_operator = comparison_filter->GetComparisonOperator();
+    }
+    else if (meta_object == &RangeFilter::staticMetaObject)
+    {
+        auto range_filter            = static_cast<const RangeFilter*>(filter);
+        instruction.op               = RANGE;
+        instruction.from             = range_filter->GetFrom();
+        instruction.to               = range_filter->GetTo();
+        instruction.range_check_type = range_filter->GetRangeCheckType();
+    }
+    else if (meta_object == &EnumerationFilter::staticMetaObject)
+    {
+        instruction.op = ENUMERATION;
+        for (const auto& value : static_cast<const EnumerationFilter*>(filter)->GetValues()) instruction.ints.insert(value.toInt());
+    }
+    else if (meta_object == &StringEnumerationFilter::staticMetaObject)
+    {
+        auto values         = static_cast<const StringEnumerationFilter*>(filter)->GetValues();
+        instruction.op      = STRING_ENUMERATION;
+        instruction.strings = boost::container::flat_set<QString>(values.begin(), values.end());
+    }
+    else if (meta_object == &SubstringFilter::staticMetaObject)
+    {
+        auto substring_filter = static_cast<const SubstringFilter*>(filter);
+        auto substring        = substring_filter->GetSubstring();
+        instruction.op        = substring.isEmpty() ? ACCEPT_ALL : SUBSTRING;
+        // строки без учета регистра сравниваются свернутыми, свернутые строки строк кэшируются
+        instruction.folded       = substring_filter->IsCaseInsensitive();
+        instruction.matcher      = QStringMatcher(instruction.folded ? substring.toCaseFolded() : substring, Qt::CaseSensitive);
+        instruction.indexed_text = substring;
+    }
+    else if (meta_object == &RegularExpressionFilter::staticMetaObject)
+    {
+        instruction.op                 = REGULAR_EXPRESSION;
+        instruction.regular_expression = static_cast<const RegularExpressionFilter*>(filter)->GetRegularExpression();
+        instruction.indexed_text       = GetLiteralPrefix(instruction.regular_expression);
+    }
+    else if (meta_object == &NullObjectFilter::staticMetaObject)
+    {
+        instruction.op = NOT_NULL_OBJECT;
+    }
+    else
+    {
+        instruction.op     = CALL_FILTER;
+        instruction.filter = filter;
+        instructions_.push_back(instruction);
+        return;
+    }
+    CompileRoleFilter(filter, instruction);
+}
+
+void FilterProgram::CompileRoleFilter(const AbstractFilter* filter, const Instruction& instruction)
+{
+    // фильтр без ролей читает роль 0, как AbstractFilter::AcceptsRow
+    std::vector<Id> role_ids;
+    for (const auto& role : filter->GetRoles())
+    {
+        auto role_id = role_ids_map_.find(role);
+        if (role_id == role_ids_map_.end())
+        {
+            // AcceptsRow бросает исключение об отсутствующей роли
+            Instruction call;
+            call.op     = CALL_FILTER;
+            call.filter = filter;
+            instructions_.push_back(call);
+            return;
+        }
+        role_ids.push_back(role_id->second);
+    }
+    if (role_ids.empty())
+        role_ids.push_back(0);
+
+    for (auto role_id : role_ids)
+    {
+        instructions_.push_back(instruction);
+        if (instruction.op == ACCEPT_ALL)
+            continue;
+        auto column                 = GetColumnIndex(role_id);
+        instructions_.back().column = column;
+        // строки и значения перечислений читаются только для строк, которых нет в кэше и индексах
+        if (instruction.op != SUBSTRING && instruction.op != REGULAR_EXPRESSION && instruction.op != ENUMERATION && instruction.op != STRING_ENUMERATION)
+            column_values_[column] = true;
+    }
+    if (role_ids.size() > 1)
+        Push(filter->GetLogicalOperator() == AbstractFilter::LogicalOperator::AND ? AND : OR, role_ids.size(), filter->IsInveted());
+    else
+        instructions_.back().inverted = filter->IsInveted();
+}
+
+void FilterProgram::Push(OpCode op, int operands, bool inverted /*= false*/)
+{
+    Instruction instruction;
+    instruction.op       = op;
+    instruction.operands = operands;
+    instruction.inverted = inverted;
+    instructions_.push_back(instruction);
+}
+
+int FilterProgram::GetColumnIndex(Id role)
+{
+    auto it = std::find(column_roles_.begin(), column_roles_.end(), role);
+    if (it != column_roles_.end())
+        return it - column_roles_.begin();
+    column_roles_.push_back(role);
+    column_values_.push_back(false);
+    return column_roles_.size() - 1;
+}
+
+void FilterProgram::UpdateChangedValues(const std::vector<Instruction>& old_instructions, const std::vector<Id>& old_column_roles)
+{
+    // программы должны отличаться только границами диапазонов и значениями перечислений, изменения вызываемых фильтров неизвестны
+    if (old_instructions.size() != instructions_.size() || old_column_roles != column_roles_ || GetRowCallCount() > 0)
+    {
+        changed_values_valid_ = false;
+        return;
+    }
+    for (size_t i = 0; i < instructions_.size(); ++i)
+    {
+        const auto& old_instruction = old_instructions[i];
+        const auto& instruction     = instructions_[i];
+        if (old_instruction.op != instruction.op || old_instruction.column != instruction.column || old_instruction.operands != instruction.operands ||
+            old_instruction.inverted != instruction.inverted || old_instruction.range_check_type != instruction.range_check_type)
+        {
+            changed_values_valid_ = false;
+            return;
+        }
+
+        ChangedValues changed;
+        changed.role = instruction.column >= 0 ? column_roles_[instruction.column] : kInvalidId;
+        changed.op   = instruction.op;
+        if (instruction.op == RANGE)
+        {
+            // принадлежность диапазону меняется только у значений между старой и новой границей, включая их
+            if (old_instruction.from != instruction.from)
+            {
+                changed.from = qMin(old_instruction.from, instruction.from);
+                changed.to   = qMax(old_instruction.from, instruction.from);
+                changed_values_.push_back(changed);
+            }
+            if (old_instruction.to != instruction.to)
+            {
+                changed.from = qMin(old_instruction.to, instruction.to);
+                changed.to   = qMax(old_instruction.to, instruction.to);
+                changed_values_.push_back(changed);
+            }
+        }
+        else if (instruction.op == ENUMERATION && old_instruction.ints != instruction.ints)
+        {
+            std::vector<int> toggled;
+            std::set_symmetric_difference(old_instruction.ints.begin(), old_instruction.ints.end(), instruction.ints.begin(), instruction.ints.end(),
+                                          std::back_inserter(toggled));
+            for (auto value : toggled) changed.keys.push_back(QString::number(value));
+            changed_values_.push_back(changed);
+        }
+        else if (instruction.op == STRING_ENUMERATION && old_instruction.strings != instruction.strings)
+        {
+            std::set_symmetric_difference(old_instruction.strings.begin(), old_instruction.strings.end(), instruction.strings.begin(),
+                                          instruction.strings.end(), std::back_inserter(changed.keys));
+            changed_values_.push_back(changed);
+        }
+    }
+}
+
+const FilterProgram::RangeIndex& FilterProgram::GetRangeIndex(const QAbstractItemModel* model, Id role)
+{
+    auto& index = range_indexes_[role];
+    std::sort(index.stale_rows.begin(), index.stale_rows.end());
+    index.stale_rows.erase(std::unique(index.stale_rows.begin(), index.stale_rows.end()), index.stale_rows.end());
+
+    // немного измененных строк переставляются в индексе, иначе он строится заново
+    const int row_count = model->rowCount();
+    if (static_cast<int>(index.values.size()) == row_count && index.stale_rows.size() <= index.values.size() / 16)
+    {
+        for (auto source_row : index.stale_rows)
+        {
+            if (source_row < 0 || source_row >= row_count)
+                continue;
+            auto& value = index.values[source_row];
+            if (!std::isnan(value))
+                index.entries.erase(std::lower_bound(index.entries.begin(), index.entries.end(), std::make_pair(value, source_row)));
+            value = ReadRangeValue(model, source_row, role);
+            if (!std::isnan(value))
+                index.entries.insert(std::lower_bound(index.entries.begin(), index.entries.end(), std::make_pair(value, source_row)), { value, source_row });
+        }
+    }
+    else
+    {
+        index.entries.clear();
+        index.values.resize(row_count);
+        for (int source_row = 0; source_row < row_count; ++source_row)
+        {
+            index.values[source_row] = ReadRangeValue(model, source_row, role);
+            if (!std::isnan(index.values[source_row]))
+                index.entries.emplace_back(index.values[source_row], source_row);
+        }
+        std::sort(index.entries.begin(), index.entries.end());
+    }
+    index.stale_rows.clear();
+    return index;
+}
+
+const FilterProgram::ValueIndex& FilterProgram::GetValueIndex(const QAbstractItemModel* model, Id role, OpCode op) const
+{
+    auto& index = value_indexes_[{ role, op }];
+    std::sort(index.stale_rows.begin(), index.stale_rows.end());
+    index.stale_rows.erase(std::unique(index.stale_rows.begin(), index.stale_rows.end()), index.stale_rows.end());
+
+    // немного измененных строк переносятся в битовые карты новых значений, иначе индекс строится заново
+    const int row_count = model->rowCount();
+    if (static_cast<int>(index.row_values.size()) == row_count && index.stale_rows.size() <= index.row_values.size() / 16)
+    {
+        for (auto source_row : index.stale_rows)
+        {
+            if (source_row < 0 || source_row >= row_count)
+                continue;
+            auto& value_id = index.row_values[source_row];
+            if (value_id >= 0)
+                index.bitmaps[value_id].ClearBit(source_row);
+            value_id = index.GetValueId(ReadEnumerationKey(model, source_row, role, op), row_count);
+            if (value_id >= 0)
+                index.bitmaps[value_id].SetBit(source_row);
+        }
+    }
+    else
+    {
+        index = ValueIndex();
+        index.row_values.resize(row_count);
+        for (int source_row = 0; source_row < row_count; ++source_row)
+        {
+            auto value_id                 = index.GetValueId(ReadEnumerationKey(model, source_row, role, op), row_count);
+            index.row_values[source_row] = value_id;
+            if (value_id >= 0)
+                index.bitmaps[value_id].SetBit(source_row);
+        }
+    }
+    index.stale_rows.clear();
+    return index;
+}
+
+QString FilterProgram::ReadEnumerationKey(const QAbstractItemModel* model, int source_row, Id role, OpCode op)
+{
+    // как в EnumerationFilter::Accepts и StringEnumerationFilter::Accepts
+    auto value = model->data(model->index(source_row, 0), role);
+    if (op == STRING_ENUMERATION)
+        return value.toString();
+    bool ok        = true;
+    auto int_value = value.toInt(&ok);
+    return ok ? QString::number(int_value) : QString();
+}
+
+int FilterProgram::ValueIndex::GetValueId(const QString& key, int row_count)
+{
+    if (key.isEmpty())
+        return -1;
+    auto value_id = value_ids.find(key);
+    if (value_id != value_ids.end())
+        return value_id.value();
+    bitmaps.emplace_back(row_count);
+    return value_ids.insert(key, bitmaps.size() - 1).value();
+}
+
+QBitArray FilterProgram::Evaluate(const QAbstractItemModel* model, const QVector<int>& source_rows) const
+{
+    if (instructions_.empty() || source_rows.isEmpty())
+        return QBitArray(source_rows.size(), true);
+    return Evaluate(*Read(model, source_rows));
+}
+
+std::shared_ptr<const FilterProgram::Snapshot> FilterProgram::Read(const QAbstractItemModel* model, const QVector<int>& source_rows) const
+{
+    auto snapshot          = std::make_shared<Snapshot>();
+    snapshot->count        = source_rows.size();
+    snapshot->instructions = instructions_;
+    if (instructions_.empty() || source_rows.isEmpty())
+        return snapshot;
+
+    // каждая роль читается из модели один раз для всех строк
+    auto& columns = snapshot->columns;
+    columns.resize(column_roles_.size());
+    for (size_t c = 0; c < columns.size(); ++c)
+        if (column_values_[c])
+            ReadColumn(model, source_rows, column_roles_[c], columns[c]);
+
+    // фильтры, кэши и индексы используются только здесь, дальше снимок вычисляется без модели
+    snapshot->operands.resize(instructions_.size());
+    for (size_t i = 0; i < instructions_.size(); ++i)
+    {
+        const auto& instruction = instructions_[i];
+        auto&       operand     = snapshot->operands[i];
+        switch (instruction.op)
+        {
+        case CALL_FILTER:
+            operand.selected = true;
+            operand.bits     = Bitmap(snapshot->count);
+            Select(snapshot->count, operand.bits,
+                   [&](int row) { return instruction.filter->AcceptsRow(model->index(source_rows[row], 0), role_ids_map_); });
+            break;
+        case SUBSTRING:
+        case REGULAR_EXPRESSION: {
+            const auto role = column_roles_[instruction.column];
+            operand.indexed = SelectCandidates(model, source_rows, role, instruction.indexed_text, operand.candidates);
+            ReadCachedStrings(model, source_rows, role, instruction.folded, columns[instruction.column], operand.indexed ? &operand.candidates : nullptr,
+                              operand.strings);
+            break;
+        }
+        case ENUMERATION:
+        case STRING_ENUMERATION:
+            operand.bits     = Bitmap(snapshot->count);
+            operand.selected = SelectValueRows(model, source_rows, instruction, operand.bits);
+            if (!operand.selected && columns[instruction.column].values.empty())
+                ReadColumn(model, source_rows, column_roles_[instruction.column], columns[instruction.column]);
+            break;
+        default:
+            break;
+        }
+    }
+    return snapshot;
+}
+
+QBitArray FilterProgram::Evaluate(const Snapshot& snapshot)
+{
+    const int count = snapshot.count;
+    if (snapshot.instructions.empty() || count == 0)
+        return QBitArray(count, true);
+
+    std::vector<Bitmap> stack;
+    for (size_t index = 0; index < snapshot.instructions.size(); ++index)
+    {
+        const auto& instruction = snapshot.instructions[index];
+        const auto& operand     = snapshot.operands[index];
+        Bitmap      bits(count, instruction.op == ACCEPT_ALL);
+        switch (instruction.op)
+        {
+        case ACCEPT_ALL:
+        case REJECT_ALL:
+            break;
+        case AND:
+        case OR:
+            bits = std::move(stack.back());
+            stack.pop_back();
+            for (int i = 1; i < instruction.operands; ++i)
+            {
+                if (instruction.op == AND)
+                    bits &= stack.back();
+                else
+                    bits |= stack.back();
+                stack.pop_back();
+            }
+            break;
+        default:
+            if (operand.selected)
+            {
+                bits = operand.bits;
+                break;
+            }
+            SelectRows(instruction, snapshot.columns[instruction.column], operand.strings, bits);
+            if (operand.indexed)
+                bits &= operand.candidates;
+            break;
+        }
+        if (instruction.inverted)
+            bits.Invert();
+        stack.push_back(std::move(bits));
+    }
+    return stack.back().ToBitArray();
+}
+
+void FilterProgram::ReadColumn(const QAbstractItemModel* model, const QVector<int>& source_rows, Id role, Column& column)
+{
+    column.values.reserve(source_rows.size());
+    for (auto source_row : source_rows) column.values.push_back(model->data(model->index(source_row, 0), role));
+
+    // типизированная колонка только для значений одного типа, иначе сравнение идет с конвертацией
+    column.type_id = column.values.front().userType();
+    if (std::any_of(column.values.begin(), column.values.end(), [&](const QVariant& value) { return value.userType() != column.type_id; }))
+        column.type_id = QMetaType::UnknownType;
+
+    switch (column.type_id)
+    {
+    case QMetaType::Bool:
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+        column.type = INT_COLUMN;
+        column.ints.reserve(source_rows.size());
+        for (const auto& value : column.values) column.ints.push_back(value.toLongLong());
+        break;
+    case QMetaType::Float:
+    case QMetaType::Double:
+        column.type = DOUBLE_COLUMN;
+        column.doubles.reserve(source_rows.size());
+        for (const auto& value : column.values) column.doubles.push_back(value.toDouble());
+        break;
+    case QMetaType::QString:
+        column.type = STRING_COLUMN;
+        column.strings.reserve(source_rows.size());
+        for (const auto& value : column.values) column.strings.push_back(value.toString());
+        break;
+    default:
+        column.type = VARIANT_COLUMN;
+        break;
+    }
+}
+
+bool FilterProgram::SelectCandidates(const QAbstractItemModel* model, const QVector<int>& source_rows, Id role, const QString& text, Bitmap& candidates)
+{
+    if (source_rows.size() < kMinIndexedRowCount || text.size() < TrigramIndex::kTrigramSize)
+        return false;
+    auto         object_model = qobject_cast<const AbstractObjectModel*>(model);
+    QVector<int> rows;
+    if (!object_model || !object_model->FindTextRows(role, text, rows))
+        return false;
+
+    Bitmap row_bits(model->rowCount());
+    for (auto row : rows) row_bits.SetBit(row);
+    candidates = Bitmap(source_rows.size());
+    for (int i = 0; i < source_rows.size(); ++i)
+        if (source_rows[i] < row_bits.size && row_bits.TestBit(source_rows[i]))
+            candidates.SetBit(i);
+    return true;
+}
+
+bool FilterProgram::SelectValueRows(const QAbstractItemModel* model, const QVector<int>& source_rows, const Instruction& instruction, Bitmap& bits) const
+{
+    if (source_rows.size() < kMinIndexedRowCount)
+        return false;
+
+    // перечисление - объединение битовых карт его значений
+    const auto& index = GetValueIndex(model, column_roles_[instruction.column], instruction.op);
+    Bitmap      rows(static_cast<int>(index.row_values.size()));
+    const auto  add_value = [&](const QString& key) {
+        if (auto value_id = index.value_ids.find(key); value_id != index.value_ids.end())
+            rows |= index.bitmaps[value_id.value()];
+    };
+    if (instruction.op == ENUMERATION)
+        for (auto value : instruction.ints) add_value(QString::number(value));
+    else
+        for (const auto& value : instruction.strings) add_value(value);
+
+    if (IsAllRows(model, source_rows))
+    {
+        bits = std::move(rows);
+        return true;
+    }
+    for (int i = 0; i < source_rows.size(); ++i)
+        if (source_rows[i] < rows.size && rows.TestBit(source_rows[i]))
+            bits.SetBit(i);
+    return true;
+}
+
+void FilterProgram::ReadCachedStrings(const QAbstractItemModel* model, const QVector<int>& source_rows, Id role, bool folded, const Column& column,
+                                      const Bitmap* candidates, std::vector<QString>& strings) const
+{
+    auto& cache = string_caches_[role];
+    strings.clear();
+    strings.reserve(source_rows.size());
+    for (int i = 0; i < source_rows.size(); ++i)
+    {
+        if (candidates && !candidates->TestBit(i))
+        {
+            strings.emplace_back();
+            continue;
+        }
+
+        auto source_row = source_rows[i];
+        if (source_row >= static_cast<int>(cache.states.size()))
+        {
+            cache.states.resize(source_row + 1, StringCache::EMPTY);
+            cache.strings.resize(source_row + 1);
+            cache.folded.resize(source_row + 1);
+        }
+
+        auto& state = cache.states[source_row];
+        if (!(state & StringCache::STRING))
+        {
+            cache.strings[source_row] = column.values.empty() ? model->data(model->index(source_row, 0), role).toString() : column.values[i].toString();
+            state                     = StringCache::STRING;
+        }
+        if (folded && !(state & StringCache::FOLDED))
+        {
+            cache.folded[source_row] = cache.strings[source_row].toCaseFolded();
+            state |= StringCache::FOLDED;
+        }
+        strings.push_back(folded ? cache.folded[source_row] : cache.strings[source_row]);
+    }
+}
+
+void FilterProgram::SelectRows(const Instruction& instruction, const Column& column, const std::vector<QString>& strings, Bitmap& bits)
+{
+    const int  count  = bits.size;
+    const auto string = [&](int i) { return column.type == STRING_COLUMN ? column.strings[i] : column.values[i].toString(); };
+
+    switch (instruction.op)
+    {
+    case COMPARE: {
+        if (!instruction.value.isValid())
+            break;
+        // значения того же типа, что и значение фильтра, DefaultVariantCompare сравнивает без конвертации
+        const bool typed = column.type_id == instruction.value.userType();
+        if (typed && column.type == INT_COLUMN)
+        {
+            const auto value = instruction.value.toLongLong();
+            Select(count, bits, [&](int i) {
+                auto res = column.ints[i] == value ? ComparisonResult::EQUAL : column.ints[i] < value ? ComparisonResult::LESS : ComparisonResult::GREATER;
+                return MatchesComparison(instruction.comparison_operator, res);
+            });
+        }
+        else if (typed && column.type == STRING_COLUMN)
+        {
+            const auto value = instruction.value.toString();
+            Select(count, bits, [&](int i) {
+                auto res = column.strings[i] == value ? ComparisonResult::EQUAL : column.strings[i] < value ? ComparisonResult::LESS : ComparisonResult::GREATER;
+                return MatchesComparison(instruction.comparison_operator, res);
+            });
+        }
+        else
+        {
+            Select(count, bits, [&](int i) {
+                auto res = AbstractFilterComparatorBase::DefaultVariantCompare(column.values[i], instruction.value);
+                if (res == ComparisonResult::UNKNOWN)
+                    throw std::logic_error("Unknown result of comparison");
+                return MatchesComparison(instruction.comparison_operator, res);
+            });
+        }
+        break;
+    }
+    case RANGE:
+        if (column.type == INT_COLUMN)
+            Select(count, bits, [&](int i) { return InRange(instruction.range_check_type, instruction.from, instruction.to, column.ints[i]); });
+        else if (column.type == DOUBLE_COLUMN)
+            Select(count, bits, [&](int i) { return InRange(instruction.range_check_type, instruction.from, instruction.to, column.doubles[i]); });
+        else
+            Select(count, bits, [&](int i) {
+                bool ok    = false;
+                auto value = column.values[i].toDouble(&ok);
+                return ok && InRange(instruction.range_check_type, instruction.from, instruction.to, value);
+            });
+        break;
+    case ENUMERATION:
+        if (column.type_id == QMetaType::Int)
+            Select(count, bits, [&](int i) { return instruction.ints.contains(static_cast<int>(column.ints[i])); });
+        else
+            Select(count, bits, [&](int i) {
+                bool ok    = true;
+                auto value = column.values[i].toInt(&ok);
+                return ok && instruction.ints.contains(value);
+            });
+        break;
+    case STRING_ENUMERATION:
+        Select(count, bits, [&](int i) {
+            auto value = string(i);
+            return !value.isEmpty() && instruction.strings.contains(value);
+        });
+        break;
+    case SUBSTRING:
+        Select(count, bits, [&](int i) { return instruction.matcher.indexIn(strings[i]) >= 0; });
+        break;
+    case REGULAR_EXPRESSION:
+        Select(count, bits, [&](int i) { return instruction.regular_expression.match(strings[i]).hasMatch(); });
+        break;
+    case NOT_NULL_OBJECT:
+        Select(count, bits, [&](int i) { return column.values[i].value<QObject*>() != nullptr; });
+        break;
+    default:
+        break;
+    }
+}
@@ -0,0 +1,322 @@
+#include "model_command_queue.h"
+#include "object_model.h"
+#include <QElapsedTimer>
+#include <QThread>
+#include <QTimerEvent>
+
+using namespace om;
+
+struct ModelCommandQueue::Node
+{
+    enum Type { kAppend, kSet, kReplace, kCommand };
+
+    Type     type = kCommand;
+    int      row  = -1;
+    QObject* item = nullptr;
+    QObject* prev = nullptr;
+    Command  command;
+    Node*    next = nullptr;
+};
+
+ModelCommandQueue::ModelCommandQueue(ObjectRefModel* model, int interval)
+    : model_(model), interval_(interval), owns_items_(qobject_cast<ObjectModel*>(model) != nullptr)
+{
+    if (thread() != model->thread())
+        moveToThread(model->thread());
+    // таймер запускается в потоке модели
+    if (QThread::currentThread() == thread())
+        timer_.start(interval_, this);
+    else
+        QMetaObject::invokeMethod(this, [this] { timer_.start(interval_, this); }, Qt::QueuedConnection);
+}
+
+ModelCommandQueue::~ModelCommandQueue()
+{
+    timer_.stop();
+    if (model_)
+    {
+        Drain();
+        return;
+    }
+    QVector<QObject*> items;
+    for (auto node = head_.exchange(nullptr, std::memory_order_acquire); node;)
+    {
+        auto next = node->next;
+        if (node->type != Node::kCommand)
+            items.push_front(node->item);
+        delete node;
+        node = next;
+    }
+    Discard(items);
+}
+
+void ModelCommandQueue::PushAppend(QObject* item)
+{
+    auto node  = new Node();
+    node->type = Node::kAppend;
+    node->item = item;
+    Push(node);
+}
+
+void ModelCommandQueue::PushSet(int row, QObject* item)
+{
+    auto node  = new Node();
+    node->type = Node::kSet;
+    node->row  = row;
+    node->item = item;
+    Push(node);
+}
+
+void ModelCommandQueue::PushReplace(QObject* prev, QObject* item)
+{
+    auto node  = new Node();
+    node->type = Node::kReplace;
+    node->prev = prev;
+    node->item = item;
+    Push(node);
+}
+
+void ModelCommandQueue::Push(Command command)
+{
+    auto node     = new Node();
+    node->command = std::move(command);
+    Push(node);
+}
+
+void ModelCommandQueue::Push(Node* node)
+{
+    depth_.fetch_add(1, std::memory_order_relaxed);
+    auto head = head_.load(std::memory_order_relaxed);
+    do
+        node->next = head;
+    while (!head_.compare_exchange_weak(head, node, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void ModelCommandQueue::Drain()
+{
+    auto head = head_.exchange(nullptr, std::memory_order_acquire);
+    if (!head)
+        return;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // стек содержит команды в обратном порядке
+    Node* first = nullptr;
+    while (head)
+    {
+        auto next  = head->next;
+        head->next = first;
+        first      = head;
+        head       = next;
+    }
+
+    int commands = 0;
+    operations_  = 0;
+    for (auto node = first; node;)
+    {
+        auto next = node->next;
+        Apply(node);
+        delete node;
+        ++commands;
+        node = next;
+    }
+    FlushPending();
+    depth_.fetch_sub(commands, std::memory_order_relaxed);
+
+    last_drain_commands_   = commands;
+    last_drain_operations_ = operations_;
+    last_drain_time_       = timer.nsecsElapsed();
+    ++drain_count_;
+}
+
+int ModelCommandQueue::GetInterval() const
+{
+    return interval_;
+}
+
+int ModelCommandQueue::GetQueueDepth() const
+{
+    return depth_.load(std::memory_order_relaxed);
+}
+
+qint64 ModelCommandQueue::GetLastDrainTime() const
+{
+    return last_drain_time_;
+}
+
+int ModelCommandQueue::GetLastDrainCommands() const
+{
+    return last_drain_commands_;
+}
+
+int ModelCommandQueue::GetLastDrainOperations() const
+{
+    return last_drain_operations_;
+}
+
+quint64 ModelCommandQueue::GetDrainCount() const
+{
+    return drain_count_;
+}
+
+void ModelCommandQueue::timerEvent(QTimerEvent* event)
+{
+    if (event->timerId() == timer_.timerId())
+        Drain();
+    else
+        QObject::timerEvent(event);
+}
+
+void ModelCommandQueue::Apply(Node* node)
+{
+    if (!model_)
+    {
+        DiscardPending();
+        if (node->type != Node::kCommand)
+            Discard({ node->item });
+        return;
+    }
+
+    switch (node->type)
+    {
+        case Node::kAppend:
+            AppendPending(node->item);
+            break;
+        case Node::kSet:
+            SetPending(node->row, node->item);
+            break;
+        case Node::kReplace:
+            ReplacePending(node->prev, node->item);
+            break;
+        case Node::kCommand:
+            FlushPending();
+            if (node->command)
+            {
+                node->command(model_);
+                ++operations_;
+            }
+            break;
+    }
+}
+
+void ModelCommandQueue::AppendPending(QObject* item)
+{
+    append_rows_[item] = appends_.size();
+    appends_.push_back(item);
+}
+
+void ModelCommandQueue::SetPending(int row, QObject* item)
+{
+    auto count = model_->rowCount();
+    // строка еще не добавленного элемента
+    if (row >= count && row < count + appends_.size())
+    {
+        auto& pending = appends_[row - count];
+        if (pending == item)
+            return;
+        append_rows_.remove(pending);
+        auto replaced      = pending;
+        pending            = item;
+        append_rows_[item] = row - count;
+        Discard({ replaced });
+        return;
+    }
+    if (row < 0 || row >= count)
+    {
+        FlushPending();
+        if (!model_->Set(row, item))
+            Discard({ item });
+        ++operations_;
+        return;
+    }
+
+    auto it = sets_.find(row);
+    if (it == sets_.end())
+    {
+        sets_.insert(row, item);
+    }
+    else if (it.value() != item)
+    {
+        auto replaced = it.value();
+        set_rows_.remove(replaced);
+        it.value()      = item;
+        set_rows_[item] = row;
+        Discard({ replaced });
+        return;
+    }
+    set_rows_[item] = row;
+}
+
+void ModelCommandQueue::ReplacePending(QObject* prev, QObject* item)
+{
+    auto set_row = set_rows_.find(prev);
+    if (set_row != set_rows_.end())
+        return SetPending(set_row.value(), item);
+    auto append_row = append_rows_.find(prev);
+    if (append_row != append_rows_.end())
+        return SetPending(model_->rowCount() + append_row.value(), item);
+    auto row = model_->IndexOf(prev);
+    if (row < 0)
+        AppendPending(item);
+    else
+        SetPending(row, item);
+}
+
+void ModelCommandQueue::FlushPending()
+{
+    if (!model_)
+        return DiscardPending();
+    auto sets    = std::move(sets_);
+    auto appends = std::move(appends_);
+    sets_.clear();
+    set_rows_.clear();
+    appends_.clear();
+    append_rows_.clear();
+
+    QVector<QObject*> rejected;
+    for (auto it = sets.begin(); it != sets.end(); ++it)
+    {
+        if (!model_->Set(it.key(), it.value()))
+            rejected.push_back(it.value());
+        ++operations_;
+    }
+    if (!appends.isEmpty())
+    {
+        auto count = model_->rowCount();
+        model_->AppendVector(appends);
+        ++operations_;
+        // уникальный индекс отклоняет всю выборку, элементы добавляются по одному, чтобы отклонить только повторяющиеся
+        if (model_->rowCount() == count)
+        {
+            for (auto item : appends)
+            {
+                if (!model_->Append(item))
+                    rejected.push_back(item);
+                ++operations_;
+            }
+        }
+    }
+    Discard(rejected);
+}
+
+void ModelCommandQueue::DiscardPending()
+{
+    auto items = appends_ + sets_.values().toVector();
+    appends_.clear();
+    append_rows_.clear();
+    sets_.clear();
+    set_rows_.clear();
+    Discard(items);
+}
+
+void ModelCommandQueue::Discard(QVector<QObject*> items)
+{
+    items.removeAll(nullptr);
+    if (items.isEmpty())
+        return;
+    if (owns_items_)
+        qDeleteAll(items);
+    else
+        emit itemsDiscarded(items);
+}
@@ -97,9 +97,16 @@ void ObjectMetaData::ParseMetaObjectProperties(const QMetaObject* meta_object, i
 
         if (auto signal_index = property.notifySignalIndex(); signal_index != -1)
         {
-            Notifier* notifier = find_notifier(signal_index);
-            if (!notifier)
-                notifier = create_notifier(signal_index, property_role_info);
+            if (auto notifier = find_notifier(signal_index))
+            {
+                // properties with shared notify signal
+                property_role_info->notifier = notifier;
+                notifier->roles.push_back(property_role_info);
+            }
+            else
+            {
+                create_notifier(signal_index, property_role_info);
+            }
         }
 
         if (property_meta_object)
@@ -137,9 +144,37 @@ bool ObjectMetaData::RoleInfo::IsObjectName() const
     return name.endsWith("objectName");
 }
 
+QObject* ObjectMetaData::RoleInfo::GetObjectFromRoot(QObject* root) const
+{
+    if (!path_compiled)
+        return GetRoleObject(root, this);
+
+    // reading parent objects directly into the pointer without QVariant
+    auto object = root;
+    for (auto property_index : path)
+    {
+        if (!object)
+            return nullptr;
+        QObject* child  = nullptr;
+        void*    data[] = { &child };
+        QMetaObject::metacall(object, QMetaObject::ReadProperty, property_index, data);
+        object = child;
+    }
+    return object;
+}
+
 QVariant ObjectMetaData::RoleInfo::ReadFromRoot(QObject* root) const
 {
-    return ReadFromItem(GetRoleObject(root, this));
+    return ReadFromItem(GetObjectFromRoot(root));
+}
+
+bool ObjectMetaData::RoleInfo::ReadFromRoot(QObject* root, void* data) const
+{
+    auto item = GetObjectFromRoot(root);
+    if (!item || IsSignal())
+        return false;
+    QMetaObject::metacall(item, QMetaObject::ReadProperty, property.propertyIndex(), &data);
+    return true;
 }
 
 QVariant ObjectMetaData::RoleInfo::ReadFromItem(QObject* item) const
@@ -157,7 +192,7 @@ QVariant ObjectMetaData::RoleInfo::ReadFromItem(QObject* item) const
 
 bool ObjectMetaData::RoleInfo::WriteToRoot(QObject* root, const QVariant& val) const
 {
-    return WriteToItem(GetRoleObject(root, this), val);
+    return WriteToItem(GetObjectFromRoot(root), val);
 }
 
 bool ObjectMetaData::RoleInfo::WriteToItem(QObject* item, const QVariant& val) const
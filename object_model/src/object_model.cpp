@@ -2,17 +2,30 @@
 #include "settings.h"
 #include "signal_timer.h"
 #include <QtQml>
+#include <algorithm>
 
 using namespace om;
 
+namespace
+{
+// with more moved items SyncItems emits one layout change
+constexpr int kMaxSyncMoves = 64;
+}  // namespace
+
 ObjectRefModel::ObjectRefModel(QObject* parent /*= nullptr*/) : AbstractObjectModel(parent)
-{}
+{
+    connect(this, &ObjectRefModel::initialized, this, &ObjectRefModel::UpdateIndexes);
+}
 
 ObjectRefModel::ObjectRefModel(const QMetaObject& meta_object, QObject* parent /*= nullptr*/) : AbstractObjectModel(meta_object, parent)
-{}
+{
+    connect(this, &ObjectRefModel::initialized, this, &ObjectRefModel::UpdateIndexes);
+}
 
 ObjectRefModel::ObjectRefModel(const QMetaObject* meta_object, QObject* parent /*= nullptr*/) : AbstractObjectModel(meta_object, parent)
-{}
+{
+    connect(this, &ObjectRefModel::initialized, this, &ObjectRefModel::UpdateIndexes);
+}
 
 ObjectRefModel::~ObjectRefModel()
 {
@@ -34,7 +47,7 @@ QObject* ObjectRefModel::GetItem(int row) const
 
 bool om::ObjectRefModel::SetItem(int row, QObject* val)
 {
-    if (row < 0 || row >= items_.size() || !CanAddItem(val))
+    if (row < 0 || row >= items_.size() || !CanAddItem(val) || !HasUniqueValues({ val }, true, items_[row]))
         return false;
     // disconnecting old item
     UninstallItem(row);
@@ -59,6 +72,31 @@ bool ObjectRefModel::CanAddItems(const QVector<QObject*>& items) const
     return true;
 }
 
+bool ObjectRefModel::HasUniqueValues(const QVector<QObject*>& items, bool check_model_items, QObject* replaced) const
+{
+    for (const auto& index : indexes_)
+    {
+        if (!index.IsUnique() || index.GetRoleId() == kInvalidId)
+            continue;
+
+        RoleIndex added(index.GetRoleId());
+        for (auto item : items)
+        {
+            if (!item)
+                continue;
+            auto val       = GetItemsProperty(item, index.GetRoleId());
+            auto duplicate = [&](QObject* other) { return other != item && other != replaced && GetItemsProperty(other, index.GetRoleId()) == val; };
+            if (check_model_items)
+                if (auto found = index.Find(val); std::any_of(found.begin(), found.end(), duplicate))
+                    return false;
+            if (auto found = added.Find(val); std::any_of(found.begin(), found.end(), duplicate))
+                return false;
+            added.Insert(item, val);
+        }
+    }
+    return true;
+}
+
 void ObjectRefModel::InstallItem(int row)
 {
     try
@@ -71,6 +109,27 @@ void ObjectRefModel::InstallItem(int row)
 //        LOG(e.what());
         throw;
     }
+
+    InvalidateItemRows(row);
+    for (auto& index : indexes_)
+        if (index.GetRoleId() != kInvalidId && items_[row])
+            index.Insert(items_[row], GetItemsProperty(items_[row], index.GetRoleId()));
+    for (auto& index : text_indexes_)
+        if (index.GetRoleId() != kInvalidId && items_[row])
+            index.Insert(items_[row], GetItemsProperty(items_[row], index.GetRoleId()).toString());
+}
+
+void ObjectRefModel::UninstallItem(int row, bool taken)
+{
+    if (auto item = items_[row])
+    {
+        for (auto& index : indexes_) index.Remove(item);
+        for (auto& index : text_indexes_) index.Remove(item);
+        item_rows_.remove(item);
+    }
+    InvalidateItemRows(row);
+
+    AbstractObjectModel::UninstallItem(row, taken);
 }
 
 bool ObjectRefModel::removeRows(int row, int count, const QModelIndex& /*= QModelIndex()*/)
@@ -89,12 +148,18 @@ bool ObjectRefModel::removeRows(int row, int count, const QModelIndex& /*= QMode
 
 bool ObjectRefModel::moveRows(const QModelIndex& source_parent, int source_row, int count, const QModelIndex& destination_parent, int destination_row)
 {
-    if (!(source_row >= 0 && source_row + count <= rowCount() && destination_row >= 0 && destination_row + count <= rowCount() && qAbs(source_row - destination_row) >= count))
+    if (!(count > 0 && source_row >= 0 && source_row + count <= rowCount() && destination_row >= 0 && destination_row + count <= rowCount() && source_row != destination_row))
         return false;
 
-    if (beginMoveRows(source_parent, source_row, source_row + count - 1, destination_parent, destination_row + (source_row < destination_row)))
+    // destination_row is the row of the first moved item after the move, beginMoveRows expects the row before the move
+    if (beginMoveRows(source_parent, source_row, source_row + count - 1, destination_parent, source_row < destination_row ? destination_row + count : destination_row))
     {
-        for (int i = count - 1; i >= 0; --i) items_.move(source_row + i, destination_row);
+        auto begin = items_.begin();
+        if (source_row < destination_row)
+            std::rotate(begin + source_row, begin + source_row + count, begin + destination_row + count);
+        else
+            std::rotate(begin + destination_row, begin + source_row, begin + source_row + count);
+        InvalidateItemRows(qMin(source_row, destination_row));
         endMoveRows();
     }
     return true;
@@ -118,11 +183,16 @@ QObject* ObjectRefModel::Last() const
 // Search
 int ObjectRefModel::IndexOf(QObject* item) const
 {
-    return item ? items_.indexOf(item) : -1;
+    if (!item)
+        return -1;
+    return indexes_.isEmpty() ? items_.indexOf(item) : GetItemRow(item);
 }
 
 int ObjectRefModel::IndexOf(const QString& object_name) const
 {
+    if (QVector<int> rows; FindIndexedRows("objectName", object_name, rows))
+        return rows.isEmpty() ? -1 : rows.first();
+
     for (int i = 0; i < items_.size(); ++i)
         if (items_[i]->objectName() == object_name)
             return i;
@@ -131,6 +201,9 @@ int ObjectRefModel::IndexOf(const QString& object_name) const
 
 int ObjectRefModel::IndexOf(const QByteArray& property_name, const QVariant& val) const
 {
+    if (QVector<int> rows; FindIndexedRows(property_name, val, rows))
+        return rows.isEmpty() ? -1 : rows.first();
+
     auto role_id = GetRoleId(property_name);
     if (role_id == kInvalidId)
         return -1;
@@ -145,6 +218,9 @@ int ObjectRefModel::IndexOf(const QVariantMap& props) const
 {
     if (props.isEmpty())
         return -1;
+    if (QVector<int> rows; FindIndexedRows(props, rows))
+        return rows.isEmpty() ? -1 : rows.first();
+
     for (int i = 0; i < items_.size(); ++i)
         if (HasPropertiesMatch(items_[i], props))
             return i;
@@ -174,6 +250,8 @@ bool ObjectRefModel::Contains(const QVariantMap& props) const
 QVector<int> ObjectRefModel::IndexesOf(const QByteArray& property_name, const QVariant& val) const
 {
     QVector<int> res;
+    if (FindIndexedRows(property_name, val, res))
+        return res;
 
     auto role_id = GetRoleId(property_name);
     if (role_id == kInvalidId)
@@ -188,7 +266,7 @@ QVector<int> ObjectRefModel::IndexesOf(const QByteArray& property_name, const QV
 QVector<int> ObjectRefModel::IndexesOf(const QVariantMap& props) const
 {
     QVector<int> res;
-    if (props.isEmpty())
+    if (props.isEmpty() || FindIndexedRows(props, res))
         return res;
     for (int i = 0; i < items_.size(); ++i)
         if (HasPropertiesMatch(items_[i], props))
@@ -198,6 +276,9 @@ QVector<int> ObjectRefModel::IndexesOf(const QVariantMap& props) const
 
 QObject* ObjectRefModel::FindFirst(const QByteArray& property_name, const QVariant& val) const
 {
+    if (QVector<int> rows; FindIndexedRows(property_name, val, rows))
+        return rows.isEmpty() ? nullptr : items_[rows.first()];
+
     for (auto item : items_)
         if (GetItemsProperty(item, property_name) == val)
             return item;
@@ -208,6 +289,9 @@ QObject* ObjectRefModel::FindFirst(const QVariantMap& props) const
 {
     if (props.isEmpty())
         return nullptr;
+    if (QVector<int> rows; FindIndexedRows(props, rows))
+        return rows.isEmpty() ? nullptr : items_[rows.first()];
+
     for (auto i : items_)
         if (HasPropertiesMatch(i, props))
             return i;
@@ -216,6 +300,9 @@ QObject* ObjectRefModel::FindFirst(const QVariantMap& props) const
 
 QObject* ObjectRefModel::Find(const QString& object_name) const
 {
+    if (QVector<int> rows; FindIndexedRows("objectName", object_name, rows))
+        return rows.isEmpty() ? nullptr : items_[rows.first()];
+
     for (auto i : items_)
         if (i->objectName() == object_name)
             return i;
@@ -228,6 +315,14 @@ QVector<QObject*> ObjectRefModel::FindObjects(const QStringList& object_names) c
     if (object_names.isEmpty())
         return res;
 
+    if (HasIndex("objectName"))
+    {
+        for (const auto& object_name : object_names)
+            if (auto item = Find(object_name))
+                res.push_back(item);
+        return res;
+    }
+
     for (auto object_name : object_names)
         for (auto i : items_)
             if (i->objectName() == object_name)
@@ -241,6 +336,12 @@ QVector<QObject*> ObjectRefModel::FindObjects(const QStringList& object_names) c
 QVector<QObject*> ObjectRefModel::FindObjects(const QString& object_name) const
 {
     QVector<QObject*> res;
+    if (QVector<int> rows; FindIndexedRows("objectName", object_name, rows))
+    {
+        for (auto row : rows) res.push_back(items_[row]);
+        return res;
+    }
+
     for (auto i : items_)
         if (i->objectName() == object_name)
             res.push_back(i);
@@ -250,6 +351,12 @@ QVector<QObject*> ObjectRefModel::FindObjects(const QString& object_name) const
 QVector<QObject*> ObjectRefModel::Find(const QByteArray& property_name, const QVariant& val) const
 {
     QVector<QObject*> res;
+    if (QVector<int> rows; FindIndexedRows(property_name, val, rows))
+    {
+        for (auto row : rows) res.push_back(items_[row]);
+        return res;
+    }
+
     for (auto item : items_)
         if (GetItemsProperty(item, property_name) == val)
             res.push_back(item);
@@ -261,12 +368,190 @@ QVector<QObject*> ObjectRefModel::Find(const QVariantMap& props) const
     QVector<QObject*> res;
     if (props.isEmpty())
         return res;
+    if (QVector<int> rows; FindIndexedRows(props, rows))
+    {
+        for (auto row : rows) res.push_back(items_[row]);
+        return res;
+    }
+
     for (auto i : items_)
         if (HasPropertiesMatch(i, props))
             res.push_back(i);
     return res;
 }
 
+// Indexes
+bool ObjectRefModel::CreateIndex(const QByteArray& role_name, bool unique /*= false*/)
+{
+    if (IsInitialized() && GetRoleId(role_name) == kInvalidId)
+        return false;
+    indexes_.insert(role_name, RoleIndex(kInvalidId, unique));
+    UpdateIndexes();
+    return true;
+}
+
+void ObjectRefModel::RemoveIndex(const QByteArray& role_name)
+{
+    if (!indexes_.remove(role_name))
+        return;
+    UpdateIndexes();
+}
+
+bool ObjectRefModel::HasIndex(const QByteArray& role_name) const
+{
+    return indexes_.contains(role_name);
+}
+
+bool ObjectRefModel::CreateTextIndex(const QByteArray& role_name)
+{
+    if (IsInitialized() && GetRoleId(role_name) == kInvalidId)
+        return false;
+    text_indexes_.insert(role_name, TrigramIndex());
+    UpdateIndexes();
+    return true;
+}
+
+void ObjectRefModel::RemoveTextIndex(const QByteArray& role_name)
+{
+    if (!text_indexes_.remove(role_name))
+        return;
+    UpdateIndexes();
+}
+
+bool ObjectRefModel::HasTextIndex(const QByteArray& role_name) const
+{
+    return text_indexes_.contains(role_name);
+}
+
+QVariantMap ObjectRefModel::GetTextIndexStatistics(const QByteArray& role_name) const
+{
+    auto index = text_indexes_.find(role_name);
+    if (index == text_indexes_.end())
+        return QVariantMap();
+    return { { "items", index->GetSize() },
+             { "trigrams", index->GetTrigramCount() },
+             { "buildTime", index->GetBuildTime() },
+             { "memoryUsage", QVariant::fromValue<qulonglong>(index->GetMemoryUsage()) } };
+}
+
+bool ObjectRefModel::FindTextRows(int role, const QString& text, QVector<int>& rows) const
+{
+    auto index = std::find_if(text_indexes_.begin(), text_indexes_.end(), [&](const TrigramIndex& index) { return index.GetRoleId() == role; });
+    if (role == kInvalidId || index == text_indexes_.end())
+        return false;
+
+    QVector<QObject*> items;
+    if (!index->Find(text, items))
+        return false;
+    for (auto item : items)
+        if (auto row = GetItemRow(item); row >= 0)
+            rows.push_back(row);
+    std::sort(rows.begin(), rows.end());
+    return true;
+}
+
+void ObjectRefModel::UpdateIndexes()
+{
+    Ids roles;
+    for (auto index = indexes_.begin(); index != indexes_.end(); ++index)
+    {
+        auto role_id  = IsInitialized() ? GetRoleId(index.key()) : kInvalidId;
+        index.value() = RoleIndex(role_id, index->IsUnique());
+        if (role_id == kInvalidId)
+            continue;
+
+        roles.insert(role_id);
+        for (auto item : items_)
+            if (item)
+                index->Insert(item, GetItemsProperty(item, role_id));
+    }
+    for (auto index = text_indexes_.begin(); index != text_indexes_.end(); ++index)
+    {
+        auto role_id  = IsInitialized() ? GetRoleId(index.key()) : kInvalidId;
+        index.value() = TrigramIndex(role_id);
+        if (role_id == kInvalidId)
+            continue;
+
+        roles.insert(role_id);
+        for (auto item : items_)
+            if (item)
+                index->Insert(item, GetItemsProperty(item, role_id).toString());
+    }
+
+    if (indexes_.isEmpty() && text_indexes_.isEmpty())
+        item_rows_.clear();
+    InvalidateItemRows(0);
+    SetObservedRoles(roles);
+}
+
+void ObjectRefModel::ItemRolesChanged(QObject* item, const Ids& roles)
+{
+    if (!item)
+        return;
+    for (auto& index : indexes_)
+    {
+        if (!roles.contains(index.GetRoleId()))
+            continue;
+        auto val = GetItemsProperty(item, index.GetRoleId());
+        index.Insert(item, val);
+        if (index.IsUnique() && !HasUniqueValues({ item }))
+            qDebug() << "Unique index value" << val << "duplicate";
+    }
+    for (auto& index : text_indexes_)
+        if (roles.contains(index.GetRoleId()))
+            index.Insert(item, GetItemsProperty(item, index.GetRoleId()).toString());
+}
+
+bool ObjectRefModel::FindIndexedRows(const QByteArray& role_name, const QVariant& val, QVector<int>& rows) const
+{
+    auto index = indexes_.find(role_name);
+    if (index == indexes_.end() || index->GetRoleId() == kInvalidId)
+        return false;
+
+    // index returns candidates, that may be equal to the value
+    for (auto item : index->Find(val))
+        if (GetItemsProperty(item, index->GetRoleId()) == val)
+            if (auto row = GetItemRow(item); row >= 0)
+                rows.push_back(row);
+    std::sort(rows.begin(), rows.end());
+    return true;
+}
+
+bool ObjectRefModel::FindIndexedRows(const QVariantMap& props, QVector<int>& rows) const
+{
+    for (auto p = props.begin(); p != props.end(); ++p)
+    {
+        auto index = indexes_.find(p.key().toUtf8());
+        if (index == indexes_.end() || index->GetRoleId() == kInvalidId)
+            continue;
+
+        for (auto item : index->Find(p.value()))
+            if (HasPropertiesMatch(item, props))
+                if (auto row = GetItemRow(item); row >= 0)
+                    rows.push_back(row);
+        std::sort(rows.begin(), rows.end());
+        return true;
+    }
+    return false;
+}
+
+int ObjectRefModel::GetItemRow(QObject* item) const
+{
+    if (item_rows_valid_ < items_.size())
+    {
+        for (int row = item_rows_valid_; row < items_.size(); ++row) item_rows_.insert(items_[row], row);
+        item_rows_valid_ = items_.size();
+    }
+
+    auto row = item_rows_.value(item, -1);
+    return row >= 0 && row < items_.size() && items_[row] == item ? row : -1;
+}
+
+void ObjectRefModel::InvalidateItemRows(int row)
+{
+    item_rows_valid_ = qMin(item_rows_valid_, row);
+}
+
 // Take
 QObject* ObjectRefModel::Take(int row)
 {
@@ -304,7 +589,7 @@ QObject* ObjectRefModel::Append(const QVariantMap& props)
 
 void ObjectRefModel::AppendVector(const QVector<QObject*>& items)
 {
-    if (items.isEmpty() || !CanAddItems(items))
+    if (items.isEmpty() || !CanAddItems(items) || !HasUniqueValues(items))
         return;
     auto row = items_.size();
     beginInsertRows(QModelIndex(), row, row + items.size() - 1);
@@ -322,7 +607,7 @@ void ObjectRefModel::AppendModel(ObjectRefModel* m)
 
 QObject* ObjectRefModel::Insert(int row, QObject* item)
 {
-    if (row < 0 || row > items_.size() || !CanAddItem(item))
+    if (row < 0 || row > items_.size() || !CanAddItem(item) || !HasUniqueValues({ item }))
         return nullptr;
     beginInsertRows(QModelIndex(), row, row);
     if (row == items_.size())
@@ -362,49 +647,170 @@ void ObjectRefModel::Remove(const QString& object_name)
 
 void ObjectRefModel::RemoveAll(const QByteArray& property_name, const QVariant& val)
 {
-    for (int i = 0; i < items_.size();)
-    {
-        if (GetItemsProperty(items_[i], property_name) == val)
-            Remove(i);
-        else
-            ++i;
-    }
+    RemoveSortedRows(IndexesOf(property_name, val));
 }
 
 void ObjectRefModel::RemoveAll(const QVariantMap& props)
 {
-    for (int i = 0; i < items_.size();)
-    {
-        if (HasPropertiesMatch(items_[i], props))
-            Remove(i);
-        else
-            ++i;
-    }
+    RemoveSortedRows(IndexesOf(props));
 }
 
 void ObjectRefModel::RemoveAllIf(const QByteArray& property_name, const QVariant& val, const std::function<bool(QObject*)>& func)
 {
     if (!func)
         return;
-    for (int i = 0; i < items_.size();)
-    {
-        if (GetItemsProperty(items_[i], property_name) == val && func(items_[i]))
-            Remove(i);
-        else
-            ++i;
-    }
+    auto rows = IndexesOf(property_name, val);
+    rows.erase(std::remove_if(rows.begin(), rows.end(), [&](int row) { return !func(items_[row]); }), rows.end());
+    RemoveSortedRows(rows);
 }
 
 void ObjectRefModel::RemoveAllIf(const QVariantMap& props, const std::function<bool(QObject*)>& func)
 {
     if (!func)
         return;
-    for (int i = 0; i < items_.size();)
+    auto rows = IndexesOf(props);
+    rows.erase(std::remove_if(rows.begin(), rows.end(), [&](int row) { return !func(items_[row]); }), rows.end());
+    RemoveSortedRows(rows);
+}
+
+void ObjectRefModel::RemoveSortedRows(const QVector<int>& rows)
+{
+    if (rows.isEmpty())
+        return;
+
+    // contiguous ranges of the rows: first row, count
+    QVector<QPair<int, int>> ranges;
+    for (auto row : rows)
+    {
+        if (!ranges.isEmpty() && ranges.last().first + ranges.last().second == row)
+            ++ranges.last().second;
+        else
+            ranges.push_back({ row, 1 });
+    }
+
+    if (ranges.size() == 1 || rows.size() < remove_reset_ratio_ * items_.size())
+    {
+        // from the last range, so rows of the other ranges won't change
+        for (auto range = ranges.crbegin(); range != ranges.crend(); ++range) removeRows(range->first, range->second);
+        return;
+    }
+
+    beginResetModel();
+    // disconnecting old items
+    for (const auto& range : ranges) UninstallItems(range.first, range.second);
+    // compacting items in one pass
+    int write_row = rows.first();
+    for (int read_row = write_row, range = 0; read_row < items_.size(); ++read_row)
+    {
+        if (range < ranges.size() && read_row >= ranges[range].first)
+        {
+            read_row += ranges[range++].second - 1;
+            continue;
+        }
+        items_[write_row++] = items_[read_row];
+    }
+    items_.resize(write_row);
+    ItemsCompacted(ranges);
+    endResetModel();
+}
+
+void ObjectRefModel::SyncItems(const QVector<int>& new_to_old, const std::function<QObject*(int)>& create_item)
+{
+    QVector<int> old_to_new(items_.size(), -1);
+    for (int new_row = 0; new_row < new_to_old.size(); ++new_row)
+        if (new_to_old[new_row] >= 0 && new_to_old[new_row] < items_.size())
+            old_to_new[new_to_old[new_row]] = new_row;
+
+    QVector<int> removed_rows;
+    QVector<int> new_rows;  // of the kept items in the current order
+    for (int row = 0; row < old_to_new.size(); ++row)
+        if (old_to_new[row] < 0)
+            removed_rows.push_back(row);
+        else
+            new_rows.push_back(old_to_new[row]);
+    RemoveSortedRows(removed_rows);
+
+    // longest increasing subsequence of the new rows stays in place
+    QVector<int> tails;  // index in new_rows of the last element of the subsequence with length = index + 1
+    QVector<int> prev(new_rows.size(), -1);
+    for (int i = 0; i < new_rows.size(); ++i)
     {
-        if (HasPropertiesMatch(items_[i], props) && func(items_[i]))
-            Remove(i);
+        auto length = static_cast<int>(std::lower_bound(tails.begin(), tails.end(), new_rows[i], [&](int tail, int val) { return new_rows[tail] < val; }) - tails.begin());
+        if (length > 0)
+            prev[i] = tails[length - 1];
+        if (length == tails.size())
+            tails.push_back(i);
         else
-            ++i;
+            tails[length] = i;
+    }
+    QVector<bool> moved(new_to_old.size(), true);
+    for (int i = tails.isEmpty() ? -1 : tails.last(); i >= 0; i = prev[i]) moved[new_rows[i]] = false;
+
+    if (new_rows.size() - tails.size() > kMaxSyncMoves)
+    {
+        // one layout change instead of a rowsMoved per item
+        emit layoutAboutToBeChanged();
+        QVector<int> rows(new_to_old.size(), -1);  // current row of the kept item by its new row
+        for (int row = 0; row < new_rows.size(); ++row) rows[new_rows[row]] = row;
+        QVector<int>      sorted_rows(items_.size());  // row after the layout change by the current row
+        QVector<QObject*> items;
+        items.reserve(items_.size());
+        for (auto row : rows)
+        {
+            if (row < 0)
+                continue;
+            sorted_rows[row] = items.size();
+            items.push_back(items_[row]);
+        }
+        auto from = persistentIndexList();
+        auto to   = from;
+        for (auto& index : to) index = this->index(sorted_rows[index.row()], index.column());
+        changePersistentIndexList(from, to);
+        std::swap(items_, items);
+        InvalidateItemRows(0);
+        emit layoutChanged();
+    }
+    else
+    {
+        QVector<int> rows(new_to_old.size(), -1);  // current row of the kept item by its new row
+        for (int row = 0; row < new_rows.size(); ++row) rows[new_rows[row]] = row;
+        // every moved item is placed after the item with the previous new row, so sorted items stay sorted
+        int prev_row = -1;
+        for (int new_row = 0; new_row < rows.size(); ++new_row)
+        {
+            auto from = rows[new_row];
+            if (from < 0)
+                continue;
+            auto to = from < prev_row ? prev_row : prev_row + 1;
+            if (moved[new_row] && from != to)
+            {
+                Move(from, to);
+                new_rows.move(from, to);
+                for (int row = qMin(from, to); row <= qMax(from, to); ++row) rows[new_rows[row]] = row;
+            }
+            prev_row = rows[new_row];
+        }
+    }
+
+    // created items are inserted with one signal per contiguous range
+    for (int first = 0; first < new_to_old.size(); ++first)
+    {
+        if (new_to_old[first] >= 0)
+            continue;
+        auto last = first;
+        while (last + 1 < new_to_old.size() && new_to_old[last + 1] < 0) ++last;
+        QVector<QObject*> items;
+        items.reserve(last - first + 1);
+        for (int row = first; row <= last; ++row) items.push_back(create_item(row));
+        if (CanAddItems(items))
+        {
+            beginInsertRows(QModelIndex(), first, last);
+            items_.insert(first, items.size(), nullptr);
+            std::copy(items.cbegin(), items.cend(), items_.begin() + first);
+            InstallItems(first, items.size());
+            endInsertRows();
+        }
+        first = last;
     }
 }
 
@@ -422,7 +828,7 @@ void ObjectRefModel::Clear()
 
 void ObjectRefModel::SetItems(QVector<QObject*> items)
 {
-    if (!CanAddItems(items))
+    if (!CanAddItems(items) || !HasUniqueValues(items, false))
         return;
 
     beginResetModel();
@@ -436,12 +842,12 @@ void ObjectRefModel::SetItems(QVector<QObject*> items)
     endResetModel();
 }
 
-void ObjectRefModel::Move(int from, int to, int)
+void ObjectRefModel::Move(int from, int to, int count)
 {
-    if (from == to)
+    if (from == to || count < 1)
         return;
 
-    moveRow(QModelIndex(), from, QModelIndex(), to);
+    moveRows(QModelIndex(), from, count, QModelIndex(), to);
 }
 
 void ObjectRefModel::ItemAboutToBeDeleted(QObject* item)
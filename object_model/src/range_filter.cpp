@@ -23,7 +23,7 @@ void RangeFilter::SetFrom(double from)
     else
         from_ = from;
     emit fromChanged();
-    EmitFilterChanged();
+    EmitFilterChanged(FilterChange::RANGE_MOVED);
 }
 
 double RangeFilter::GetTo() const
@@ -35,14 +35,14 @@ void RangeFilter::SetTo(double to)
 {
     if (to < from_)
     {
-        from_ = to;
         to_   = from_;
+        from_ = to;
         emit fromChanged();
     }
     else
         to_ = to;
     emit toChanged();
-    EmitFilterChanged();
+    EmitFilterChanged(FilterChange::RANGE_MOVED);
 }
 
 RangeFilter::RangeCheckType RangeFilter::GetRangeCheckType() const
@@ -2,6 +2,24 @@
 
 using namespace om;
 
+namespace
+{
+// Строки, содержащие новую подстроку, содержат и старую
+AbstractFilter::FilterChange GetSubstringChange(const QString& old_substring, const QString& new_substring, Qt::CaseSensitivity case_sensitivity)
+{
+    if (new_substring.contains(old_substring, case_sensitivity))
+        return AbstractFilter::FilterChange::NARROWED;
+    if (old_substring.contains(new_substring, case_sensitivity))
+        return AbstractFilter::FilterChange::WIDENED;
+    return AbstractFilter::FilterChange::ANY;
+}
+
+bool IsLiteral(const QString& pattern)
+{
+    return QRegularExpression::escape(pattern) == pattern;
+}
+}  // namespace
+
 SubstringFilter::SubstringFilter(QObject* parent /*= Q_NULLPTR*/) : AbstractRoleFilter(parent)
 {}
 
@@ -14,9 +32,10 @@ void SubstringFilter::SetSubstring(const QString& val)
 {
     if (substring_ == val)
         return;
-    substring_ = val;
+    auto change = GetSubstringChange(substring_, val, case_sensitivity_);
+    substring_  = val;
     emit substringChanged();
-    EmitFilterChanged();
+    EmitFilterChanged(change);
 }
 
 bool SubstringFilter::IsCaseInsensitive() const
@@ -30,7 +49,7 @@ void SubstringFilter::SetCaseInsensitive(bool val)
         return;
     case_sensitivity_ = val ? Qt::CaseInsensitive : Qt::CaseSensitive;
     emit caseSensitivityChanged();
-    EmitFilterChanged();
+    EmitFilterChanged(val ? FilterChange::WIDENED : FilterChange::NARROWED);
 }
 
 bool SubstringFilter::Accepts(const QModelIndex& index, const std::pair<QByteArray, int>& role) const
@@ -52,10 +71,11 @@ void RegularExpressionFilter::SetPattern(const QString& val)
 {
     if (regular_expression_.pattern() == val)
         return;
+    auto change = GetPatternChange(regular_expression_.pattern(), val);
     regular_expression_.setPattern(val);
     regular_expression_.optimize();
     emit regularExpressionChanged();
-    EmitFilterChanged();
+    EmitFilterChanged(change);
 }
 
 QRegularExpression::PatternOptions RegularExpressionFilter::GetPatternOptions() const
@@ -83,7 +103,10 @@ void RegularExpressionFilter::SetCaseInsensitive(bool val)
         return;
     regular_expression_.setPatternOptions(regular_expression_.patternOptions().setFlag(QRegularExpression::CaseInsensitiveOption, val));
     emit regularExpressionChanged();
-    EmitFilterChanged();
+    if (IsLiteral(regular_expression_.pattern()))
+        EmitFilterChanged(val ? FilterChange::WIDENED : FilterChange::NARROWED);
+    else
+        EmitFilterChanged();
 }
 
 QRegularExpression RegularExpressionFilter::GetRegularExpression() const
@@ -95,10 +118,19 @@ void RegularExpressionFilter::SetRegularExpression(const QRegularExpression& val
 {
     if (regular_expression_ == val)
         return;
+    auto change         = regular_expression_.patternOptions() == val.patternOptions() ? GetPatternChange(regular_expression_.pattern(), val.pattern()) : FilterChange::ANY;
     regular_expression_ = val;
     regular_expression_.optimize();
     emit regularExpressionChanged();
-    EmitFilterChanged();
+    EmitFilterChanged(change);
+}
+
+AbstractFilter::FilterChange RegularExpressionFilter::GetPatternChange(const QString& old_pattern, const QString& new_pattern) const
+{
+    // только литеральные шаблоны ищутся как подстроки, изменение остальных может принять любые строки
+    if (!regular_expression_.isValid() || !IsLiteral(old_pattern) || !IsLiteral(new_pattern))
+        return FilterChange::ANY;
+    return GetSubstringChange(old_pattern, new_pattern, IsCaseInsensitive() ? Qt::CaseInsensitive : Qt::CaseSensitive);
 }
 
 bool RegularExpressionFilter::Accepts(const QModelIndex& index, const std::pair<QByteArray, int>& role) const
@@ -0,0 +1,235 @@
+#include "role_index.h"
+#include <QDataStream>
+
+using namespace om;
+
+namespace
+{
+uint GetNumberKey(double val)
+{
+    // -0.0 == 0.0
+    return qHash(val == 0 ? 0.0 : val);
+}
+
+uint GetStringKey(const QString& val)
+{
+    if (val == QLatin1String("true"))
+        return GetNumberKey(1);
+    if (val == QLatin1String("false"))
+        return GetNumberKey(0);
+    bool ok     = false;
+    auto number = val.toDouble(&ok);
+    return ok ? GetNumberKey(number) : qHash(val);
+}
+
+// Типы, которые QVariant сравнивает как числа
+bool IsNumber(int type)
+{
+    switch (type)
+    {
+        case QMetaType::Bool:
+        case QMetaType::Int:
+        case QMetaType::UInt:
+        case QMetaType::Long:
+        case QMetaType::ULong:
+        case QMetaType::LongLong:
+        case QMetaType::ULongLong:
+        case QMetaType::Short:
+        case QMetaType::UShort:
+        case QMetaType::Char:
+        case QMetaType::SChar:
+        case QMetaType::UChar:
+        case QMetaType::Float:
+        case QMetaType::Double:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool IsFloatingPoint(int type)
+{
+    return type == QMetaType::Float || type == QMetaType::Double;
+}
+}  // namespace
+
+void RoleIndex::Insert(QObject* item, const QVariant& val)
+{
+    if (!item)
+        return;
+
+    Key  key{ GetKey(val), val.userType() };
+    auto old_it = keys_.find(item);
+    if (old_it != keys_.end())
+    {
+        if (old_it->hash == key.hash && old_it->type == key.type)
+            return;
+        Remove(item);
+    }
+
+    items_[key.hash].push_back(item);
+    keys_.insert(item, key);
+    ++types_[key.type];
+}
+
+void RoleIndex::Remove(QObject* item)
+{
+    auto key = keys_.find(item);
+    if (key == keys_.end())
+        return;
+
+    auto items = items_.find(key->hash);
+    if (items != items_.end())
+    {
+        items->erase(std::remove(items->begin(), items->end(), item), items->end());
+        if (items->empty())
+            items_.erase(items);
+    }
+    auto type = types_.find(key->type);
+    if (type != types_.end() && --type.value() == 0)
+        types_.erase(type);
+    keys_.erase(key);
+}
+
+void RoleIndex::Clear()
+{
+    items_.clear();
+    keys_.clear();
+    types_.clear();
+}
+
+RoleIndex::Items RoleIndex::Find(const QVariant& val) const
+{
+    Items found;
+    uint  key = 0;
+    // обычно все значения роли одного типа
+    if (types_.size() == 1)
+    {
+        auto type  = types_.begin().key();
+        auto match = GetKey(val, type, key);
+        if (match == Match::kAll)
+        {
+            for (auto it = keys_.begin(); it != keys_.end(); ++it) found.push_back(it.key());
+            return found;
+        }
+        auto items = match == Match::kKey ? items_.find(key) : items_.end();
+        return items != items_.end() ? items.value() : found;
+    }
+
+    for (auto type = types_.begin(); type != types_.end(); ++type)
+    {
+        switch (GetKey(val, type.key(), key))
+        {
+            case Match::kKey:
+                AppendItems(found, key, type.key());
+                break;
+            case Match::kAll:
+                for (auto it = keys_.begin(); it != keys_.end(); ++it)
+                    if (it->type == type.key())
+                        found.push_back(it.key());
+                break;
+            case Match::kNone:
+                break;
+        }
+    }
+    return found;
+}
+
+RoleIndex::Match RoleIndex::GetKey(const QVariant& val, int type, uint& key) const
+{
+    // QVariant::operator== сравнивает числа разных типов как числа, вещественные - приблизительно,
+    // остальные значения - после преобразования второго значения к типу первого или, если оно невозможно, наоборот
+    auto val_type = val.userType();
+    if (val_type == type || !val.isValid())
+    {
+        key = GetKey(val);
+        return Match::kKey;
+    }
+    if (IsNumber(val_type) && IsNumber(type))
+    {
+        if (IsFloatingPoint(type))
+        {
+            auto converted = val;
+            converted.convert(type);
+            key = GetKey(converted);
+        }
+        else if (IsFloatingPoint(val_type))
+        {
+            key = GetNumberKey(qRound64(val.toDouble()));
+        }
+        else
+        {
+            key = GetKey(val);
+        }
+        return Match::kKey;
+    }
+    if (!val.canConvert(type))
+        return Match::kAll;
+    auto converted = val;
+    if (!converted.convert(type))
+        return Match::kNone;
+    key = GetKey(converted);
+    return Match::kKey;
+}
+
+void RoleIndex::AppendItems(Items& found, uint key, int type) const
+{
+    auto items = items_.find(key);
+    if (items == items_.end())
+        return;
+    for (auto item : items.value())
+        if (keys_.value(item).type == type)
+            found.push_back(item);
+}
+
+uint RoleIndex::GetKey(const QVariant& val)
+{
+    if (!val.isValid())
+        return 0;
+    auto type = val.userType();
+    // objects are compared by pointers
+    if (type == QMetaType::QObjectStar || QMetaType::typeFlags(type).testFlag(QMetaType::PointerToQObject))
+        return qHash(val.value<QObject*>());
+    if (QMetaType::typeFlags(type).testFlag(QMetaType::IsEnumeration))
+        return GetNumberKey(val.toLongLong());
+
+    switch (type)
+    {
+        case QMetaType::Bool:
+            return GetNumberKey(val.toBool() ? 1 : 0);
+        case QMetaType::Int:
+        case QMetaType::UInt:
+        case QMetaType::Long:
+        case QMetaType::ULong:
+        case QMetaType::LongLong:
+        case QMetaType::ULongLong:
+        case QMetaType::Short:
+        case QMetaType::UShort:
+        case QMetaType::Char:
+        case QMetaType::SChar:
+        case QMetaType::UChar:
+        case QMetaType::Float:
+        case QMetaType::Double:
+            return GetNumberKey(val.toDouble());
+        case QMetaType::QString:
+        case QMetaType::QByteArray:
+            return GetStringKey(val.toString());
+        default:
+            break;
+    }
+
+    if (val.canConvert<QVariantList>())
+    {
+        uint key = 0;
+        for (const auto& element : val.toList()) key = key * 31 + GetKey(element);
+        return key;
+    }
+    if (val.canConvert<QString>())
+        return GetStringKey(val.toString());
+    // equal values of the same type have the same stream form
+    QByteArray  data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    if (QMetaType::save(stream, type, val.constData()))
+        return qHash(data);
+    return qHash(type);
+}
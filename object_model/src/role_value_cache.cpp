@@ -0,0 +1,204 @@
+#include "role_value_cache.h"
+#include <QDebug>
+#include <stdexcept>
+
+using namespace om;
+
+std::optional<RoleValueCache::ColumnType> RoleValueCache::GetColumnType(const ObjectMetaData::RoleInfo* role)
+{
+    if (role->property.isEnumType())
+        return INT_COLUMN;  // enums are read as ints
+
+    switch (role->property.userType())
+    {
+        case QMetaType::Int: return INT_COLUMN;
+        case QMetaType::Double: return DOUBLE_COLUMN;
+        case QMetaType::Bool: return BOOL_COLUMN;
+        case QMetaType::QString: return STRING_COLUMN;
+        default: return {};
+    }
+}
+
+bool RoleValueCache::IsCacheable(const ObjectMetaData::RoleInfo* role)
+{
+    if (!role || role->id == ObjectMetaData::kItemRole || role->IsSignal() || role->meta_object || !GetColumnType(role))
+        return false;
+
+    // value of the role and all objects on its path must be notifiable
+    for (auto info = role; info && info->id != ObjectMetaData::kItemRole; info = info->parent)
+        if (!info->notifier && !info->property.isConstant())
+            return false;
+    return true;
+}
+
+void RoleValueCache::SetRoles(const ObjectMetaData* meta_data, const Ids& roles)
+{
+    roles_.clear();
+    notifiers_.clear();
+    columns_.clear();
+    column_indexes_.clear();
+    notifier_columns_.clear();
+
+    if (!meta_data)
+        return;
+
+    column_indexes_.assign(meta_data->GetRoleInfos().size(), -1);
+    notifier_columns_.resize(meta_data->GetNotifiers().size());
+
+    for (auto role : roles)
+    {
+        auto info = meta_data->GetRoleInfo(role);
+        if (!IsCacheable(info))
+        {
+            qDebug() << (std::invalid_argument("Role can not be cached"), QString("Role %1 can not be cached").arg(QString::fromUtf8(info->name)));
+            continue;
+        }
+
+        auto column_index                                 = static_cast<int>(columns_.size());
+        column_indexes_[role - ObjectMetaData::kItemRole] = column_index;
+        roles_.insert(role);
+
+        Column column;
+        column.role_id = role;
+        column.type    = *GetColumnType(info);
+        column.Resize(slot_count_);
+        columns_.push_back(std::move(column));
+
+        for (auto parent = info; parent && parent->id != ObjectMetaData::kItemRole; parent = parent->parent)
+        {
+            if (parent->notifier)
+            {
+                notifiers_.insert(parent->notifier->id);
+                notifier_columns_[parent->notifier->id].push_back(column_index);
+            }
+        }
+    }
+}
+
+int RoleValueCache::AllocateSlot()
+{
+    if (!free_slots_.empty())
+    {
+        auto slot = free_slots_.back();
+        free_slots_.pop_back();
+        return slot;
+    }
+
+    for (auto& column : columns_) column.Resize(slot_count_ + 1);
+    return slot_count_++;
+}
+
+void RoleValueCache::ReleaseSlot(int slot)
+{
+    if (slot < 0 || slot >= slot_count_)
+        return;
+    for (auto& column : columns_) column.Reset(slot);
+    free_slots_.push_back(slot);
+}
+
+void RoleValueCache::Clear()
+{
+    for (auto& column : columns_)
+    {
+        column.Resize(0);
+        column.states.shrink_to_fit();
+        column.strings.shrink_to_fit();
+    }
+    free_slots_.clear();
+    slot_count_ = 0;
+}
+
+void RoleValueCache::Invalidate(int slot, int notifier_id)
+{
+    if (slot < 0 || notifier_id < 0 || notifier_id >= static_cast<int>(notifier_columns_.size()))
+        return;
+    for (auto column_index : notifier_columns_[notifier_id]) columns_[column_index].Reset(slot);
+}
+
+bool RoleValueCache::Read(int slot, Id role, QVariant& val) const
+{
+    auto column_index = GetColumnIndex(role);
+    if (column_index < 0 || slot < 0)
+        return false;
+
+    const auto& column = columns_[column_index];
+    switch (column.states[slot])
+    {
+        case EMPTY_CELL: return false;
+        case NULL_CELL: val = QVariant(); return true;
+        default: break;
+    }
+
+    switch (column.type)
+    {
+        case INT_COLUMN: val = column.ints[slot]; break;
+        case DOUBLE_COLUMN: val = column.doubles[slot]; break;
+        case BOOL_COLUMN: val = static_cast<bool>(column.bools[slot]); break;
+        case STRING_COLUMN: val = column.strings[slot]; break;
+    }
+    return true;
+}
+
+void RoleValueCache::Write(int slot, Id role, const QVariant& val)
+{
+    auto column_index = GetColumnIndex(role);
+    if (column_index < 0 || slot < 0)
+        return;
+
+    auto& column = columns_[column_index];
+    if (!val.isValid())
+    {
+        column.Reset(slot);
+        column.states[slot] = NULL_CELL;
+        return;
+    }
+
+    switch (column.type)
+    {
+        case INT_COLUMN: column.ints[slot] = val.toInt(); break;
+        case DOUBLE_COLUMN: column.doubles[slot] = val.toDouble(); break;
+        case BOOL_COLUMN: column.bools[slot] = val.toBool(); break;
+        case STRING_COLUMN: column.strings[slot] = val.toString(); break;
+    }
+    column.states[slot] = VALID_CELL;
+}
+
+size_t RoleValueCache::GetMemoryUsage(Id role) const
+{
+    auto column_index = GetColumnIndex(role);
+    if (column_index < 0)
+        return 0;
+
+    const auto& column = columns_[column_index];
+    size_t      res    = column.states.capacity() + column.ints.capacity() * sizeof(int) + column.doubles.capacity() * sizeof(double) + column.bools.capacity() +
+                 column.strings.capacity() * sizeof(QString);
+    // implicitly shared strings are counted for each cell
+    for (const auto& string : column.strings) res += string.capacity() * sizeof(QChar);
+    return res;
+}
+
+int RoleValueCache::GetColumnIndex(Id role) const
+{
+    auto index = role - ObjectMetaData::kItemRole;
+    return index >= 0 && index < static_cast<int>(column_indexes_.size()) ? column_indexes_[index] : -1;
+}
+
+// Column
+void RoleValueCache::Column::Resize(size_t size)
+{
+    states.resize(size, EMPTY_CELL);
+    switch (type)
+    {
+        case INT_COLUMN: ints.resize(size); break;
+        case DOUBLE_COLUMN: doubles.resize(size); break;
+        case BOOL_COLUMN: bools.resize(size); break;
+        case STRING_COLUMN: strings.resize(size); break;
+    }
+}
+
+void RoleValueCache::Column::Reset(int slot)
+{
+    states[slot] = EMPTY_CELL;
+    if (type == STRING_COLUMN)
+        strings[slot] = QString();
+}
@@ -0,0 +1,119 @@
+#include "snapshot_file.h"
+#include <QSaveFile>
+#include <QtEndian>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+using namespace om;
+
+namespace
+{
+const char    kMagic[]    = { 'O', 'M', 'S', 'N', 'A', 'P', 'S', 'H' };
+const quint32 kVersion    = 1;
+const qint64  kHeaderSize = sizeof(kMagic) + 2 * sizeof(quint32);
+const qint64  kOffsetSize = sizeof(quint64);
+const qint64  kRecordSize = sizeof(quint32);
+}  // namespace
+
+SnapshotFile::~SnapshotFile()
+{
+    Close();
+}
+
+bool SnapshotFile::Open(const QString& file_path)
+{
+    Close();
+    file_.setFileName(file_path);
+    if (!file_.open(QIODevice::ReadOnly))
+        return false;
+
+    size_ = file_.size();
+    data_ = size_ >= kHeaderSize ? file_.map(0, size_) : nullptr;
+    if (!data_ || std::memcmp(data_, kMagic, sizeof(kMagic)) != 0 || qFromLittleEndian<quint32>(data_ + sizeof(kMagic)) != kVersion)
+    {
+        Close();
+        return false;
+    }
+
+    // записи проверяются при чтении, здесь только то, что индекс помещается в файл
+    auto count = qFromLittleEndian<quint32>(data_ + sizeof(kMagic) + sizeof(quint32));
+    if (count > static_cast<quint32>(std::numeric_limits<int>::max()) || kHeaderSize + count * kOffsetSize > size_)
+    {
+        Close();
+        return false;
+    }
+    count_ = static_cast<int>(count);
+    return true;
+}
+
+void SnapshotFile::Close()
+{
+    if (data_)
+        file_.unmap(const_cast<uchar*>(data_));
+    file_.close();
+    data_  = nullptr;
+    size_  = 0;
+    count_ = 0;
+}
+
+bool SnapshotFile::IsOpened() const
+{
+    return data_ != nullptr;
+}
+
+int SnapshotFile::GetCount() const
+{
+    return count_;
+}
+
+const char* SnapshotFile::GetRecord(int row, int* size) const
+{
+    if (!data_ || row < 0 || row >= count_)
+        return nullptr;
+    // смещение и размер прочитаны из файла, поэтому сравниваются с остатком файла без сложения, которое может переполниться
+    auto size   = static_cast<quint64>(size_);
+    auto offset = qFromLittleEndian<quint64>(data_ + kHeaderSize + row * kOffsetSize);
+    if (offset < static_cast<quint64>(kHeaderSize) || offset > size - kRecordSize)
+        return nullptr;
+    auto record_size = qFromLittleEndian<quint32>(data_ + offset);
+    if (record_size > size - offset - kRecordSize || record_size > static_cast<quint32>(std::numeric_limits<int>::max()))
+        return nullptr;
+    *size = static_cast<int>(record_size);
+    return reinterpret_cast<const char*>(data_ + offset + kRecordSize);
+}
+
+bool SnapshotFile::Write(const QString& file_path, int count, const RecordSize& record_size, const RecordWriter& write_record)
+{
+    if (count < 0)
+        return false;
+
+    // смещения записей известны до записи данных, поэтому индекс пишется перед ними
+    std::vector<quint32> sizes(count);
+    QByteArray           header(kHeaderSize + count * kOffsetSize, Qt::Uninitialized);
+    std::memcpy(header.data(), kMagic, sizeof(kMagic));
+    qToLittleEndian<quint32>(kVersion, header.data() + sizeof(kMagic));
+    qToLittleEndian<quint32>(static_cast<quint32>(count), header.data() + sizeof(kMagic) + sizeof(quint32));
+    quint64 offset = header.size();
+    for (int row = 0; row < count; ++row)
+    {
+        sizes[row] = record_size(row);
+        qToLittleEndian<quint64>(offset, header.data() + kHeaderSize + row * kOffsetSize);
+        offset += kRecordSize + sizes[row];
+    }
+
+    QSaveFile file(file_path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(header) != header.size())
+        return false;
+
+    QByteArray record;
+    for (int row = 0; row < count; ++row)
+    {
+        record.resize(static_cast<int>(kRecordSize + sizes[row]));
+        qToLittleEndian<quint32>(sizes[row], record.data());
+        write_record(row, record.data() + kRecordSize, sizes[row]);
+        if (file.write(record) != record.size())
+            return false;  // временный файл удаляется QSaveFile
+    }
+    return file.commit();
+}
@@ -1,18 +1,40 @@
 ﻿#include "sort_filter_proxy_model.h"
+#include "sort_keys.h"
 
 //#include <log_qt.h>
 
+#include <QFutureWatcher>
 #include <QHash>
+#include <QThread>
+#include <QtConcurrent>
 #include <QtQml>
+#include <algorithm>
+#include <numeric>
+#include <typeinfo>
+#include <utility>
 
 using namespace om;
 
-SortFilterProxyModel::SortFilterProxyModel(QObject* parent /*= nullptr*/) : QSortFilterProxyModel(parent), ListModelAccess(), AbstractDynamicRolesProvider()
+namespace
+{
+// Changes of more rows are applied with full filtering and sorting
+constexpr int kMinIncrementalRows     = 32;
+constexpr int kIncrementalRowsDivider = 16;
+// Inserted rows, that fall into more proxy ranges, are appended and sorted with one layout change
+constexpr int kMaxInsertRanges = 64;
+
+// Rows of these changes are found by the filter program by the changed values
+bool IsValuesChange(AbstractFilter::FilterChange change)
+{
+    return change == AbstractFilter::FilterChange::RANGE_MOVED || change == AbstractFilter::FilterChange::VALUES_TOGGLED;
+}
+}  // namespace
+
+SortFilterProxyModel::SortFilterProxyModel(QObject* parent /*= nullptr*/) : QAbstractProxyModel(parent), ListModelAccess(), AbstractDynamicRolesProvider()
 {
     connect(this, &QAbstractItemModel::rowsInserted, this, &SortFilterProxyModel::rowCountChanged);
     connect(this, &QAbstractItemModel::rowsRemoved, this, &SortFilterProxyModel::rowCountChanged);
     connect(this, &QAbstractItemModel::modelReset, this, &SortFilterProxyModel::rowCountChanged);
-    setDynamicSortFilter(false);
 }
 
 bool SortFilterProxyModel::IsEnabled() const
@@ -25,6 +47,8 @@ void SortFilterProxyModel::SetEnabled(bool val)
     if (enabled_ == val)
         return;
     enabled_ = val;
+    // source changes are not applied, while proxy is disabled
+    filter_change_ = AbstractFilter::FilterChange::ANY;
     emit enabledChanged();
     if (sorting_required_)
         PrivateSort();
@@ -32,11 +56,46 @@ void SortFilterProxyModel::SetEnabled(bool val)
         PrivateFilter();
 }
 
+bool SortFilterProxyModel::IsAsync() const
+{
+    return async_;
+}
+
+void SortFilterProxyModel::SetAsync(bool val)
+{
+    if (async_ == val)
+        return;
+    async_ = val;
+    if (!async_ && sort_job_running_)
+    {
+        CancelSortJob();
+        PrivateSort();
+    }
+    // filtering cancels the running job itself
+    if (!async_ && filter_job_running_)
+        PrivateFilter();
+    emit asyncChanged();
+}
+
+bool SortFilterProxyModel::IsBusy() const
+{
+    return busy_;
+}
+
+void SortFilterProxyModel::SetBusy(bool val)
+{
+    if (busy_ == val)
+        return;
+    busy_ = val;
+    emit busyChanged();
+}
+
 void SortFilterProxyModel::setSourceModel(QAbstractItemModel* val)
 {
     if (val == sourceModel())
         return;
 
+    beginResetModel();
     if (sourceModel())
     {
         role_ids_.clear();
@@ -67,19 +126,30 @@ void SortFilterProxyModel::setSourceModel(QAbstractItemModel* val)
             }
         }
 
-        connect(val, &QAbstractItemModel::rowsInserted, this, &SortFilterProxyModel::Invalidate);
-        connect(val, &QAbstractItemModel::rowsRemoved, this, &SortFilterProxyModel::Invalidate);
-        connect(val, &QAbstractItemModel::modelReset, this, &SortFilterProxyModel::Invalidate);
+        connect(val, &QAbstractItemModel::rowsAboutToBeRemoved, this, &SortFilterProxyModel::OnSourceRowsAboutToBeRemoved);
+        connect(val, &QAbstractItemModel::rowsRemoved, this, &SortFilterProxyModel::OnSourceRowsRemoved);
+        connect(val, &QAbstractItemModel::rowsInserted, this, &SortFilterProxyModel::OnSourceRowsInserted);
+        connect(val, &QAbstractItemModel::rowsMoved, this, &SortFilterProxyModel::OnSourceRowsMoved);
+        // source rows can't be tracked through layout change, so it is handled as reset
+        connect(val, &QAbstractItemModel::modelAboutToBeReset, this, [this] { beginResetModel(); });
+        connect(val, &QAbstractItemModel::layoutAboutToBeChanged, this, [this] { beginResetModel(); });
+        connect(val, &QAbstractItemModel::modelReset, this, &SortFilterProxyModel::OnSourceModelReset);
+        connect(val, &QAbstractItemModel::layoutChanged, this, &SortFilterProxyModel::OnSourceModelReset);
         connect(val, &QAbstractItemModel::dataChanged, this, &SortFilterProxyModel::OnDataChanged);
+        connect(val, &QObject::destroyed, this, [this] {
+            beginResetModel();
+            proxy_to_source_.clear();
+            source_to_proxy_.clear();
+            endResetModel();
+        });
     }
 
     UpdateFilterRoleIds();
     UpdateSortRoleIds();
     SetDynamicRolesReceiver(source_object_model_);
-    QSortFilterProxyModel::setSourceModel(val);
-
-    if (val)
-        Invalidate();
+    QAbstractProxyModel::setSourceModel(val);
+    RebuildMapping();
+    endResetModel();
 
     emit modelChanged();
 }
@@ -99,7 +169,7 @@ void SortFilterProxyModel::SetFilter(AbstractFilter* val)
         disconnect(filter_, 0, this, 0);
 
     filter_ = val;
-    connect(filter_, &AbstractFilter::filterChanged, this, &SortFilterProxyModel::Invalidate);
+    connect(filter_, &AbstractFilter::filterChanged, this, &SortFilterProxyModel::OnFilterChanged);
     connect(filter_, &AbstractFilter::rolesChanged, this, &SortFilterProxyModel::OnFilterRolesChanged);
     OnFilterRolesChanged();
     emit filterChanged();
@@ -127,6 +197,13 @@ void SortFilterProxyModel::SetComparator(AbstractComparator* val)
 }
 
 // Dynamic roles
+void SortFilterProxyModel::OnFilterChanged()
+{
+    CompileFilter();
+    Filter(filter_ ? filter_->GetLastChange() : AbstractFilter::FilterChange::ANY);
+    Sort();
+}
+
 void SortFilterProxyModel::OnFilterRolesChanged()
 {
     filter_roles_.clear();
@@ -196,17 +273,27 @@ void SortFilterProxyModel::UpdateSortRoleIds()
 void SortFilterProxyModel::UpdateFilterRoleIds()
 {
     filter_role_ids_.clear();
-    if (role_ids_.empty())
-        return;
-    for (auto& role : filter_roles_)
+    if (!role_ids_.empty())
     {
-        auto role_id = role_ids_.find(role.first);
-        if (role_id == role_ids_.end())
-            qDebug() << (std::logic_error("Source model doesn't have filter role "), QString("Source model doesn't have sort role %1").arg(QString::fromUtf8(role.first)));
+        for (auto& role : filter_roles_)
+        {
+            auto role_id = role_ids_.find(role.first);
+            if (role_id == role_ids_.end())
+                qDebug() << (std::logic_error("Source model doesn't have filter role "), QString("Source model doesn't have sort role %1").arg(QString::fromUtf8(role.first)));
 
-        role.second = role_id.value();
-        filter_role_ids_.insert(role.second);
+            role.second = role_id.value();
+            filter_role_ids_.insert(role.second);
+        }
     }
+    CompileFilter();
+}
+
+void SortFilterProxyModel::CompileFilter()
+{
+    if (filter_)
+        filter_program_.Compile(filter_, filter_roles_);
+    else
+        filter_program_.Clear();
 }
 
 Ids SortFilterProxyModel::GetDynamicRoles() const
@@ -242,6 +329,80 @@ void SortFilterProxyModel::ChangeSortOrder()
     SetSortOrder(sort_order_ == Qt::AscendingOrder ? Qt::DescendingOrder : Qt::AscendingOrder);
 }
 
+// QSortFilterProxyModel compatibility
+int SortFilterProxyModel::sortRole() const
+{
+    return sort_roles_.empty() ? Qt::DisplayRole : role_ids_.value(sort_roles_.front().name, Qt::DisplayRole);
+}
+
+void SortFilterProxyModel::setSortRole(int role)
+{
+    auto name = role_ids_.key(role);
+    if (name.isEmpty())
+    {
+        qDebug() << QString("Source model doesn't have sort role %1").arg(role);
+        return;
+    }
+    SetSortRole(name);
+}
+
+int SortFilterProxyModel::filterRole() const
+{
+    return filter_role_;
+}
+
+void SortFilterProxyModel::setFilterRole(int role)
+{
+    if (role == filter_role_)
+        return;
+    filter_role_ = role;
+    emit filterRoleChanged(role);
+}
+
+bool SortFilterProxyModel::dynamicSortFilter() const
+{
+    return dynamic_sort_filter_;
+}
+
+void SortFilterProxyModel::setDynamicSortFilter(bool val)
+{
+    if (val == dynamic_sort_filter_)
+        return;
+    dynamic_sort_filter_ = val;
+    emit dynamicSortFilterChanged(val);
+}
+
+void SortFilterProxyModel::invalidate()
+{
+    Invalidate();
+}
+
+void SortFilterProxyModel::invalidateFilter()
+{
+    Filter();
+}
+
+bool SortFilterProxyModel::lessThan(const QModelIndex& source_left, const QModelIndex& source_right) const
+{
+    return CompareRows(source_left, source_right) == AbstractFilterComparatorBase::ComparisonResult::LESS;
+}
+
+bool SortFilterProxyModel::filterAcceptsRow(int source_row, const QModelIndex& source_parent) const
+{
+    return filter_ ? filter_->AcceptsRow(sourceModel()->index(source_row, 0, source_parent), filter_roles_) : true;
+}
+
+bool SortFilterProxyModel::IsVirtualSortFilter() const
+{
+    return virtual_sort_filter_.value_or(typeid(*this) != typeid(SortFilterProxyModel));
+}
+
+void SortFilterProxyModel::SetVirtualSortFilter(bool val)
+{
+    virtual_sort_filter_ = val;
+    Invalidate();
+}
+
 // Data
 int SortFilterProxyModel::GetCount() const
 {
@@ -284,16 +445,320 @@ int SortFilterProxyModel::IndexOf(const QByteArray& property_name, const QVarian
 
 int SortFilterProxyModel::MapFromSource(int source_row)
 {
-    if (!sourceModel())
-        return -1;
-    return mapFromSource(sourceModel()->index(source_row, 0)).row();
+    return source_row >= 0 && source_row < source_to_proxy_.size() ? source_to_proxy_[source_row] : -1;
 }
 
 int SortFilterProxyModel::MapToSource(int row)
 {
-    if (!sourceModel())
-        return -1;
-    return mapToSource(index(row, 0)).row();
+    return row >= 0 && row < proxy_to_source_.size() ? proxy_to_source_[row] : -1;
+}
+
+// Mapping
+QModelIndex SortFilterProxyModel::index(int row, int column, const QModelIndex& parent /*= QModelIndex()*/) const
+{
+    if (parent.isValid() || row < 0 || row >= rowCount() || column < 0 || column >= columnCount())
+        return QModelIndex();
+    return createIndex(row, column);
+}
+
+QModelIndex SortFilterProxyModel::parent(const QModelIndex&) const
+{
+    return QModelIndex();
+}
+
+int SortFilterProxyModel::rowCount(const QModelIndex& parent /*= QModelIndex()*/) const
+{
+    return parent.isValid() ? 0 : proxy_to_source_.size();
+}
+
+int SortFilterProxyModel::columnCount(const QModelIndex& parent /*= QModelIndex()*/) const
+{
+    return parent.isValid() || !sourceModel() ? 0 : sourceModel()->columnCount();
+}
+
+bool SortFilterProxyModel::hasChildren(const QModelIndex& parent /*= QModelIndex()*/) const
+{
+    return !parent.isValid() && rowCount() > 0;
+}
+
+QModelIndex SortFilterProxyModel::mapToSource(const QModelIndex& proxy_index) const
+{
+    if (!proxy_index.isValid() || !sourceModel() || proxy_index.row() >= proxy_to_source_.size())
+        return QModelIndex();
+    return sourceModel()->index(proxy_to_source_[proxy_index.row()], proxy_index.column());
+}
+
+QModelIndex SortFilterProxyModel::mapFromSource(const QModelIndex& source_index) const
+{
+    if (!source_index.isValid() || source_index.row() >= source_to_proxy_.size())
+        return QModelIndex();
+    auto row = source_to_proxy_[source_index.row()];
+    return row >= 0 ? index(row, source_index.column()) : QModelIndex();
+}
+
+void SortFilterProxyModel::RebuildMapping()
+{
+    CancelSortJob();
+    CancelFilterJob();
+    filter_program_.ClearCache();
+    proxy_to_source_.clear();
+    auto         count = sourceModel() ? sourceModel()->rowCount() : 0;
+    QVector<int> source_rows(count);
+    std::iota(source_rows.begin(), source_rows.end(), 0);
+    auto accepted = FilterAcceptsRows(source_rows);
+    for (int row = 0; row < count; ++row)
+        if (accepted.testBit(row))
+            proxy_to_source_.push_back(row);
+    SortSourceRows(proxy_to_source_);
+
+    source_to_proxy_.fill(-1, count);
+    UpdateSourceToProxy();
+}
+
+void SortFilterProxyModel::UpdateSourceToProxy(int first_row /*= 0*/)
+{
+    for (int row = first_row; row < proxy_to_source_.size(); ++row) source_to_proxy_[proxy_to_source_[row]] = row;
+}
+
+int SortFilterProxyModel::FindInsertPosition(int source_row, const QVector<char>& dirty /*= QVector<char>()*/) const
+{
+    int first = 0, last = proxy_to_source_.size();
+    while (first < last)
+    {
+        auto middle = (first + last) / 2;
+        auto clean  = middle;
+        while (clean < last && !dirty.isEmpty() && dirty[clean]) ++clean;
+        if (clean == last)
+            last = middle;
+        else if (LessThan(proxy_to_source_[clean], source_row))
+            first = clean + 1;
+        else
+            last = middle;
+    }
+    return first;
+}
+
+void SortFilterProxyModel::InsertSourceRows(QVector<int> source_rows)
+{
+    if (source_rows.isEmpty())
+        return;
+    RestartSortJob();
+
+    SortSourceRows(source_rows);
+
+    // consecutive rows with the same position are inserted with one signal
+    QVector<QPair<int, int>> ranges;  // position in current proxy rows, first index in source_rows
+    for (int i = 0; i < source_rows.size(); ++i)
+    {
+        auto position = ranges.isEmpty() || ranges.back().first < proxy_to_source_.size() ? FindInsertPosition(source_rows[i]) : proxy_to_source_.size();
+        if (ranges.isEmpty() || ranges.back().first != position)
+            ranges.push_back({ position, i });
+    }
+
+    if (ranges.size() > kMaxInsertRanges)
+    {
+        auto first = proxy_to_source_.size();
+        beginInsertRows(QModelIndex(), first, first + source_rows.size() - 1);
+        proxy_to_source_ += source_rows;
+        UpdateSourceToProxy(first);
+        endInsertRows();
+        PrivateSort();
+        return;
+    }
+
+    // from the back, so positions of the previous ranges stay valid
+    auto end = source_rows.size();
+    for (auto range = ranges.rbegin(); range != ranges.rend(); ++range)
+    {
+        auto count = end - range->second;
+        beginInsertRows(QModelIndex(), range->first, range->first + count - 1);
+        proxy_to_source_.insert(range->first, count, -1);
+        std::copy(source_rows.begin() + range->second, source_rows.begin() + end, proxy_to_source_.begin() + range->first);
+        UpdateSourceToProxy(range->first);
+        endInsertRows();
+        end = range->second;
+    }
+}
+
+void SortFilterProxyModel::RemoveProxyRows(const QVector<int>& rows)
+{
+    if (!rows.isEmpty())
+        RestartSortJob();
+    for (auto last = rows.size() - 1; last >= 0;)
+    {
+        auto first = last;
+        while (first > 0 && rows[first - 1] == rows[first] - 1) --first;
+
+        beginRemoveRows(QModelIndex(), rows[first], rows[last]);
+        for (int row = rows[first]; row <= rows[last]; ++row) source_to_proxy_[proxy_to_source_[row]] = -1;
+        proxy_to_source_.remove(rows[first], last - first + 1);
+        UpdateSourceToProxy(rows[first]);
+        endRemoveRows();
+
+        last = first - 1;
+    }
+}
+
+void SortFilterProxyModel::MoveChangedRows(const QVector<int>& source_rows)
+{
+    if (source_rows.isEmpty())
+        return;
+
+    // changed rows are out of order until they are moved, so binary search skips them
+    QVector<char> dirty(proxy_to_source_.size(), 0);
+    for (auto source_row : source_rows) dirty[source_to_proxy_[source_row]] = 1;
+
+    for (auto source_row : source_rows)
+    {
+        auto from     = source_to_proxy_[source_row];
+        auto position = FindInsertPosition(source_row, dirty);
+        if (position == from || position == from + 1)
+        {
+            dirty[from] = 0;
+            continue;
+        }
+
+        auto to = position > from ? position - 1 : position;
+        beginMoveRows(QModelIndex(), from, from, QModelIndex(), position);
+        proxy_to_source_.move(from, to);
+        dirty.move(from, to);
+        dirty[to] = 0;
+        for (int row = qMin(from, to); row <= qMax(from, to); ++row) source_to_proxy_[proxy_to_source_[row]] = row;
+        endMoveRows();
+    }
+}
+
+void SortFilterProxyModel::UpdateSourceRows(const QVector<int>& source_rows, bool refilter, bool resort)
+{
+    if (resort)
+        RestartSortJob();
+
+    QVector<int> valid_source_rows;
+    for (auto source_row : source_rows)
+        if (source_row >= 0 && source_row < source_to_proxy_.size())
+            valid_source_rows.push_back(source_row);
+    // changed rows are filtered together
+    auto accepted_rows = refilter ? FilterAcceptsRows(valid_source_rows) : QBitArray();
+
+    QVector<int> removed_rows, inserted_source_rows, moved_source_rows;
+    for (int i = 0; i < valid_source_rows.size(); ++i)
+    {
+        auto source_row = valid_source_rows[i];
+        auto row        = source_to_proxy_[source_row];
+        auto accepted   = refilter ? accepted_rows.testBit(i) : row >= 0;
+        if (row >= 0 && !accepted)
+            removed_rows.push_back(row);
+        else if (row < 0 && accepted)
+            inserted_source_rows.push_back(source_row);
+        else if (row >= 0 && resort && !sort_roles_.empty())
+            moved_source_rows.push_back(source_row);
+    }
+
+    std::sort(removed_rows.begin(), removed_rows.end());
+    RemoveProxyRows(removed_rows);
+    // proxy rows must be sorted before insertion
+    MoveChangedRows(moved_source_rows);
+    InsertSourceRows(inserted_source_rows);
+}
+
+void SortFilterProxyModel::EmitDataChanged(const QVector<int>& source_rows, const QVector<int>& roles)
+{
+    QVector<int> rows;
+    for (auto source_row : source_rows)
+        if (auto row = MapFromSource(source_row); row >= 0)
+            rows.push_back(row);
+    std::sort(rows.begin(), rows.end());
+
+    for (int last = 0, first = 0; first < rows.size(); first = last)
+    {
+        for (last = first + 1; last < rows.size() && rows[last] == rows[last - 1] + 1;) ++last;
+        emit dataChanged(index(rows[first], 0), index(rows[last - 1], columnCount() - 1), roles);
+    }
+}
+
+// Source changes
+void SortFilterProxyModel::OnSourceRowsAboutToBeRemoved(const QModelIndex& parent, int first, int last)
+{
+    if (parent.isValid())
+        return;
+
+    QVector<int> rows;
+    for (int source_row = first; source_row <= last && source_row < source_to_proxy_.size(); ++source_row)
+        if (source_to_proxy_[source_row] >= 0)
+            rows.push_back(source_to_proxy_[source_row]);
+    std::sort(rows.begin(), rows.end());
+    RemoveProxyRows(rows);
+}
+
+void SortFilterProxyModel::OnSourceRowsRemoved(const QModelIndex& parent, int first, int last)
+{
+    if (parent.isValid())
+        return;
+
+    RestartSortJob();
+    RestartFilterJob();
+    filter_program_.ClearCache();
+    auto count = last - first + 1;
+    source_to_proxy_.remove(first, count);
+    for (auto& source_row : proxy_to_source_)
+        if (source_row > last)
+            source_row -= count;
+}
+
+void SortFilterProxyModel::OnSourceRowsInserted(const QModelIndex& parent, int first, int last)
+{
+    if (parent.isValid())
+        return;
+
+    RestartSortJob();
+    RestartFilterJob();
+    filter_program_.ClearCache();
+    auto count = last - first + 1;
+    for (auto& source_row : proxy_to_source_)
+        if (source_row >= first)
+            source_row += count;
+    source_to_proxy_.insert(first, count, -1);
+
+    QVector<int> inserted_rows(count);
+    std::iota(inserted_rows.begin(), inserted_rows.end(), first);
+    auto         accepted = FilterAcceptsRows(inserted_rows);
+    QVector<int> source_rows;
+    for (int i = 0; i < count; ++i)
+        if (accepted.testBit(i))
+            source_rows.push_back(inserted_rows[i]);
+    InsertSourceRows(source_rows);
+}
+
+void SortFilterProxyModel::OnSourceRowsMoved(const QModelIndex& parent, int first, int last, const QModelIndex& destination, int destination_row)
+{
+    if (parent.isValid() || destination.isValid())
+        return;
+
+    RestartSortJob();
+    RestartFilterJob();
+    filter_program_.ClearCache();
+    auto count = last - first + 1;
+    for (auto& source_row : proxy_to_source_)
+    {
+        if (source_row >= first && source_row <= last)
+            source_row += destination_row > last ? destination_row - last - 1 : destination_row - first;
+        else if (destination_row > last && source_row > last && source_row < destination_row)
+            source_row -= count;
+        else if (destination_row < first && source_row >= destination_row && source_row < first)
+            source_row += count;
+    }
+    source_to_proxy_.fill(-1);
+    UpdateSourceToProxy();
+
+    // rows with equal sort values are ordered by their source rows, so the moved rows break the order, that binary search of inserts needs.
+    // Unsorted proxy follows the source order
+    PrivateSort();
+}
+
+void SortFilterProxyModel::OnSourceModelReset()
+{
+    RebuildMapping();
+    endResetModel();
 }
 
 QHash<QByteArray, int> SortFilterProxyModel::roleIds() const
@@ -310,7 +775,7 @@ void SortFilterProxyModel::Invalidate()
 
 void SortFilterProxyModel::Sort()
 {
-    if (sorting_required_ || !sourceModel() || sort_roles_.empty())
+    if (sorting_required_ || !sourceModel())
         return;
     sorting_required_ = true;
     QMetaObject::invokeMethod(this, &SortFilterProxyModel::PrivateSort, Qt::QueuedConnection);
@@ -318,16 +783,149 @@ void SortFilterProxyModel::Sort()
 
 void SortFilterProxyModel::PrivateSort()
 {
+    // source changes call it directly, so disabled proxy is sorted by SetEnabled
     if (!enabled_)
+    {
+        sorting_required_ = true;
         return;
-    sort(0, sort_order_);
+    }
     sorting_required_ = false;
+    CancelSortJob();
+    // without sort roles proxy rows are restored to the source order
+    if (sort_roles_.empty() && std::is_sorted(proxy_to_source_.begin(), proxy_to_source_.end()))
+    {
+        emit sorted();
+        return;
+    }
+    if (async_ && StartSortJob())
+        return;
+
+    auto source_rows = proxy_to_source_;
+    SortSourceRows(source_rows);
+    ApplySortedRows(source_rows);
+}
+
+void SortFilterProxyModel::ApplySortedRows(const QVector<int>& source_rows)
+{
+    emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+
+    auto         persistent_indexes = persistentIndexList();
+    QVector<int> persistent_source_rows;
+    for (const auto& index : persistent_indexes) persistent_source_rows.push_back(MapToSource(index.row()));
+
+    proxy_to_source_ = source_rows;
+    UpdateSourceToProxy();
+
+    QModelIndexList new_indexes;
+    for (int i = 0; i < persistent_indexes.size(); ++i) new_indexes.push_back(index(MapFromSource(persistent_source_rows[i]), persistent_indexes[i].column()));
+    changePersistentIndexList(persistent_indexes, new_indexes);
+
+    emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+    emit sorted();
+}
+
+bool SortFilterProxyModel::StartSortJob()
+{
+    // keys are extracted here, because source model can be read only from its thread. Comparator is called only from GUI thread too
+    auto keys = std::make_shared<SortKeys>();
+    if (IsVirtualSortFilter() || proxy_to_source_.size() < 2 || !keys->Extract(sourceModel(), proxy_to_source_, sort_roles_, comparator_))
+        return false;
+
+    auto job     = ++sort_job_;
+    auto order   = sort_order_;
+    auto watcher = new QFutureWatcher<QVector<int>>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, job] {
+        watcher->deleteLater();
+        if (job != sort_job_)
+            return;
+        sort_job_running_ = false;
+        SetBusy(filter_job_running_);
+        ApplySortedRows(watcher->result());
+    });
+    watcher->setFuture(QtConcurrent::run([keys, order] { return keys->Sort(order, QThread::idealThreadCount()); }));
+    sort_job_running_ = true;
+    SetBusy(true);
+    return true;
+}
+
+void SortFilterProxyModel::CancelSortJob()
+{
+    if (!sort_job_running_)
+        return;
+    ++sort_job_;
+    sort_job_running_ = false;
+    SetBusy(filter_job_running_);
+}
+
+void SortFilterProxyModel::RestartSortJob()
+{
+    if (!sort_job_running_)
+        return;
+    CancelSortJob();
+    Sort();
+}
+
+bool SortFilterProxyModel::StartFilterJob(const QVector<int>& source_rows)
+{
+    // values are read and filters are called here, because source model and filters are used only from GUI thread
+    if (IsVirtualSortFilter() || !filter_ || source_rows.size() < 2)
+        return false;
+    auto snapshot = filter_program_.Read(sourceModel(), source_rows);
+
+    auto job     = ++filter_job_;
+    auto watcher = new QFutureWatcher<QBitArray>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, job, source_rows] {
+        watcher->deleteLater();
+        if (job != filter_job_)
+            return;
+        filter_job_running_ = false;
+        SetBusy(sort_job_running_);
+        ApplyFilteredRows(source_rows, watcher->result());
+    });
+    watcher->setFuture(QtConcurrent::run([snapshot] { return FilterProgram::Evaluate(*snapshot); }));
+    filter_job_running_ = true;
+    SetBusy(true);
+    return true;
+}
+
+bool SortFilterProxyModel::CancelFilterJob()
+{
+    if (!filter_job_running_)
+        return false;
+    ++filter_job_;
+    filter_job_running_ = false;
+    SetBusy(sort_job_running_);
+    return true;
+}
+
+void SortFilterProxyModel::RestartFilterJob()
+{
+    if (CancelFilterJob())
+        Filter();
+}
+
+void SortFilterProxyModel::sort(int, Qt::SortOrder order /*= Qt::AscendingOrder*/)
+{
+    SetSortOrder(order);
 }
 
 void SortFilterProxyModel::Filter()
 {
-    if (filtering_required_ || !sourceModel())
+    Filter(AbstractFilter::FilterChange::ANY);
+}
+
+void SortFilterProxyModel::Filter(AbstractFilter::FilterChange change)
+{
+    if (!sourceModel())
         return;
+    if (filtering_required_)
+    {
+        // changes in different directions can both add and remove rows, changed values of ranges and enumerations are accumulated by the program
+        if (filter_change_ != change && !(IsValuesChange(filter_change_) && IsValuesChange(change)))
+            filter_change_ = AbstractFilter::FilterChange::ANY;
+        return;
+    }
+    filter_change_      = change;
     filtering_required_ = true;
     QMetaObject::invokeMethod(this, &SortFilterProxyModel::PrivateFilter, Qt::QueuedConnection);
 }
@@ -335,33 +933,154 @@ void SortFilterProxyModel::Filter()
 void SortFilterProxyModel::PrivateFilter()
 {
     if (!enabled_)
+    {
+        filtering_required_ = true;
         return;
-    invalidateFilter();
+    }
     filtering_required_ = false;
+    auto change         = std::exchange(filter_change_, AbstractFilter::FilterChange::ANY);
+    // rows of the dropped job are not applied, so the changes since the last filtering are unknown
+    if (CancelFilterJob())
+        change = AbstractFilter::FilterChange::ANY;
+
+    // narrowed filter can only reject accepted rows, widened filter can only accept rejected rows,
+    // moved range and toggled enumeration values can only change rows with values between the bounds and with the toggled values
+    // overridden filterAcceptsRow may depend on anything, so all rows are checked
+    QVector<int> source_rows;
+    if (IsVirtualSortFilter() || (IsValuesChange(change) && !filter_program_.TakeChangedRows(sourceModel(), source_rows)))
+        change = AbstractFilter::FilterChange::ANY;
+    filter_program_.ResetChangedRows();
+    if (change == AbstractFilter::FilterChange::NARROWED)
+    {
+        source_rows = proxy_to_source_;
+    }
+    else if (!IsValuesChange(change))
+    {
+        for (int source_row = 0; source_row < source_to_proxy_.size(); ++source_row)
+            if (change == AbstractFilter::FilterChange::ANY || source_to_proxy_[source_row] < 0)
+                source_rows.push_back(source_row);
+    }
+    if (async_ && StartFilterJob(source_rows))
+        return;
+    ApplyFilteredRows(source_rows, FilterAcceptsRows(source_rows));
 }
 
-void SortFilterProxyModel::OnDataChanged(const QModelIndex&, const QModelIndex&, const QVector<int>& roles /*= QVector<int>()*/)
+void SortFilterProxyModel::ApplyFilteredRows(const QVector<int>& source_rows, const QBitArray& accepted_rows)
 {
-    if (roles.isEmpty())
+    QVector<int> removed_rows, inserted_source_rows;
+    for (int i = 0; i < source_rows.size(); ++i)
     {
-        Invalidate();
+        auto source_row = source_rows[i];
+        auto row        = source_to_proxy_[source_row];
+        auto accepted   = accepted_rows.testBit(i);
+        if (row >= 0 && !accepted)
+            removed_rows.push_back(row);
+        else if (row < 0 && accepted)
+            inserted_source_rows.push_back(source_row);
     }
-    else
+    std::sort(removed_rows.begin(), removed_rows.end());
+    RemoveProxyRows(removed_rows);
+    InsertSourceRows(inserted_source_rows);
+    emit filtered();
+}
+
+void SortFilterProxyModel::OnDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles /*= QVector<int>()*/)
+{
+    if (!topLeft.isValid() || !bottomRight.isValid() || topLeft.parent().isValid() || bottomRight.parent().isValid())
+        return;
+
+    QVector<int> source_rows;
+    for (int source_row = topLeft.row(); source_row <= qMin(bottomRight.row(), source_to_proxy_.size() - 1); ++source_row) source_rows.push_back(source_row);
+    if (source_rows.isEmpty())
+        return;
+
+    Ids role_ids(roles.begin(), roles.end());
+    if (roles.isEmpty() || SetsIntersect(filter_role_ids_, role_ids))
+        OnFilterRowsChanged(source_rows);
+    if (enabled_)
     {
-        OnItemDataChanged(Ids(roles.begin(), roles.end()));
+        auto refilter = !filtering_required_ && (roles.isEmpty() || SetsIntersect(filter_role_ids_, role_ids));
+        auto resort   = !sorting_required_ && (roles.isEmpty() || SetsIntersect(sort_role_ids_, role_ids));
+        if (refilter || resort)
+            UpdateSourceRows(source_rows, refilter, resort);
     }
+    EmitDataChanged(source_rows, roles);
 }
 
 void SortFilterProxyModel::OnItemDataChanged(const Ids& roles)
 {
-    if (!filtering_required_ && SetsIntersect(filter_role_ids_, roles))
-        PrivateFilter();
+    if (SetsIntersect(filter_role_ids_, roles))
+        OnFilterRowsChanged(source_object_model_ ? source_object_model_->GetItemDataChangedRows() : QVector<int>());
+
+    auto refilter = !filtering_required_ && SetsIntersect(filter_role_ids_, roles);
+    auto resort   = !sorting_required_ && SetsIntersect(sort_role_ids_, roles);
+    if (!enabled_ || (!refilter && !resort))
+        return;
+
+    // only changed rows are updated, if there are not too many of them
+    const auto& source_rows = source_object_model_ ? source_object_model_->GetItemDataChangedRows() : QVector<int>();
+    if (!source_rows.isEmpty() && source_rows.size() <= qMax(kMinIncrementalRows, source_to_proxy_.size() / kIncrementalRowsDivider))
+    {
+        UpdateSourceRows(source_rows, refilter, resort);
+        return;
+    }
 
-    if (!sorting_required_ && SetsIntersect(sort_role_ids_, roles))
+    if (refilter)
+        PrivateFilter();
+    if (resort)
         PrivateSort();
 }
 
-bool SortFilterProxyModel::lessThan(const QModelIndex& source_left, const QModelIndex& source_right) const
+void SortFilterProxyModel::OnFilterRowsChanged(const QVector<int>& source_rows)
+{
+    if (source_rows.isEmpty())
+        filter_program_.ClearCache();
+    else
+        filter_program_.InvalidateCache(source_rows);
+    RestartFilterJob();
+    // pending filtering must check the changed rows, that were rejected or accepted by the previous filter
+    if (filtering_required_ || !enabled_)
+        filter_change_ = AbstractFilter::FilterChange::ANY;
+}
+
+bool SortFilterProxyModel::LessThan(int source_left, int source_right) const
+{
+    if (!sort_roles_.empty() && source_left != source_right)
+    {
+        auto left  = sourceModel()->index(source_left, 0);
+        auto right = sourceModel()->index(source_right, 0);
+        if (sort_order_ == Qt::DescendingOrder)
+            std::swap(left, right);
+        if (IsVirtualSortFilter())
+        {
+            if (lessThan(left, right))
+                return true;
+            if (lessThan(right, left))
+                return false;
+        }
+        else
+        {
+            switch (CompareRows(left, right))
+            {
+                case AbstractFilterComparatorBase::ComparisonResult::LESS: return true;
+                case AbstractFilterComparatorBase::ComparisonResult::GREATER: return false;
+                default: break;
+            }
+        }
+    }
+    return source_left < source_right;
+}
+
+void SortFilterProxyModel::SortSourceRows(QVector<int>& source_rows) const
+{
+    SortKeys keys;
+    if (source_rows.size() > 1 && !sort_roles_.empty() && !IsVirtualSortFilter() && keys.Extract(sourceModel(), source_rows, sort_roles_, comparator_))
+        source_rows = keys.Sort(sort_order_);
+    else
+        std::sort(source_rows.begin(), source_rows.end(), [this](int left, int right) { return LessThan(left, right); });
+}
+
+AbstractFilterComparatorBase::ComparisonResult SortFilterProxyModel::CompareRows(const QModelIndex& source_left, const QModelIndex& source_right) const
 {
     for (const auto& role : sort_roles_)
     {
@@ -372,19 +1091,24 @@ bool SortFilterProxyModel::lessThan(const QModelIndex& source_left, const QModel
         switch (comparison_result)
         {
         case AbstractFilterComparatorBase::ComparisonResult::LESS:
-            return true;
         case AbstractFilterComparatorBase::ComparisonResult::GREATER:
-            return false;
+            return comparison_result;
         case AbstractFilterComparatorBase::ComparisonResult::EQUAL:
         case AbstractFilterComparatorBase::ComparisonResult::UNKNOWN:
         default:
             continue;
         }
     }
-    return false;
+    return AbstractFilterComparatorBase::ComparisonResult::EQUAL;
 }
 
-bool SortFilterProxyModel::filterAcceptsRow(int source_row, const QModelIndex& source_parent) const
+QBitArray SortFilterProxyModel::FilterAcceptsRows(const QVector<int>& source_rows) const
 {
-    return filter_ ? filter_->AcceptsRow(sourceModel()->index(source_row, 0, source_parent), filter_roles_) : true;
+    if (IsVirtualSortFilter())
+    {
+        QBitArray res(source_rows.size());
+        for (int i = 0; i < source_rows.size(); ++i) res.setBit(i, filterAcceptsRow(source_rows[i], QModelIndex()));
+        return res;
+    }
+    return filter_ ? filter_program_.Evaluate(sourceModel(), source_rows) : QBitArray(source_rows.size(), true);
 }
@@ -0,0 +1,216 @@
+#include "sort_keys.h"
+#include "abstract_comparator.h"
+#include <QFuture>
+#include <QtConcurrent>
+#include <algorithm>
+#include <numeric>
+
+using namespace om;
+
+namespace
+{
+constexpr int kMinParallelChunkSize = 16384;
+
+template <typename T, typename Less>
+void ParallelSort(std::vector<T>& values, Less less, int thread_count)
+{
+    auto chunk_count = qBound(1, thread_count, static_cast<int>(values.size() / kMinParallelChunkSize));
+    if (chunk_count <= 1)
+    {
+        std::sort(values.begin(), values.end(), less);
+        return;
+    }
+
+    std::vector<size_t> bounds;
+    for (int i = 0; i <= chunk_count; ++i) bounds.push_back(values.size() * i / chunk_count);
+
+    // waiting thread runs not started chunks itself, so it is safe to wait in a pool thread
+    QVector<QFuture<void>> futures;
+    for (int i = 0; i < chunk_count; ++i)
+        futures.push_back(QtConcurrent::run([&, i] { std::sort(values.begin() + bounds[i], values.begin() + bounds[i + 1], less); }));
+    for (auto& future : futures) future.waitForFinished();
+
+    while (bounds.size() > 2)
+    {
+        std::vector<size_t> merged_bounds;
+        futures.clear();
+        for (size_t i = 0; i + 2 < bounds.size(); i += 2)
+        {
+            merged_bounds.push_back(bounds[i]);
+            futures.push_back(QtConcurrent::run([&, i] { std::inplace_merge(values.begin() + bounds[i], values.begin() + bounds[i + 1], values.begin() + bounds[i + 2], less); }));
+        }
+        if (bounds.size() % 2 == 0)
+            merged_bounds.push_back(bounds[bounds.size() - 2]);
+        merged_bounds.push_back(bounds.back());
+        for (auto& future : futures) future.waitForFinished();
+        bounds = std::move(merged_bounds);
+    }
+}
+}  // namespace
+
+bool SortKeys::Extract(const QAbstractItemModel* model, const QVector<int>& source_rows, const RolesVector& roles, const AbstractComparator* comparator /*= nullptr*/)
+{
+    Clear();
+    if (!model || roles.empty())
+        return false;
+
+    source_rows_ = source_rows;
+    for (const auto& role : roles)
+    {
+        if (comparator && comparator->IsEnabled() && comparator->HasRole(role.name))
+        {
+            Clear();
+            return false;
+        }
+
+        Column column;
+        auto   type_id = static_cast<int>(QMetaType::UnknownType);
+        for (int i = 0; i < source_rows.size(); ++i)
+        {
+            auto val = model->data(model->index(source_rows[i], 0), role.id);
+            if (i == 0)
+            {
+                type_id = val.userType();
+                if (!GetColumnType(type_id, column.type))
+                {
+                    Clear();
+                    return false;
+                }
+            }
+            else if (val.userType() != type_id)
+            {
+                // values of different types are compared with conversion
+                Clear();
+                return false;
+            }
+
+            switch (column.type)
+            {
+                case INT_COLUMN: column.ints.push_back(val.toLongLong()); break;
+                case DOUBLE_COLUMN: column.doubles.push_back(val.toDouble()); break;
+                case STRING_COLUMN: column.strings.push_back(val.toString()); break;
+            }
+        }
+        columns_.push_back(std::move(column));
+    }
+
+    Pack();
+    return true;
+}
+
+void SortKeys::Clear()
+{
+    source_rows_.clear();
+    columns_.clear();
+    packed_keys_.clear();
+}
+
+QVector<int> SortKeys::Sort(Qt::SortOrder order, int thread_count /*= 1*/) const
+{
+    QVector<int> res;
+    res.reserve(source_rows_.size());
+
+    if (IsPacked())
+    {
+        // inverted keys give descending order, rows are still ascending
+        std::vector<std::pair<quint64, int>> keys(source_rows_.size());
+        for (int i = 0; i < source_rows_.size(); ++i) keys[i] = { order == Qt::AscendingOrder ? packed_keys_[i] : ~packed_keys_[i], source_rows_[i] };
+        ParallelSort(keys, std::less<std::pair<quint64, int>>(), thread_count);
+        for (const auto& key : keys) res.push_back(key.second);
+        return res;
+    }
+
+    std::vector<int> indexes(source_rows_.size());
+    std::iota(indexes.begin(), indexes.end(), 0);
+    ParallelSort(
+        indexes,
+        [&](int left, int right) {
+            auto comparison_result = Compare(left, right);
+            if (comparison_result != 0)
+                return order == Qt::AscendingOrder ? comparison_result < 0 : comparison_result > 0;
+            return source_rows_[left] < source_rows_[right];
+        },
+        thread_count);
+    for (auto index : indexes) res.push_back(source_rows_[index]);
+    return res;
+}
+
+bool SortKeys::GetColumnType(int type_id, ColumnType& type)
+{
+    // only types that DefaultVariantCompare compares by value
+    switch (type_id)
+    {
+        case QMetaType::Bool:
+        case QMetaType::Int:
+        case QMetaType::UInt:
+        case QMetaType::LongLong: type = INT_COLUMN; return true;
+        case QMetaType::Float:
+        case QMetaType::Double: type = DOUBLE_COLUMN; return true;
+        case QMetaType::QString: type = STRING_COLUMN; return true;
+        default: return false;
+    }
+}
+
+bool SortKeys::Pack()
+{
+    packed_keys_.clear();
+    if (columns_.empty() || source_rows_.isEmpty())
+        return false;
+
+    std::vector<qint64> mins;
+    std::vector<int>    bits;
+    int                 total_bits = 0;
+    for (const auto& column : columns_)
+    {
+        if (column.type != INT_COLUMN)
+            return false;
+        auto min_max = std::minmax_element(column.ints.begin(), column.ints.end());
+        auto range   = static_cast<quint64>(*min_max.second) - static_cast<quint64>(*min_max.first);
+        int  width   = 0;
+        while (width < 64 && (range >> width) != 0) ++width;
+        mins.push_back(*min_max.first);
+        bits.push_back(width);
+        total_bits += width;
+    }
+    if (total_bits > 64)
+        return false;
+
+    // first role is the most significant part of the key
+    packed_keys_.assign(source_rows_.size(), 0);
+    for (int i = 0; i < source_rows_.size(); ++i)
+    {
+        quint64 key = 0;
+        for (size_t c = 0; c < columns_.size(); ++c)
+        {
+            auto part = static_cast<quint64>(columns_[c].ints[i]) - static_cast<quint64>(mins[c]);
+            key       = bits[c] < 64 ? (key << bits[c]) | part : part;
+        }
+        packed_keys_[i] = key;
+    }
+    return true;
+}
+
+int SortKeys::Compare(int left, int right) const
+{
+    for (const auto& column : columns_)
+    {
+        switch (column.type)
+        {
+            case INT_COLUMN:
+                if (column.ints[left] != column.ints[right])
+                    return column.ints[left] < column.ints[right] ? -1 : 1;
+                break;
+            case DOUBLE_COLUMN:
+                if (column.doubles[left] < column.doubles[right])
+                    return -1;
+                if (column.doubles[right] < column.doubles[left])
+                    return 1;
+                break;
+            case STRING_COLUMN:
+                if (auto res = QString::compare(column.strings[left], column.strings[right]); res != 0)
+                    return res < 0 ? -1 : 1;
+                break;
+        }
+    }
+    return 0;
+}
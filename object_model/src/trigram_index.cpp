@@ -0,0 +1,152 @@
+#include "trigram_index.h"
+#include <QElapsedTimer>
+#include <algorithm>
+#include <iterator>
+
+using namespace om;
+
+void TrigramIndex::Insert(QObject* item, const QString& val)
+{
+    if (!item)
+        return;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    auto folded = val.toCaseFolded();
+    auto slot   = slots_.value(item, -1);
+    if (slot >= 0)
+    {
+        auto& entry = entries_[slot];
+        if (entry.folded == folded)
+            return;
+
+        // обновляются только списки триграмм, которые появились или исчезли
+        auto old_trigrams = GetTrigrams(entry.folded);
+        auto new_trigrams = GetTrigrams(folded);
+        std::vector<Trigram> removed, added;
+        std::set_difference(old_trigrams.begin(), old_trigrams.end(), new_trigrams.begin(), new_trigrams.end(), std::back_inserter(removed));
+        std::set_difference(new_trigrams.begin(), new_trigrams.end(), old_trigrams.begin(), old_trigrams.end(), std::back_inserter(added));
+        RemovePostings(slot, removed);
+        AddPostings(slot, added);
+        entry.folded = std::move(folded);
+    }
+    else
+    {
+        if (free_slots_.empty())
+        {
+            slot = entries_.size();
+            entries_.emplace_back();
+        }
+        else
+        {
+            slot = free_slots_.back();
+            free_slots_.pop_back();
+        }
+        AddPostings(slot, GetTrigrams(folded));
+        entries_[slot] = { item, std::move(folded) };
+        slots_.insert(item, slot);
+    }
+    build_time_ += timer.nsecsElapsed();
+}
+
+void TrigramIndex::Remove(QObject* item)
+{
+    auto slot = slots_.find(item);
+    if (slot == slots_.end())
+        return;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    auto& entry = entries_[slot.value()];
+    RemovePostings(slot.value(), GetTrigrams(entry.folded));
+    entry = Entry();
+    free_slots_.push_back(slot.value());
+    slots_.erase(slot);
+    build_time_ += timer.nsecsElapsed();
+}
+
+void TrigramIndex::Clear()
+{
+    postings_.clear();
+    slots_.clear();
+    entries_.clear();
+    free_slots_.clear();
+    build_time_ = 0;
+}
+
+bool TrigramIndex::Find(const QString& text, QVector<QObject*>& items) const
+{
+    if (text.size() < kTrigramSize)
+        return false;
+
+    // пересечение начинается с самого короткого списка
+    std::vector<const Postings*> postings;
+    for (auto trigram : GetTrigrams(text.toCaseFolded()))
+    {
+        auto it = postings_.find(trigram);
+        if (it == postings_.end())
+            return true;
+        postings.push_back(&it.value());
+    }
+    std::sort(postings.begin(), postings.end(), [](const Postings* left, const Postings* right) { return left->size() < right->size(); });
+
+    std::vector<int> slots(postings.front()->begin(), postings.front()->end());
+    std::vector<int> intersection;
+    for (size_t i = 1; i < postings.size() && !slots.empty(); ++i)
+    {
+        intersection.clear();
+        std::set_intersection(slots.begin(), slots.end(), postings[i]->begin(), postings[i]->end(), std::back_inserter(intersection));
+        slots.swap(intersection);
+    }
+
+    items.reserve(items.size() + slots.size());
+    for (auto slot : slots) items.push_back(entries_[slot].item);
+    return true;
+}
+
+size_t TrigramIndex::GetMemoryUsage() const
+{
+    // узлы QHash: указатель на следующий узел, хэш, ключ и значение
+    size_t res = 0;
+    for (const auto& postings : postings_) res += 2 * sizeof(void*) + sizeof(Trigram) + sizeof(Postings) + postings.capacity() * sizeof(int);
+    res += postings_.capacity() * sizeof(void*);
+    res += slots_.size() * (3 * sizeof(void*) + sizeof(int)) + slots_.capacity() * sizeof(void*);
+    res += entries_.capacity() * sizeof(Entry) + free_slots_.capacity() * sizeof(int);
+    for (const auto& entry : entries_) res += entry.folded.capacity() * sizeof(QChar);
+    return res;
+}
+
+std::vector<TrigramIndex::Trigram> TrigramIndex::GetTrigrams(const QString& folded)
+{
+    std::vector<Trigram> res;
+    if (folded.size() < kTrigramSize)
+        return res;
+
+    res.reserve(folded.size() - kTrigramSize + 1);
+    const auto data = reinterpret_cast<const ushort*>(folded.constData());
+    for (int i = 0; i + kTrigramSize <= folded.size(); ++i)
+        res.push_back(Trigram(data[i]) << 32 | Trigram(data[i + 1]) << 16 | Trigram(data[i + 2]));
+    std::sort(res.begin(), res.end());
+    res.erase(std::unique(res.begin(), res.end()), res.end());
+    return res;
+}
+
+void TrigramIndex::AddPostings(int slot, const std::vector<Trigram>& trigrams)
+{
+    for (auto trigram : trigrams) postings_[trigram].insert(slot);
+}
+
+void TrigramIndex::RemovePostings(int slot, const std::vector<Trigram>& trigrams)
+{
+    for (auto trigram : trigrams)
+    {
+        auto postings = postings_.find(trigram);
+        if (postings == postings_.end())
+            continue;
+        postings->erase(slot);
+        if (postings->empty())
+            postings_.erase(postings);
+    }
+}
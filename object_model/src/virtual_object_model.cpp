@@ -0,0 +1,298 @@
+#include "virtual_object_model.h"
+#include <QDebug>
+#include <QSet>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace om;
+
+const int VirtualObjectModel::kDefaultMaxItems = 256;
+
+VirtualObjectModel::VirtualObjectModel(const QMetaObject& meta_object, QObject* parent /*= nullptr*/) : AbstractObjectModel(meta_object, parent)
+{
+    UpdatePlainRoles();
+    connect(this, &VirtualObjectModel::initialized, this, &VirtualObjectModel::UpdatePlainRoles);
+}
+
+VirtualObjectModel::~VirtualObjectModel()
+{
+    for (int row = 0; row < items_.size(); ++row) DeleteItem(row);
+}
+
+int VirtualObjectModel::rowCount(const QModelIndex&) const
+{
+    return items_.size();
+}
+
+int VirtualObjectModel::GetMaxItems() const
+{
+    return max_items_;
+}
+
+void VirtualObjectModel::SetMaxItems(int val)
+{
+    if (max_items_ == val)
+        return;
+    max_items_ = val;
+    EnqueueTrim();
+    emit maxItemsChanged();
+}
+
+int VirtualObjectModel::GetItemsCount() const
+{
+    return items_access_.size();
+}
+
+bool VirtualObjectModel::HasItem(int row) const
+{
+    return GetItem(row) != nullptr;
+}
+
+// Data
+QVariant VirtualObjectModel::GetData(int row, int role) const
+{
+    if (!IsInitialized() || row < 0 || row >= items_.size())
+        return QVariant();
+    if (!items_[row] && IsPlainRole(role))
+        return meta_data_->GetRoleInfo(role)->ReadFromRoot(GetRowReader(row));
+
+    GetOrCreateItem(row);
+    return AbstractObjectModel::GetData(row, role);
+}
+
+bool VirtualObjectModel::SetData(int row, const QVariant& value, int role)
+{
+    if (!IsInitialized() || row < 0 || row >= items_.size())
+        return false;
+
+    GetOrCreateItem(row);
+    return AbstractObjectModel::SetData(row, value, role);
+}
+
+bool VirtualObjectModel::ReadData(int row, int role, int type_id, void* out) const
+{
+    if (!IsInitialized() || row < 0 || row >= items_.size())
+        return false;
+    if (!items_[row] && IsPlainRole(role))
+    {
+        auto info = meta_data_->GetRoleInfo(role);
+        if (info->property.userType() == type_id || (info->property.isEnumType() && type_id == QMetaType::Int))
+            return info->ReadFromRoot(GetRowReader(row), out);
+        return ListModelAccess::ReadData(row, role, type_id, out);
+    }
+
+    GetOrCreateItem(row);
+    return AbstractObjectModel::ReadData(row, role, type_id, out);
+}
+
+int VirtualObjectModel::ReadColumnData(int role, int first, int count, int type_id, void* out, size_t value_size) const
+{
+    if (!IsInitialized() || first < 0 || count <= 0)
+        return 0;
+    // row by row, so only rows with objects are read from them
+    return ListModelAccess::ReadColumnData(role, first, qMin(count, rowCount() - first), type_id, out, value_size);
+}
+
+bool VirtualObjectModel::IsPlainRole(int role) const
+{
+    auto index = role - kItemRole;
+    return index > 0 && index < static_cast<int>(plain_roles_.size()) && plain_roles_[index];
+}
+
+void VirtualObjectModel::UpdatePlainRoles()
+{
+    meta_data_ = ObjectMetaData::GetMetaData(ItemMetaObject());
+    plain_roles_.assign(meta_data_ ? meta_data_->GetRoleInfos().size() : 0, false);
+    if (!meta_data_)
+        return;
+
+    // own properties of the item, that don't need nested objects
+    for (const auto& info : meta_data_->GetRoleInfos())
+        plain_roles_[info->id - kItemRole] = info->parent && !info->parent->parent && !info->meta_object && !info->inherited && !info->IsSignal();
+}
+
+// Items
+QObject* VirtualObjectModel::At(int row) const
+{
+    return GetOrCreateItem(row);
+}
+
+QObject* VirtualObjectModel::First() const
+{
+    return At(0);
+}
+
+QObject* VirtualObjectModel::Last() const
+{
+    return At(rowCount() - 1);
+}
+
+QObject* VirtualObjectModel::GetItem(int row) const
+{
+    return row >= 0 && row < items_.size() ? items_[row] : nullptr;
+}
+
+int VirtualObjectModel::GetItemRow(QObject* item) const
+{
+    if (!item)
+        return -1;
+    if (item_rows_valid_ < items_.size())
+    {
+        for (int row = item_rows_valid_; row < items_.size(); ++row)
+            if (items_[row])
+                item_rows_.insert(items_[row], row);
+        item_rows_valid_ = items_.size();
+    }
+
+    auto row = item_rows_.value(item, -1);
+    return row >= 0 && row < items_.size() && items_[row] == item ? row : -1;
+}
+
+bool VirtualObjectModel::SetItem(int, QObject*)
+{
+    // rows are changed through the data
+    return false;
+}
+
+bool VirtualObjectModel::IsItemIdle(QObject*) const
+{
+    return true;
+}
+
+QObject* VirtualObjectModel::GetOrCreateItem(int row) const
+{
+    if (row < 0 || row >= items_.size())
+        return nullptr;
+
+    auto item = items_[row];
+    if (!item)
+    {
+        // objects are the cache of the rows data, so they are created in const methods too
+        auto self = const_cast<VirtualObjectModel*>(this);
+        item      = CreateItem(row);
+        if (!item)
+            throw std::logic_error("Can not create instance of object");
+        item->setParent(self);
+        items_[row] = item;
+        items_access_.insert(item, 0);
+        if (row < item_rows_valid_)
+            item_rows_.insert(item, row);
+        self->InstallItem(row);
+        EnqueueTrim();
+    }
+    items_access_[item] = ++access_counter_;
+    return item;
+}
+
+void VirtualObjectModel::DeleteItem(int row)
+{
+    auto item = items_[row];
+    if (!item)
+        return;
+    UninstallItem(row);
+    items_[row] = nullptr;
+    items_access_.remove(item);
+    item_rows_.remove(item);
+    delete item;
+}
+
+void VirtualObjectModel::ItemAboutToBeDeleted(QObject* item)
+{
+    auto row = GetItemRow(item);
+    if (row < 0)
+        return;
+    UninstallItem(row);
+    items_[row] = nullptr;
+    items_access_.remove(item);
+    item_rows_.remove(item);
+}
+
+void VirtualObjectModel::ReleaseItems()
+{
+    for (int row = 0; row < items_.size(); ++row)
+        if (items_[row] && IsItemIdle(items_[row]))
+            DeleteItem(row);
+}
+
+void VirtualObjectModel::EnqueueTrim() const
+{
+    if (trim_queued_ || max_items_ < 0 || items_access_.size() <= max_items_)
+        return;
+    // objects, returned by At, stay valid until the return to the event loop
+    trim_queued_ = true;
+    auto self    = const_cast<VirtualObjectModel*>(this);
+    QMetaObject::invokeMethod(self, [self] { self->Trim(); }, Qt::QueuedConnection);
+}
+
+void VirtualObjectModel::Trim()
+{
+    trim_queued_ = false;
+    if (max_items_ < 0 || items_access_.size() <= max_items_)
+        return;
+
+    // least recently used first
+    std::vector<std::pair<quint64, QObject*>> items;
+    items.reserve(items_access_.size());
+    for (auto item = items_access_.begin(); item != items_access_.end(); ++item) items.emplace_back(item.value(), item.key());
+    std::sort(items.begin(), items.end());
+
+    QSet<QObject*> released;
+    auto           excess = items_access_.size() - max_items_;
+    for (const auto& item : items)
+    {
+        if (released.size() == excess)
+            break;
+        if (IsItemIdle(item.second))
+            released.insert(item.second);
+    }
+
+    for (int row = 0; row < items_.size() && !released.isEmpty(); ++row)
+        if (items_[row] && released.remove(items_[row]))
+            DeleteItem(row);
+}
+
+// Rows
+void VirtualObjectModel::InsertDataRows(int row, int count, const std::function<void()>& change_data)
+{
+    if (count <= 0 || row < 0 || row > items_.size())
+        return;
+
+    beginInsertRows(QModelIndex(), row, row + count - 1);
+    if (change_data)
+        change_data();
+    items_.insert(row, count, nullptr);
+    item_rows_valid_ = qMin(item_rows_valid_, row);
+    // meta data is reset, when model becomes empty
+    if (!IsInitialized())
+        InitializeMetaObject(ItemMetaObject());
+    endInsertRows();
+}
+
+void VirtualObjectModel::RemoveDataRows(int row, int count, const std::function<void()>& change_data)
+{
+    if (count <= 0 || row < 0 || row + count > items_.size())
+        return;
+
+    beginRemoveRows(QModelIndex(), row, row + count - 1);
+    // objects don't read their data, when they are deleted
+    for (int i = row; i < row + count; ++i) DeleteItem(i);
+    items_.remove(row, count);
+    item_rows_valid_ = qMin(item_rows_valid_, row);
+    if (change_data)
+        change_data();
+    endRemoveRows();
+}
+
+void VirtualObjectModel::ResetDataRows(int count, const std::function<void()>& change_data)
+{
+    beginResetModel();
+    for (int row = 0; row < items_.size(); ++row) DeleteItem(row);
+    if (change_data)
+        change_data();
+    items_.fill(nullptr, count);
+    item_rows_.clear();
+    item_rows_valid_ = 0;
+    if (count && !IsInitialized())
+        InitializeMetaObject(ItemMetaObject());
+    endResetModel();
+}
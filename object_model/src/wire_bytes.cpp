@@ -0,0 +1,112 @@
+#include "wire_bytes.h"
+#include <cstring>
+
+using namespace om;
+
+namespace
+{
+enum WireType { VARINT = 0, FIXED64 = 1, LENGTH_DELIMITED = 2, START_GROUP = 3, END_GROUP = 4, FIXED32 = 5 };
+
+bool ReadVarint(const uchar*& data, const uchar* end, quint64& val)
+{
+    val = 0;
+    for (int shift = 0; shift < 64 && data < end; shift += 7)
+    {
+        auto byte = *data++;
+        val |= quint64(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+// Пропускает значение поля. Группы пропускаются до своего конца с тем же номером
+bool SkipValue(const uchar*& data, const uchar* end, quint64 tag)
+{
+    quint64 val = 0;
+    switch (tag & 0x7)
+    {
+        case VARINT: return ReadVarint(data, end, val);
+        case FIXED64:
+            if (end - data < 8)
+                return false;
+            data += 8;
+            return true;
+        case LENGTH_DELIMITED:
+            if (!ReadVarint(data, end, val) || val > quint64(end - data))
+                return false;
+            data += val;
+            return true;
+        case START_GROUP:
+            for (;;)
+            {
+                quint64 field_tag = 0;
+                if (!ReadVarint(data, end, field_tag))
+                    return false;
+                if ((field_tag & 0x7) == END_GROUP)
+                    return field_tag >> 3 == tag >> 3;
+                if (!SkipValue(data, end, field_tag))
+                    return false;
+            }
+        case FIXED32:
+            if (end - data < 4)
+                return false;
+            data += 4;
+            return true;
+        default: return false;
+    }
+}
+
+// Вызывает function(value, size) для каждого значения поля с номером number в порядке следования. Возвращает false для испорченных байтов
+template <typename Function>
+bool ForEachValue(const char* bytes, int size, int number, Function function)
+{
+    auto data = reinterpret_cast<const uchar*>(bytes);
+    auto end  = data + size;
+    while (data < end)
+    {
+        quint64 tag = 0;
+        if (!ReadVarint(data, end, tag))
+            return false;
+        if (tag >> 3 == quint64(number) && (tag & 0x7) == LENGTH_DELIMITED)
+        {
+            quint64 length = 0;
+            if (!ReadVarint(data, end, length) || length > quint64(end - data))
+                return false;
+            function(reinterpret_cast<const char*>(data), static_cast<int>(length));
+            data += length;
+        }
+        else if (!SkipValue(data, end, tag))
+            return false;
+    }
+    return true;
+}
+}  // namespace
+
+bool WireBytes::IsSame(const WireBytes& other) const
+{
+    return IsValid() && size_ == other.size_ && (data_ == other.data_ || std::memcmp(data_, other.data_, size_) == 0);
+}
+
+WireBytes WireBytes::GetField(int number) const
+{
+    if (!IsValid())
+        return WireBytes();
+
+    // значения, встреченные несколько раз, объединяются при разборе, поэтому байты одного из них не описывают сообщение
+    WireBytes res;
+    int       count = 0;
+    auto      valid = ForEachValue(data_, size_, number, [&res, &count](const char* data, int size) {
+        res = WireBytes(data, size);
+        ++count;
+    });
+    return valid && count == 1 ? res : WireBytes();
+}
+
+std::vector<WireBytes> WireBytes::GetFields(int number) const
+{
+    std::vector<WireBytes> res;
+    if (IsValid() && !ForEachValue(data_, size_, number, [&res](const char* data, int size) { res.emplace_back(data, size); }))
+        res.clear();
+    return res;
+}
@@ -0,0 +1,108 @@
+﻿#include <gui/object_model/async_applier.h>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QThread>
+#include <QThreadPool>
+#include <atomic>
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+using namespace om;
+
+class AsyncApplierF : public ::testing::Test
+{
+public:
+    void SetUp() override
+    {
+        int   args = 1;
+        char* argv = "";
+        app_       = std::make_unique<QCoreApplication>(args, &argv);
+    }
+
+    void TearDown() override
+    {
+        QThreadPool::globalInstance()->waitForDone();
+        app_.reset();
+    }
+
+protected:
+    void WaitApplied(const AsyncApplier& applier)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        while (applier.IsRunning() && timer.elapsed() < 5000) QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    }
+
+    std::unique_ptr<QCoreApplication> app_;
+};
+
+TEST_F(AsyncApplierF, LastResultApplied)
+{
+    // вторая задача выполняется, пока первая ждет ее
+    QThreadPool pool;
+    pool.setMaxThreadCount(2);
+    QObject          object;
+    AsyncApplier     applier(&object);
+    std::vector<int> applied;
+    std::atomic_bool release_first{ false };
+    applier.SetThreadPool(&pool);
+
+    // первая задача завершается после второй, но ее результат устарел
+    applier.Start([&]() -> AsyncApplier::Apply {
+        while (!release_first) QThread::msleep(1);
+        return [&] { applied.push_back(1); };
+    });
+    applier.Start([&]() -> AsyncApplier::Apply {
+        release_first = true;
+        return [&] { applied.push_back(2); };
+    });
+    EXPECT_TRUE(applier.IsRunning());
+    WaitApplied(applier);
+    pool.waitForDone();
+    QCoreApplication::processEvents();
+
+    EXPECT_FALSE(applier.IsRunning());
+    EXPECT_EQ(applied, std::vector<int>({ 2 }));
+    EXPECT_EQ(applier.GetAppliedCount(), 1u);
+    EXPECT_EQ(applier.GetDroppedCount(), 1u);
+}
+
+TEST_F(AsyncApplierF, EmptyResultAndCancel)
+{
+    QObject      object;
+    AsyncApplier applier(&object);
+    int          applied = 0;
+
+    applier.Start([]() -> AsyncApplier::Apply { return {}; });
+    WaitApplied(applier);
+    EXPECT_FALSE(applier.IsRunning());
+    EXPECT_EQ(applier.GetDroppedCount(), 1u);
+
+    applier.Start([&]() -> AsyncApplier::Apply { return [&] { ++applied; }; });
+    applier.Cancel();
+    EXPECT_FALSE(applier.IsRunning());
+    QThreadPool::globalInstance()->waitForDone();
+    QCoreApplication::processEvents();
+    EXPECT_EQ(applied, 0);
+}
+
+TEST_F(AsyncApplierF, DeletedObject)
+{
+    std::atomic_bool release{ false };
+    int              applied = 0;
+    {
+        QObject      object;
+        AsyncApplier applier(&object);
+        applier.Start([&]() -> AsyncApplier::Apply {
+            while (!release) QThread::msleep(1);
+            return [&] { ++applied; };
+        });
+    }
+    // задача завершается после удаления объекта, ее результат отбрасывается
+    release = true;
+    QThreadPool::globalInstance()->waitForDone();
+    QCoreApplication::processEvents();
+    EXPECT_EQ(applied, 0);
+}
@@ -0,0 +1,170 @@
+﻿#include <gui/object_model/change_dispatcher.h>
+#include <QCoreApplication>
+#include <QEvent>
+#include <QObject>
+#include <QPointer>
+#include <QThread>
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace om;
+
+namespace
+{
+// Объект, испускающий changed() через диспетчер, как сгенерированные объекты
+class DispatchedObject : public QObject
+{
+public:
+    DispatchedObject(std::vector<QObject*>* flushed, QObject* parent = nullptr) : QObject(parent), flushed_(flushed)
+    {
+        // родитель изменяется вместе с дочерними объектами
+        if (auto dispatched_parent = dynamic_cast<DispatchedObject*>(parent))
+            child_of_ = dispatched_parent;
+    }
+
+    void EmitChanged()
+    {
+        if (changed_queued_)
+            return;
+        changed_queued_ = true;
+        entry_.Enqueue();
+    }
+
+    int changed_count = 0;
+
+protected:
+    bool event(QEvent* event) override
+    {
+        if (event->type() == QEvent::ThreadChange)
+            entry_.OnThreadChange();
+        return QObject::event(event);
+    }
+
+private:
+    static void Flush(QObject* object)
+    {
+        auto self = static_cast<DispatchedObject*>(object);
+        self->changed_queued_ = false;
+        ++self->changed_count;
+        self->flushed_->push_back(self);
+        if (self->child_of_)
+            self->child_of_->EmitChanged();
+    }
+
+    std::vector<QObject*>*  flushed_;
+    DispatchedObject*       child_of_       = nullptr;
+    bool                    changed_queued_ = false;
+    ChangeDispatcher::Entry entry_{ this, &DispatchedObject::Flush };
+};
+}  // namespace
+
+class ChangeDispatcherF : public ::testing::Test
+{
+public:
+    void SetUp() override
+    {
+        int   args = 1;
+        char* argv = "";
+        app_       = std::make_unique<QCoreApplication>(args, &argv);
+    }
+
+    void TearDown() override
+    {
+        app_.reset();
+    }
+
+protected:
+    std::unique_ptr<QCoreApplication> app_;
+};
+
+TEST_F(ChangeDispatcherF, FlushInTreeOrder)
+{
+    std::vector<QObject*> flushed;
+    DispatchedObject      root(&flushed);
+    auto                  child      = new DispatchedObject(&flushed, &root);
+    auto                  grandchild = new DispatchedObject(&flushed, child);
+    std::vector<DispatchedObject*> leaves;
+    for (int i = 0; i < 100; ++i) leaves.push_back(new DispatchedObject(&flushed, child));
+
+    auto dispatcher = ChangeDispatcher::GetInstance();
+    auto cycle      = dispatcher->GetFlushCycle();
+    root.EmitChanged();
+    for (auto leaf : leaves) leaf->EmitChanged();
+    grandchild->EmitChanged();
+    QCoreApplication::processEvents();
+
+    // все изменения сбрасываются одним событием
+    EXPECT_EQ(dispatcher->GetFlushCycle(), cycle + 1);
+    EXPECT_EQ(dispatcher->GetLastFlushCount(), 103);
+    // родители испускают changed() один раз после всех дочерних объектов
+    EXPECT_EQ(root.changed_count, 1);
+    EXPECT_EQ(child->changed_count, 1);
+    ASSERT_EQ(flushed.size(), 103u);
+    EXPECT_EQ(flushed[101], child);
+    EXPECT_EQ(flushed[102], &root);
+}
+
+TEST_F(ChangeDispatcherF, DeleteQueuedObject)
+{
+    std::vector<QObject*> flushed;
+    DispatchedObject      first(&flushed);
+    auto                  second = new DispatchedObject(&flushed);
+    first.EmitChanged();
+    second->EmitChanged();
+    delete second;
+    QCoreApplication::processEvents();
+
+    EXPECT_EQ(ChangeDispatcher::GetInstance()->GetLastFlushCount(), 1);
+    EXPECT_EQ(flushed, std::vector<QObject*>({ &first }));
+}
+
+TEST_F(ChangeDispatcherF, ChangeInAnotherThread)
+{
+    std::vector<QObject*> flushed;
+    DispatchedObject      object(&flushed);
+    // объект изменяется в потоке без цикла событий, сигнал испускается в потоке объекта
+    std::thread([&object] { object.EmitChanged(); }).join();
+    EXPECT_EQ(object.changed_count, 0);
+    QCoreApplication::processEvents();
+    QCoreApplication::processEvents();
+
+    EXPECT_EQ(object.changed_count, 1);
+    EXPECT_EQ(flushed, std::vector<QObject*>({ &object }));
+}
+
+TEST_F(ChangeDispatcherF, MoveQueuedObjectToThread)
+{
+    // объект создается и изменяется в рабочем потоке и переносится в основной поток, как в обертках моделей
+    std::vector<QObject*>             flushed;
+    std::unique_ptr<DispatchedObject> object;
+    std::thread([&flushed, &object] {
+        object = std::make_unique<DispatchedObject>(&flushed);
+        object->EmitChanged();
+        object->moveToThread(QCoreApplication::instance()->thread());
+    }).join();
+    EXPECT_EQ(object->changed_count, 0);
+    QCoreApplication::processEvents();
+    QCoreApplication::processEvents();
+
+    EXPECT_EQ(object->changed_count, 1);
+    // флаг ожидания снят, следующее изменение тоже испускает сигнал
+    object->EmitChanged();
+    QCoreApplication::processEvents();
+    EXPECT_EQ(object->changed_count, 2);
+}
+
+TEST_F(ChangeDispatcherF, FlushOnThreadFinish)
+{
+    std::vector<QObject*>             flushed;
+    std::unique_ptr<DispatchedObject> object;
+    // поток завершается без цикла событий, оставшиеся в очереди объекты сбрасываются диспетчером потока
+    std::thread([&flushed, &object] {
+        object = std::make_unique<DispatchedObject>(&flushed);
+        object->EmitChanged();
+    }).join();
+
+    EXPECT_EQ(object->changed_count, 1);
+    EXPECT_EQ(flushed, std::vector<QObject*>({ object.get() }));
+}
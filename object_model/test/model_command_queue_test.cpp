@@ -0,0 +1,174 @@
+﻿#include "test_object.h"
+
+#include <gui/object_model/model_command_queue.h>
+#include <gui/object_model/object_model.h>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QSignalSpy>
+#include <QThread>
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace om;
+
+class ModelCommandQueueF : public ::testing::Test
+{
+public:
+    void SetUp() override
+    {
+        int   args = 1;
+        char* argv = "";
+        app_       = std::make_unique<QCoreApplication>(args, &argv);
+        model_     = std::make_unique<ObjectModel>(TestObject::staticMetaObject);
+        for (int i = 0; i < 3; ++i) model_->Append(new TestObject(i, QString::number(i)));
+        queue_ = std::make_unique<ModelCommandQueue>(model_.get());
+    }
+
+    void TearDown() override
+    {
+        queue_.reset();
+        model_.reset();
+        app_.reset();
+    }
+
+protected:
+    std::unique_ptr<QCoreApplication>  app_;
+    std::unique_ptr<ObjectModel>       model_;
+    std::unique_ptr<ModelCommandQueue> queue_;
+};
+
+TEST_F(ModelCommandQueueF, CoalesceAppendsAndSets)
+{
+    QSignalSpy rows_inserted(model_.get(), &ObjectModel::rowsInserted);
+    for (int i = 0; i < 100; ++i) queue_->PushAppend(new TestObject(10 + i, QString()));
+    QPointer<TestObject> replaced = new TestObject(1000, QString());
+    queue_->PushSet(1, replaced);
+    queue_->PushSet(1, new TestObject(1001, QString()));
+    // строка добавленного, но еще не примененного элемента
+    queue_->PushSet(3, new TestObject(1002, QString()));
+    EXPECT_EQ(queue_->GetQueueDepth(), 103);
+
+    queue_->Drain();
+    EXPECT_EQ(queue_->GetQueueDepth(), 0);
+    EXPECT_EQ(queue_->GetLastDrainCommands(), 103);
+    // один Set и один AppendVector
+    EXPECT_EQ(queue_->GetLastDrainOperations(), 2);
+    EXPECT_EQ(rows_inserted.count(), 1);
+    ASSERT_EQ(model_->rowCount(), 103);
+    EXPECT_TRUE(replaced.isNull());
+    EXPECT_EQ(static_cast<TestObject*>(model_->At(1))->GetId(), 1001);
+    EXPECT_EQ(static_cast<TestObject*>(model_->At(3))->GetId(), 1002);
+    EXPECT_EQ(static_cast<TestObject*>(model_->At(102))->GetId(), 109);
+}
+
+TEST_F(ModelCommandQueueF, RejectedByUniqueIndex)
+{
+    ASSERT_TRUE(model_->CreateIndex("id", true));
+    QPointer<TestObject> duplicate = new TestObject(1, QString());
+    queue_->PushAppend(new TestObject(10, QString()));
+    queue_->PushAppend(duplicate);
+    queue_->PushAppend(new TestObject(11, QString()));
+    queue_->Drain();
+
+    // отклоняется только повторяющийся элемент выборки, модель владеет элементами и удаляет его
+    EXPECT_TRUE(duplicate.isNull());
+    ASSERT_EQ(model_->rowCount(), 5);
+    EXPECT_EQ(static_cast<TestObject*>(model_->At(3))->GetId(), 10);
+    EXPECT_EQ(static_cast<TestObject*>(model_->At(4))->GetId(), 11);
+}
+
+TEST_F(ModelCommandQueueF, RefModelDoesNotDeleteItems)
+{
+    std::vector<std::unique_ptr<TestObject>> items;
+    for (int i = 0; i < 5; ++i) items.push_back(std::make_unique<TestObject>(i, QString()));
+    items.push_back(std::make_unique<TestObject>(2, QString()));
+
+    ObjectRefModel model(TestObject::staticMetaObject);
+    model.Append(items[0].get());
+    ASSERT_TRUE(model.CreateIndex("id", true));
+    QVector<QObject*> discarded;
+    auto              queue = std::make_unique<ModelCommandQueue>(&model);
+    QObject::connect(queue.get(), &ModelCommandQueue::itemsDiscarded, [&discarded](const QVector<QObject*>& v) { discarded += v; });
+
+    queue->PushSet(0, items[1].get());
+    queue->PushSet(0, items[2].get());
+    queue->PushAppend(items[3].get());
+    queue->PushAppend(items[5].get());
+    queue->Drain();
+
+    // замененный и отклоненный элементы не удаляются, а возвращаются вызывающему
+    EXPECT_EQ(discarded, QVector<QObject*>({ items[1].get(), items[5].get() }));
+    ASSERT_EQ(model.rowCount(), 2);
+    EXPECT_EQ(model.At(0), items[2].get());
+    EXPECT_EQ(model.At(1), items[3].get());
+
+    queue->PushAppend(items[4].get());
+    queue.reset();
+    EXPECT_EQ(model.rowCount(), 3);
+}
+
+TEST_F(ModelCommandQueueF, CommandsKeepOrder)
+{
+    auto item = new TestObject(10, QString());
+    queue_->PushAppend(item);
+    queue_->Push([](ObjectRefModel* model) { model->Remove(0); });
+    queue_->PushReplace(item, new TestObject(11, QString()));
+    queue_->PushAppend(new TestObject(12, QString()));
+    queue_->Drain();
+
+    // команда применяет накопленные добавления, замена находит строку элемента в модели
+    EXPECT_EQ(queue_->GetLastDrainOperations(), 4);
+    ASSERT_EQ(model_->rowCount(), 4);
+    EXPECT_EQ(static_cast<TestObject*>(model_->At(0))->GetId(), 1);
+    EXPECT_EQ(static_cast<TestObject*>(model_->At(2))->GetId(), 11);
+    EXPECT_EQ(static_cast<TestObject*>(model_->At(3))->GetId(), 12);
+}
+
+TEST_F(ModelCommandQueueF, ProducerThreads)
+{
+    constexpr int kThreads = 4;
+    constexpr int kItems   = 5000;
+
+    QSignalSpy               rows_inserted(model_.get(), &ObjectModel::rowsInserted);
+    std::vector<std::thread> producers;
+    for (int t = 0; t < kThreads; ++t)
+    {
+        producers.emplace_back([this, t] {
+            for (int i = 0; i < kItems; ++i)
+            {
+                auto item = new TestObject(t * kItems + i, QString());
+                item->moveToThread(model_->thread());
+                queue_->PushAppend(item);
+            }
+        });
+    }
+    for (auto& producer : producers) producer.join();
+
+    // очередь применяется таймером в цикле событий
+    QElapsedTimer timer;
+    timer.start();
+    while (model_->rowCount() < 3 + kThreads * kItems && timer.elapsed() < 5000) QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents, 100);
+
+    EXPECT_EQ(model_->rowCount(), 3 + kThreads * kItems);
+    EXPECT_EQ(queue_->GetQueueDepth(), 0);
+    EXPECT_LE(static_cast<quint64>(rows_inserted.count()), queue_->GetDrainCount());
+    EXPECT_GE(queue_->GetLastDrainTime(), 0);
+}
+
+TEST_F(ModelCommandQueueF, DeleteLaterInAnotherThread)
+{
+    QPointer<ModelCommandQueue> queue = queue_.release();
+    queue->PushAppend(new TestObject(10, QString()));
+    // другой поток не удаляет очередь сам: оставшиеся команды применяются в потоке модели
+    std::thread([queue] { queue->deleteLater(); }).join();
+    EXPECT_FALSE(queue.isNull());
+    EXPECT_EQ(model_->rowCount(), 3);
+
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+    EXPECT_TRUE(queue.isNull());
+    ASSERT_EQ(model_->rowCount(), 4);
+    EXPECT_EQ(static_cast<TestObject*>(model_->At(3))->GetId(), 10);
+}
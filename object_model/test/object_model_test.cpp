@@ -2,7 +2,9 @@
 
 #include <gui/object_model/object_model.h>
 #include <gui/object_model/object_model_qml.h>
+#include <gui/object_model/role_index.h>
 #include <QCoreApplication>
+#include <QPoint>
 #include <QPointer>
 #include <QSignalSpy>
 #include <array>
@@ -251,6 +253,23 @@ TEST_F(ObjectRefModelF, Remove)
     EXPECT_EQ(rows_removed_signal.count(), 3);
 }
 
+TEST_F(ObjectRefModelF, Move)
+{
+    QSignalSpy rows_moved_signal(model_.get(), &ObjectRefModel::rowsMoved);
+    model_->AppendVector({ objects_.begin(), objects_.end() });
+
+    model_->Move(0, 1, 2);
+    EXPECT_EQ(model_->GetItems(), QVector<QObject*>({ objects_[2], objects_[0], objects_[1] }));
+    EXPECT_EQ(rows_moved_signal.last().at(4).toInt(), 3);  // позиция вставки до перемещения
+
+    model_->Move(2, 0);
+    EXPECT_EQ(model_->GetItems(), QVector<QObject*>({ objects_[1], objects_[2], objects_[0] }));
+    EXPECT_EQ(model_->IndexOf(objects_[0]), 2);
+
+    model_->Move(1, 2, 2);
+    EXPECT_EQ(rows_moved_signal.count(), 2);
+}
+
 TEST_F(ObjectRefModelF, Clear)
 {
     QSignalSpy model_reset_signal(model_.get(), &ObjectRefModel::modelReset);
@@ -391,3 +410,238 @@ TEST_F(ObjectRefModelF, ItemDataChangedSignal)
         EXPECT_EQ(signal_params, om::Ids({ role_ids["changed"], role_ids["coord.type.changed"] }));  // должны были измениться эти роли
     }
 }
+
+TEST_F(ObjectRefModelF, CachedRoles)
+{
+    model_->AppendVector({ objects_.begin(), objects_.end() });
+    model_->SetCachedRoles(QStringList{ "id", "name", "coord.x", "coord.y" });
+    QCoreApplication::processEvents();  // прокручиваем event loop, так как в SetCachedRoles есть отложенный вызов на обновление подключений к объектам
+
+    auto memory_usage = model_->GetCachedRolesMemoryUsage();
+    EXPECT_EQ(memory_usage.keys(), QStringList({ "coord.x", "id", "name" }));  // coord.y имеет тип float и не кэшируется
+
+    {  // значения читаются из кэша и сбрасываются по сигналам изменения
+        EXPECT_EQ(model_->GetData(1, "name").toString(), "1");
+        objects_[1]->SetName("100");
+        EXPECT_EQ(model_->GetData(1, "name").toString(), "100");
+        EXPECT_EQ(model_->GetData(1, "id").toInt(), 1);
+        objects_[1]->SetId(100);
+        EXPECT_EQ(model_->GetData(1, "id").toInt(), 100);
+    }
+
+    {  // вложенные свойства сбрасываются при смене родительского объекта
+        EXPECT_EQ(model_->GetData(2, "coord.x"), QVariant());
+        objects_[2]->SetCoord(new CoordObject(42, 777, dummy_parent_.get()));
+        EXPECT_EQ(model_->GetData(2, "coord.x").toDouble(), 42);
+        objects_[2]->GetCoord()->SetX(43);
+        EXPECT_EQ(model_->GetData(2, "coord.x").toDouble(), 43);
+    }
+
+    {  // ячейки кэша перемещаются вместе со строками
+        model_->Move(0, 2);
+        EXPECT_EQ(model_->GetData(2, "id").toInt(), 0);
+        model_->Remove(0);
+        EXPECT_EQ(model_->GetData(0, "name").toString(), "2");
+        model_->Insert(0, objects_[1]);
+        EXPECT_EQ(model_->GetData(0, "name").toString(), "100");
+        EXPECT_EQ(model_->GetData(1, "name").toString(), "2");
+    }
+
+    model_->SetCachedRoles(Role::ITEM_ROLE);
+    EXPECT_TRUE(model_->GetCachedRolesMemoryUsage().isEmpty());
+    EXPECT_EQ(model_->GetData(2, "id").toInt(), 0);
+}
+
+TEST_F(ObjectRefModelF, IndexedSearch)
+{
+    EXPECT_TRUE(model_->CreateIndex("name"));
+    EXPECT_TRUE(model_->CreateIndex("objectName", true));
+    model_->AppendVector({ objects_.begin(), objects_.end() });
+    EXPECT_FALSE(model_->CreateIndex("unknownRole"));
+
+    EXPECT_EQ(model_->IndexOf("name", "2"), 2);
+    EXPECT_EQ(model_->IndexOf("objectName1"), 1);
+    EXPECT_EQ(model_->IndexOf(objects_[2]), 2);
+    EXPECT_EQ(model_->IndexOf("name", "123"), -1);
+
+    {  // индекс обновляется по сигналам изменения свойств
+        objects_[0]->SetName("2");
+        EXPECT_EQ(model_->IndexesOf("name", "2"), QVector<int>({ 0, 2 }));
+        EXPECT_EQ(model_->FindFirst("name", "2"), objects_[0]);
+        objects_[1]->setObjectName("renamed");
+        EXPECT_EQ(model_->Find("renamed"), objects_[1]);
+        EXPECT_FALSE(model_->Contains("objectName1"));
+    }
+
+    {  // индекс обновляется при изменении строк
+        model_->Move(0, 2);
+        EXPECT_EQ(model_->IndexesOf("name", "2"), QVector<int>({ 1, 2 }));
+        model_->Take(1);
+        EXPECT_EQ(model_->IndexesOf("name", "2"), QVector<int>({ 1 }));
+        EXPECT_EQ(model_->Find("name", "2"), QVector<QObject*>({ objects_[0] }));
+        model_->Insert(0, objects_[2]);
+        EXPECT_EQ(model_->IndexOf({ { "name", "2" }, { "id", 0 } }), 2);
+    }
+
+    {  // уникальный индекс не принимает повторяющиеся значения
+        TestObject duplicate(5, "5");
+        duplicate.setObjectName("renamed");
+        EXPECT_EQ(model_->Insert(0, &duplicate), nullptr);
+        EXPECT_EQ(model_->Set(0, &duplicate), nullptr);
+        model_->AppendVector({ &duplicate });
+        EXPECT_EQ(model_->rowCount(), 3);
+        EXPECT_EQ(model_->Set(model_->IndexOf(objects_[1]), &duplicate), &duplicate);
+        EXPECT_EQ(model_->Find("renamed"), &duplicate);
+        model_->Set(model_->IndexOf(&duplicate), objects_[1]);
+    }
+
+    model_->RemoveIndex("name");
+    EXPECT_FALSE(model_->HasIndex("name"));
+    EXPECT_EQ(model_->IndexesOf("name", "2"), QVector<int>({ 0, 2 }));
+}
+
+TEST(RoleIndex, NormalizedKeys)
+{
+    EXPECT_EQ(RoleIndex::GetKey(true), RoleIndex::GetKey(1));
+    EXPECT_EQ(RoleIndex::GetKey(1), RoleIndex::GetKey(1.0));
+    EXPECT_EQ(RoleIndex::GetKey(1), RoleIndex::GetKey("1"));
+    EXPECT_EQ(RoleIndex::GetKey(false), RoleIndex::GetKey("false"));
+    EXPECT_EQ(RoleIndex::GetKey(QVariantList({ 1, "a" })), RoleIndex::GetKey(QStringList({ "1", "a" })));
+    EXPECT_NE(RoleIndex::GetKey(QVariantList({ 1, 2 })), RoleIndex::GetKey(QString()));
+    EXPECT_NE(RoleIndex::GetKey(QVariantList({ 1, 2 })), RoleIndex::GetKey(QVariantList({ 2, 1 })));
+    EXPECT_NE(RoleIndex::GetKey(QPoint(1, 2)), RoleIndex::GetKey(QPoint(2, 1)));
+
+    TestObject object;
+    RoleIndex  index;
+    index.Insert(&object, true);
+    EXPECT_EQ(index.Find(1).size(), 1);
+    EXPECT_EQ(index.Find(QString("1")).size(), 1);
+    EXPECT_TRUE(index.Find(2).empty());
+}
+
+TEST_F(ObjectRefModelF, IndexedSearchMixedTypes)
+{
+    model_->AppendVector({ objects_.begin(), objects_.end() });
+    const QVector<QPair<QByteArray, QVariant>> lookups = {
+        { "id", QString("1") }, { "id", 1.0 }, { "id", 1.0000000000001 }, { "id", 1.4 }, { "id", true },
+        { "id", QString("x") }, { "id", QByteArray("2") }, { "name", 1 }, { "name", 2.0 }, { "name", QVariant() },
+    };
+
+    // индекс находит те же строки, что и перебор с QVariant::operator==
+    QVector<QVector<int>> scanned;
+    for (const auto& lookup : lookups) scanned.push_back(model_->IndexesOf(lookup.first, lookup.second));
+    EXPECT_EQ(scanned[0], QVector<int>({ 1 }));
+    EXPECT_EQ(scanned[7], QVector<int>({ 1 }));
+
+    EXPECT_TRUE(model_->CreateIndex("id"));
+    EXPECT_TRUE(model_->CreateIndex("name"));
+    for (int i = 0; i < lookups.size(); ++i)
+        EXPECT_EQ(model_->IndexesOf(lookups[i].first, lookups[i].second), scanned[i]) << i;
+}
+
+TEST_F(ObjectRefModelF, TextIndex)
+{
+    EXPECT_TRUE(model_->CreateTextIndex("objectName"));
+    model_->AppendVector({ objects_.begin(), objects_.end() });
+    EXPECT_FALSE(model_->CreateTextIndex("unknownRole"));
+    EXPECT_TRUE(model_->HasTextIndex("objectName"));
+
+    const auto   role = model_->GetRoleId("objectName");
+    QVector<int> rows;
+    EXPECT_TRUE(model_->FindTextRows(role, "NAME1", rows));
+    EXPECT_EQ(rows, QVector<int>({ 1 }));
+    rows.clear();
+    EXPECT_TRUE(model_->FindTextRows(role, "Name", rows));
+    EXPECT_EQ(rows, QVector<int>({ 0, 1, 2 }));
+    rows.clear();
+    EXPECT_TRUE(model_->FindTextRows(role, "xyz", rows));
+    EXPECT_TRUE(rows.isEmpty());
+    // короткий текст и роль без индекса ищутся перебором
+    EXPECT_FALSE(model_->FindTextRows(role, "ob", rows));
+    EXPECT_FALSE(model_->FindTextRows(model_->GetRoleId("name"), "objectName", rows));
+
+    {  // индекс обновляется по сигналам изменения свойств
+        objects_[1]->setObjectName("renamed");
+        EXPECT_TRUE(model_->FindTextRows(role, "name1", rows));
+        EXPECT_TRUE(rows.isEmpty());
+        EXPECT_TRUE(model_->FindTextRows(role, "amed", rows));
+        EXPECT_EQ(rows, QVector<int>({ 1 }));
+    }
+
+    {  // индекс обновляется при изменении строк
+        model_->Move(0, 2);
+        rows.clear();
+        EXPECT_TRUE(model_->FindTextRows(role, "name0", rows));
+        EXPECT_EQ(rows, QVector<int>({ 2 }));
+        model_->Take(0);
+        rows.clear();
+        EXPECT_TRUE(model_->FindTextRows(role, "name", rows));
+        EXPECT_EQ(rows, QVector<int>({ 0, 1 }));
+    }
+
+    auto statistics = model_->GetTextIndexStatistics("objectName");
+    EXPECT_EQ(statistics.value("items").toInt(), 2);
+    EXPECT_GT(statistics.value("trigrams").toInt(), 0);
+    EXPECT_GT(statistics.value("memoryUsage").toULongLong(), 0u);
+
+    model_->RemoveTextIndex("objectName");
+    EXPECT_FALSE(model_->HasTextIndex("objectName"));
+    EXPECT_FALSE(model_->FindTextRows(role, "name", rows));
+}
+
+TEST_F(ObjectRefModelF, RemoveAll)
+{
+    QSignalSpy rows_removed_signal(model_.get(), &ObjectRefModel::rowsRemoved);
+    QSignalSpy model_reset_signal(model_.get(), &ObjectRefModel::modelReset);
+    std::array<TestObject*, 6> objects;
+    for (int i = 0; i < objects.size(); ++i) objects[i] = new TestObject(i, QString::number(i % 2), dummy_parent_.get());
+    model_->AppendVector({ objects.begin(), objects.end() });
+
+    {  // один диапазон удаляется одним сигналом
+        model_->RemoveAllIf("name", "1", [&](QObject* item) { return item == objects[5]; });
+        EXPECT_EQ(model_->GetItems(), QVector<QObject*>({ objects[0], objects[1], objects[2], objects[3], objects[4] }));
+        EXPECT_EQ(rows_removed_signal.count(), 1);
+    }
+
+    {  // несколько диапазонов удаляются сигналом на каждый диапазон
+        model_->SetRemoveResetRatio(1);
+        model_->RemoveAll("name", "1");
+        EXPECT_EQ(model_->GetItems(), QVector<QObject*>({ objects[0], objects[2], objects[4] }));
+        EXPECT_EQ(rows_removed_signal.count(), 3);
+        EXPECT_EQ(model_reset_signal.count(), 0);
+    }
+
+    {  // при удалении большой части строк модель сбрасывается
+        model_->SetRemoveResetRatio(0.5);
+        model_->RemoveAll({ { "name", "0" } });
+        EXPECT_EQ(model_->GetItems(), QVector<QObject*>());
+        EXPECT_EQ(rows_removed_signal.count(), 4);  // единый диапазон
+        model_->AppendVector({ objects.begin(), objects.end() });
+        model_->RemoveAllIf({ { "name", "0" } }, [](QObject*) { return true; });
+        EXPECT_EQ(model_->GetItems(), QVector<QObject*>({ objects[1], objects[3], objects[5] }));
+        EXPECT_EQ(rows_removed_signal.count(), 4);
+        EXPECT_EQ(model_reset_signal.count(), 1);
+    }
+}
+
+TEST_F(ObjectRefModelF, TypedData)
+{
+    model_->AppendVector({ objects_.begin(), objects_.end() });
+    objects_[1]->SetCoord(new CoordObject(42, 777, objects_[1]));
+    const auto& role_ids = model_->roleIds();
+
+    EXPECT_EQ(model_->GetValue<QString>(1, role_ids["name"]), "1");
+    EXPECT_EQ(model_->GetValue<double>(1, role_ids["coord.x"]), 42);
+    EXPECT_EQ(model_->GetValue<double>(0, role_ids["coord.x"]), 0);  // объекта нет, значение по умолчанию
+    EXPECT_EQ(model_->GetValue<QString>(2, role_ids["id"]), "2");      // тип не совпадает, читаем через QVariant
+    EXPECT_EQ(model_->GetValue<QObject*>(2, AbstractObjectModel::kItemRole), objects_[2]);
+
+    std::array<int, 4> ids;
+    ids.fill(-1);
+    EXPECT_EQ(model_->ReadColumn(role_ids["id"], 1, 4, ids.data()), 2);  // строк всего 3
+    EXPECT_EQ(ids, (std::array<int, 4>{ 1, 2, -1, -1 }));
+
+    std::array<float, 3> ys{};
+    EXPECT_EQ(model_->ReadColumn(role_ids["coord.y"], 0, 3, ys.data()), 1);
+    EXPECT_EQ(ys[1], 777);
+}
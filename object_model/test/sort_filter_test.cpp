@@ -3,7 +3,10 @@
 #include <gui/object_model/comparator.h>
 #include <gui/object_model/comparison_filter.h>
 #include <gui/object_model/enumeration_filter.h>
+#include <gui/object_model/filter_group.h>
+#include <gui/object_model/filter_program.h>
 #include <gui/object_model/object_model.h>
+#include <gui/object_model/null_object_filter.h>
 #include <gui/object_model/object_model_qml.h>
 #include <gui/object_model/range_filter.h>
 #include <gui/object_model/regular_expression_filter.h>
@@ -11,6 +14,7 @@
 #include <QCoreApplication>
 #include <QPointer>
 #include <QSignalSpy>
+#include <algorithm>
 #include <array>
 #include <gtest/gtest.h>
 #include <log.h>
@@ -128,6 +132,39 @@ TEST_F(SortFilterModelFixture, OnItemsPropertiesChangedSort)
     EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[1], objects_[2], objects_[0] }));
 }
 
+TEST_F(SortFilterModelFixture, IncrementalUpdate)
+{
+    model_->setSourceModel(source_model_.get());
+    model_->SetSortRole("id");
+    auto filter = new ComparisonFilter(model_.get());
+    model_->SetFilter(filter);
+    filter->SetRole("id");
+    filter->SetComparisonValue(50);
+    filter->SetComparisonOperator(ComparisonFilter::ComparisonOperator::LESS);
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[0], objects_[1], objects_[2] }));
+
+    QSignalSpy layout_changed_signal(model_.get(), &SortFilterProxyModel::layoutChanged);
+    QSignalSpy rows_moved_signal(model_.get(), &SortFilterProxyModel::rowsMoved);
+    QSignalSpy rows_removed_signal(model_.get(), &SortFilterProxyModel::rowsRemoved);
+    QSignalSpy rows_inserted_signal(model_.get(), &SortFilterProxyModel::rowsInserted);
+    objects_[0]->SetId(10);
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[1], objects_[2], objects_[0] }));
+    EXPECT_EQ(rows_moved_signal.count(), 1);  // передвинули только измененную строку
+    objects_[1]->SetId(100);
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[2], objects_[0] }));
+    EXPECT_EQ(rows_removed_signal.count(), 1);
+    objects_[1]->SetId(5);
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[2], objects_[1], objects_[0] }));
+    EXPECT_EQ(rows_inserted_signal.count(), 1);
+    EXPECT_EQ(layout_changed_signal.count(), 0);
+    EXPECT_EQ(model_->MapFromSource(0), 2);
+    EXPECT_EQ(model_->MapToSource(1), 1);
+}
+
 TEST_F(SortFilterModelFixture, OnItemsChangedSort)
 {
     model_->setSourceModel(source_model_.get());
@@ -141,6 +178,108 @@ TEST_F(SortFilterModelFixture, OnItemsChangedSort)
     EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[0], objects_[2], objects_[1] }));
 }
 
+TEST_F(SortFilterModelFixture, SourceRowsMoved)
+{
+    model_->setSourceModel(source_model_.get());
+    model_->SetSortRole("coord.x");
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[0], objects_[1], objects_[2] }));
+
+    // строки с равными значениями упорядочены по строкам источника, после перемещения в источнике их порядок меняется
+    source_model_->Move(1, 0);
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[1], objects_[0], objects_[2] }));
+
+    // вставка ищет позицию двоичным поиском по упорядоченным строкам
+    auto object = new TestObject(3, "3", dummy_parent_.get());
+    object->SetCoord(new CoordObject(0, 0, object));
+    object->GetCoord()->SetType(new CoordTypeObject(CoordTypeObject::Type::Type0, object));
+    source_model_->Append(object);
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[1], objects_[0], object, objects_[2] }));
+}
+
+TEST_F(SortFilterModelFixture, SourceRowsMovedDisabled)
+{
+    model_->setSourceModel(source_model_.get());
+    model_->SetSortRole("coord.x");
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[0], objects_[1], objects_[2] }));
+
+    // перемещение в отключенной модели сортирует ее после включения
+    model_->SetEnabled(false);
+    source_model_->Move(1, 0);
+    model_->SetEnabled(true);
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[1], objects_[0], objects_[2] }));
+
+    auto object = new TestObject(3, "3", dummy_parent_.get());
+    object->SetCoord(new CoordObject(0, 0, object));
+    object->GetCoord()->SetType(new CoordTypeObject(CoordTypeObject::Type::Type0, object));
+    source_model_->Append(object);
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[1], objects_[0], object, objects_[2] }));
+}
+
+TEST_F(SortFilterModelFixture, InvalidDataChanged)
+{
+    model_->setSourceModel(source_model_.get());
+    QCoreApplication::processEvents();
+    QSignalSpy data_changed_signal(model_.get(), &SortFilterProxyModel::dataChanged);
+
+    emit source_model_->dataChanged(QModelIndex(), QModelIndex());
+    emit source_model_->dataChanged(source_model_->index(0, 0), source_model_->index(10, 0));
+    EXPECT_EQ(data_changed_signal.count(), 0);
+    EXPECT_EQ(model_->rowCount(), 3);
+
+    emit source_model_->dataChanged(source_model_->index(0, 0), source_model_->index(2, 0));
+    EXPECT_EQ(data_changed_signal.count(), 1);
+}
+
+namespace
+{
+// Подкласс, написанный для QSortFilterProxyModel
+class ReverseProxyModel : public SortFilterProxyModel
+{
+protected:
+    bool lessThan(const QModelIndex& source_left, const QModelIndex& source_right) const override
+    {
+        return source_left.data(sortRole()).toInt() > source_right.data(sortRole()).toInt();
+    }
+
+    bool filterAcceptsRow(int source_row, const QModelIndex& source_parent) const override
+    {
+        return sourceModel()->index(source_row, 0, source_parent).data(sortRole()).toInt() != 1;
+    }
+};
+}  // namespace
+
+TEST_F(SortFilterModelFixture, VirtualSortFilter)
+{
+    ReverseProxyModel proxy;
+    proxy.setSourceModel(source_model_.get());
+    proxy.setSortRole(source_model_->GetRoleId("id"));
+    QCoreApplication::processEvents();
+    EXPECT_EQ(proxy.GetSortRole(), "id");
+    EXPECT_EQ(proxy.sortRole(), source_model_->GetRoleId("id"));
+
+    auto items = [&proxy] {
+        QVector<QObject*> res;
+        for (int i = 0; i < proxy.rowCount(); ++i) res.push_back(proxy.data(proxy.index(i, 0), AbstractObjectModel::kItemRole).value<QObject*>());
+        return res;
+    };
+    EXPECT_EQ(items(), QVector<QObject*>({ objects_[2], objects_[0] }));
+
+    // измененная строка перемещается тоже через lessThan
+    objects_[0]->SetId(100);
+    QCoreApplication::processEvents();
+    EXPECT_EQ(items(), QVector<QObject*>({ objects_[0], objects_[2] }));
+
+    // роль id не является ролью фильтра, строки перефильтровываются по invalidate
+    objects_[2]->SetId(1);
+    proxy.invalidate();
+    QCoreApplication::processEvents();
+    EXPECT_EQ(items(), QVector<QObject*>({ objects_[0] }));
+}
+
 TEST_F(SortFilterModelFixture, SortOrder)
 {
     model_->setSourceModel(source_model_.get());
@@ -153,6 +292,55 @@ TEST_F(SortFilterModelFixture, SortOrder)
     EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[0], objects_[1], objects_[2] }));
 }
 
+TEST_F(SortFilterModelFixture, AsyncSort)
+{
+    model_->SetAsync(true);
+    model_->setSourceModel(source_model_.get());
+    QSignalSpy sorted_signal(model_.get(), &SortFilterProxyModel::sorted);
+    QSignalSpy layout_changed_signal(model_.get(), &SortFilterProxyModel::layoutChanged);
+    model_->SetSortRole("id");
+    model_->ChangeSortOrder();
+    QSignalSpy busy_changed_signal(model_.get(), &SortFilterProxyModel::busyChanged);
+    EXPECT_TRUE(sorted_signal.wait(5000));
+    EXPECT_FALSE(model_->IsBusy());
+    EXPECT_EQ(busy_changed_signal.count(), 2);
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[2], objects_[1], objects_[0] }));
+    EXPECT_EQ(layout_changed_signal.count(), 1);  // отсортированные строки применяются одним изменением
+
+    // строки поменялись до окончания сортировки
+    sorted_signal.clear();
+    model_->ChangeSortOrder();
+    source_model_->Take(1);
+    EXPECT_TRUE(sorted_signal.wait(5000));
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[0], objects_[2] }));
+}
+
+TEST_F(SortFilterModelFixture, AsyncFilter)
+{
+    model_->SetAsync(true);
+    model_->setSourceModel(source_model_.get());
+    auto filter = new ComparisonFilter(model_.get());
+    model_->SetFilter(filter);
+    filter->SetRole("id");
+    filter->SetComparisonValue(1);
+    filter->SetComparisonOperator(ComparisonFilter::ComparisonOperator::GREATER_OR_EQUAL);
+    QSignalSpy filtered_signal(model_.get(), &SortFilterProxyModel::filtered);
+    QSignalSpy busy_changed_signal(model_.get(), &SortFilterProxyModel::busyChanged);
+    EXPECT_TRUE(filtered_signal.wait(5000));
+    EXPECT_FALSE(model_->IsBusy());
+    EXPECT_EQ(busy_changed_signal.count(), 2);
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[1], objects_[2] }));
+
+    // строки поменялись, пока программа фильтра вычисляется в пуле потоков
+    filtered_signal.clear();
+    filter->SetComparisonOperator(ComparisonFilter::ComparisonOperator::LESS);
+    QCoreApplication::processEvents();
+    source_model_->Take(1);
+    for (int i = 0; i < 500 && (filtered_signal.isEmpty() || model_->IsBusy()); ++i) filtered_signal.wait(10);
+    EXPECT_FALSE(model_->IsBusy());
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[0] }));
+}
+
 TEST_F(SortFilterModelFixture, Comparator)
 {
     model_->setSourceModel(source_model_.get());
@@ -234,6 +422,47 @@ TEST_F(SortFilterModelFixture, EnumerationFilter)
     EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[0], objects_[2] }));
 }
 
+TEST_F(SortFilterModelFixture, EnumerationFilterToggledValues)
+{
+    model_->setSourceModel(source_model_.get());
+    auto group         = new FilterGroup(model_.get());
+    auto filter        = new EnumerationFilter(group);
+    auto string_filter = new StringEnumerationFilter(group);
+    filter->SetRole("id");
+    filter->SetValues({ 0, 1, 2 });
+    string_filter->SetRole("name");
+    string_filter->SetValues({ "0", "1", "2" });
+    group->Append(filter);
+    group->Append(string_filter);
+    model_->SetFilter(group);
+    QCoreApplication::processEvents();
+    QSignalSpy model_reset_signal(model_.get(), &SortFilterProxyModel::modelReset);
+
+    filter->RemoveValue(1);
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[0], objects_[2] }));
+    // несколько переключений до фильтрации
+    filter->AddValue(1);
+    string_filter->RemoveValue("2");
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[1], objects_[2] }));
+
+    // измененные значения переносятся в битовые карты
+    objects_[1]->SetId(5);
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[2] }));
+    filter->AddValue(5);
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[1], objects_[2] }));
+    filter->SetInverted(true);
+    QCoreApplication::processEvents();
+    EXPECT_TRUE(GetItems().isEmpty());
+    filter->RemoveValue(2);
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[2] }));
+    EXPECT_EQ(model_reset_signal.count(), 0);
+}
+
 TEST_F(SortFilterModelFixture, RangeFilter)
 {
     model_->setSourceModel(source_model_.get());
@@ -250,6 +479,57 @@ TEST_F(SortFilterModelFixture, RangeFilter)
     EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[0], objects_[1], objects_[2] }));
 }
 
+TEST_F(SortFilterModelFixture, RangeFilterMovedBounds)
+{
+    using RangeCheckType = AbstractFilterComparatorBase::RangeCheckType;
+    model_->setSourceModel(source_model_.get());
+    auto filter = new RangeFilter(model_.get());
+    model_->SetFilter(filter);
+    filter->SetRole("id");
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[1], objects_[2] }));
+    QSignalSpy model_reset_signal(model_.get(), &SortFilterProxyModel::modelReset);
+    QSignalSpy rows_removed_signal(model_.get(), &SortFilterProxyModel::rowsRemoved);
+
+    filter->SetTo(2);
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[1] }));
+    EXPECT_EQ(rows_removed_signal.count(), 1);
+    // несколько перемещений до фильтрации
+    filter->SetFrom(-1);
+    filter->SetTo(1.5);
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[0], objects_[1] }));
+
+    filter->SetRangeCheckType(RangeCheckType::OUTSIDE);
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[2] }));
+    filter->SetFrom(0.5);
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[0], objects_[2] }));
+
+    filter->SetRangeCheckType(RangeCheckType::INSIDE_OR_EQUAL);
+    filter->SetTo(2);
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[1], objects_[2] }));
+
+    filter->SetRangeCheckType(RangeCheckType::OUTSIDE_OR_EQUAL);
+    filter->SetFrom(1);
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[0], objects_[1], objects_[2] }));
+
+    // измененные значения переставляются в индексе
+    objects_[0]->SetId(5);
+    QCoreApplication::processEvents();
+    filter->SetTo(5.5);
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[1] }));
+    filter->SetTo(5);
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[0], objects_[1] }));
+    EXPECT_EQ(model_reset_signal.count(), 0);
+}
+
 TEST_F(SortFilterModelFixture, RegularExpressionFilter)
 {
     model_->setSourceModel(source_model_.get());
@@ -263,3 +543,345 @@ TEST_F(SortFilterModelFixture, RegularExpressionFilter)
     QCoreApplication::processEvents();
     EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[0], objects_[2] }));
 }
+
+namespace
+{
+// Без Q_OBJECT: класс неизвестен программе фильтра и вызывается построчно
+class OddIdFilter : public AbstractRoleFilter
+{
+public:
+    OddIdFilter(QObject* parent = nullptr) : AbstractRoleFilter(parent) { SetRole("id"); }
+
+protected:
+    bool Accepts(const QModelIndex& index, const std::pair<QByteArray, int>& role) const override { return index.data(role.second).toInt() % 2; }
+};
+}  // namespace
+
+TEST_F(SortFilterModelFixture, FilterGroup)
+{
+    model_->setSourceModel(source_model_.get());
+    auto group = new FilterGroup(model_.get());
+    group->SetLogicalOperator(AbstractFilter::LogicalOperator::OR);
+    auto comparison_filter = new ComparisonFilter(group);
+    comparison_filter->SetRole("id");
+    comparison_filter->SetComparisonValue(0);
+    auto inner_group  = new FilterGroup(group);
+    auto range_filter = new RangeFilter(inner_group);
+    range_filter->SetRole("coord.x");
+    range_filter->SetRangeCheckType(AbstractFilterComparatorBase::RangeCheckType::INSIDE_OR_EQUAL);
+    range_filter->SetFrom(1);
+    range_filter->SetTo(2);
+    auto substring_filter = new SubstringFilter(inner_group);
+    substring_filter->SetRole("objectName");
+    substring_filter->SetSubstring("NAME2");
+    inner_group->Append(range_filter);
+    inner_group->Append(substring_filter);
+    group->Append(comparison_filter);
+    group->Append(inner_group);
+    model_->SetFilter(group);
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[0], objects_[2] }));
+
+    substring_filter->SetInverted(true);
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[0] }));
+
+    // измененные строки фильтруются той же программой
+    objects_[1]->SetId(0);
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[0], objects_[1] }));
+
+    comparison_filter->SetEnabled(false);
+    QCoreApplication::processEvents();
+    EXPECT_TRUE(GetItems().isEmpty());
+
+    group->SetLogicalOperator(AbstractFilter::LogicalOperator::AND);
+    comparison_filter->SetEnabled(true);
+    substring_filter->SetInverted(false);
+    comparison_filter->SetComparisonOperator(ComparisonFilter::ComparisonOperator::GREATER);
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[2] }));
+}
+
+TEST_F(SortFilterModelFixture, FilterProgram)
+{
+    IdsMap role_ids_map;
+    auto   role_ids = source_model_->roleIds();
+    for (auto it = role_ids.begin(); it != role_ids.end(); ++it) role_ids_map[it.key()] = it.value();
+    const QVector<int> rows = { 0, 1, 2 };
+
+    FilterGroup group;
+    auto        null_object_filter = new NullObjectFilter(&group);
+    null_object_filter->SetRole("coord.type");
+    auto enumeration_filter = new StringEnumerationFilter(&group);
+    enumeration_filter->SetRoleNames({ "name", "objectName" });
+    enumeration_filter->SetLogicalOperator(AbstractFilter::LogicalOperator::OR);
+    enumeration_filter->SetValues({ "0", "objectName1" });
+    group.Append(null_object_filter);
+    group.Append(enumeration_filter);
+
+    FilterProgram program;
+    program.Compile(&group, role_ids_map);
+    EXPECT_EQ(program.GetRowCallCount(), 0);
+    auto accepted = program.Evaluate(source_model_.get(), rows);
+    EXPECT_FALSE(accepted.testBit(0));
+    EXPECT_TRUE(accepted.testBit(1));
+    EXPECT_TRUE(accepted.testBit(2));
+
+    objects_[2]->GetCoord()->SetType(nullptr);
+    accepted = program.Evaluate(source_model_.get(), rows);
+    EXPECT_FALSE(accepted.testBit(2));
+
+    // фильтр неизвестного класса вызывается построчно
+    group.Append(new OddIdFilter(&group));
+    program.Compile(&group, role_ids_map);
+    EXPECT_EQ(program.GetRowCallCount(), 1);
+    accepted = program.Evaluate(source_model_.get(), rows);
+    EXPECT_FALSE(accepted.testBit(0));
+    EXPECT_TRUE(accepted.testBit(1));
+    EXPECT_FALSE(accepted.testBit(2));
+}
+
+TEST_F(SortFilterModelFixture, SubstringFilterRefinement)
+{
+    model_->setSourceModel(source_model_.get());
+    auto filter = new SubstringFilter(model_.get());
+    model_->SetFilter(filter);
+    filter->SetRole("objectName");
+    filter->SetSubstring("NAME");
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[0], objects_[1], objects_[2] }));
+
+    filter->SetSubstring("NAME1");
+    EXPECT_EQ(filter->GetLastChange(), AbstractFilter::FilterChange::NARROWED);
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[1] }));
+
+    filter->SetSubstring("name");
+    EXPECT_EQ(filter->GetLastChange(), AbstractFilter::FilterChange::WIDENED);
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[0], objects_[1], objects_[2] }));
+
+    filter->SetSubstring("name1");
+    filter->SetCaseInsensitive(false);
+    EXPECT_EQ(filter->GetLastChange(), AbstractFilter::FilterChange::NARROWED);
+    filter->SetInverted(true);
+    filter->SetSubstring("name12");
+    EXPECT_EQ(filter->GetLastChange(), AbstractFilter::FilterChange::WIDENED);
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[0], objects_[1], objects_[2] }));
+
+    filter->SetInverted(false);
+    filter->SetCaseInsensitive(true);
+    EXPECT_EQ(filter->GetLastChange(), AbstractFilter::FilterChange::WIDENED);
+    QCoreApplication::processEvents();
+    EXPECT_TRUE(GetItems().isEmpty());
+
+    // отклоненная строка, измененная до фильтрации, проверяется, хотя фильтр сужен
+    filter->SetSubstring("name123");
+    objects_[2]->setObjectName("name123");
+    QCoreApplication::processEvents();
+    EXPECT_EQ(GetItems(), QVector<QObject*>({ objects_[2] }));
+}
+
+TEST_F(SortFilterModelFixture, RegularExpressionFilterRefinement)
+{
+    RegularExpressionFilter filter;
+    filter.SetRole("objectName");
+    filter.SetPattern("name");
+    filter.SetPattern("name1");
+    EXPECT_EQ(filter.GetLastChange(), AbstractFilter::FilterChange::NARROWED);
+    filter.SetPattern("name");
+    EXPECT_EQ(filter.GetLastChange(), AbstractFilter::FilterChange::WIDENED);
+    // шаблоны с метасимволами не сравниваются как подстроки
+    filter.SetPattern("name.");
+    EXPECT_EQ(filter.GetLastChange(), AbstractFilter::FilterChange::ANY);
+}
+
+TEST_F(SortFilterModelFixture, FilterProgramStringCache)
+{
+    IdsMap role_ids_map;
+    auto   role_ids = source_model_->roleIds();
+    for (auto it = role_ids.begin(); it != role_ids.end(); ++it) role_ids_map[it.key()] = it.value();
+    const QVector<int> rows = { 0, 1, 2 };
+
+    SubstringFilter filter;
+    filter.SetRole("objectName");
+    filter.SetSubstring("NAME2");
+    FilterProgram program;
+    program.Compile(&filter, role_ids_map);
+    auto accepted = program.Evaluate(source_model_.get(), rows);
+    EXPECT_FALSE(accepted.testBit(0));
+    EXPECT_FALSE(accepted.testBit(1));
+    EXPECT_TRUE(accepted.testBit(2));
+    EXPECT_EQ(program.GetCachedRoleCount(), 1);
+
+    // строки берутся из кэша, пока его не сбросили
+    objects_[1]->setObjectName("name2");
+    EXPECT_FALSE(program.Evaluate(source_model_.get(), rows).testBit(1));
+    program.InvalidateCache({ 1 });
+    EXPECT_TRUE(program.Evaluate(source_model_.get(), rows).testBit(1));
+
+    // кэш живет, пока в роли ищут
+    filter.SetSubstring("NAME");
+    program.Compile(&filter, role_ids_map);
+    EXPECT_EQ(program.GetCachedRoleCount(), 1);
+    RangeFilter range_filter;
+    range_filter.SetRole("id");
+    program.Compile(&range_filter, role_ids_map);
+    EXPECT_EQ(program.GetCachedRoleCount(), 0);
+}
+
+TEST_F(SortFilterModelFixture, FilterProgramMovedRanges)
+{
+    IdsMap role_ids_map;
+    auto   role_ids = source_model_->roleIds();
+    for (auto it = role_ids.begin(); it != role_ids.end(); ++it) role_ids_map[it.key()] = it.value();
+
+    RangeFilter filter;
+    filter.SetRole("id");
+    FilterProgram program;
+    program.Compile(&filter, role_ids_map);
+    QVector<int> rows;
+    EXPECT_FALSE(program.TakeChangedRows(source_model_.get(), rows));
+
+    // строки со значениями между старой и новой границей, включая их
+    filter.SetTo(1);
+    program.Compile(&filter, role_ids_map);
+    EXPECT_TRUE(program.TakeChangedRows(source_model_.get(), rows));
+    EXPECT_EQ(rows, QVector<int>({ 1, 2 }));
+    rows.clear();
+    EXPECT_TRUE(program.TakeChangedRows(source_model_.get(), rows));
+    EXPECT_TRUE(rows.isEmpty());
+
+    filter.SetFrom(-1);
+    filter.SetFrom(0.5);
+    program.Compile(&filter, role_ids_map);
+    EXPECT_TRUE(program.TakeChangedRows(source_model_.get(), rows));
+    EXPECT_EQ(rows, QVector<int>({ 0 }));
+
+    rows.clear();
+    objects_[2]->SetId(-5);
+    program.InvalidateCache({ 2 });
+    filter.SetFrom(-5);
+    program.Compile(&filter, role_ids_map);
+    EXPECT_TRUE(program.TakeChangedRows(source_model_.get(), rows));
+    EXPECT_EQ(rows, QVector<int>({ 0, 2 }));
+
+    // смена проверки меняет принадлежность всех строк
+    filter.SetRangeCheckType(AbstractFilterComparatorBase::RangeCheckType::OUTSIDE);
+    program.Compile(&filter, role_ids_map);
+    EXPECT_FALSE(program.TakeChangedRows(source_model_.get(), rows));
+}
+
+TEST_F(SortFilterModelFixture, FilterProgramValueBitmaps)
+{
+    // перечисления многих строк вычисляются по битовым картам значений так же, как по значениям строк
+    ObjectModel  model;
+    QVector<int> rows;
+    for (int i = 0; i < 1000; ++i)
+    {
+        model.Append(new TestObject(i % 7, QString::number(i % 5)));
+        rows.push_back(i);
+    }
+    const QVector<int> few_rows = { 3, 10, 17, 500, 999 };
+
+    IdsMap role_ids_map;
+    auto   role_ids = model.roleIds();
+    for (auto it = role_ids.begin(); it != role_ids.end(); ++it) role_ids_map[it.key()] = it.value();
+
+    FilterGroup group;
+    auto        filter        = new EnumerationFilter(&group);
+    auto        string_filter = new StringEnumerationFilter(&group);
+    filter->SetRole("id");
+    filter->SetValues({ 1, 3 });
+    string_filter->SetRole("name");
+    string_filter->SetValues({ "0", "4" });
+    string_filter->SetInverted(true);
+    group.Append(filter);
+    group.Append(string_filter);
+    const auto accepts = [&](int i) { return (i % 7 == 1 || i % 7 == 3) && i % 5 != 0 && i % 5 != 4; };
+
+    FilterProgram program;
+    program.Compile(&group, role_ids_map);
+    auto accepted = program.Evaluate(&model, rows);
+    for (int i = 0; i < rows.size(); ++i) EXPECT_EQ(accepted.testBit(i), accepts(i)) << i;
+    auto few_accepted = program.Evaluate(&model, few_rows);
+    for (int i = 0; i < few_rows.size(); ++i) EXPECT_EQ(few_accepted.testBit(i), accepts(few_rows[i])) << few_rows[i];
+
+    // переключение значения меняет только строки с ним
+    QVector<int> changed_rows;
+    EXPECT_FALSE(program.TakeChangedRows(&model, changed_rows));
+    filter->AddValue(6);
+    program.Compile(&group, role_ids_map);
+    EXPECT_TRUE(program.TakeChangedRows(&model, changed_rows));
+    EXPECT_EQ(changed_rows.size(), 142);
+    EXPECT_TRUE(std::all_of(changed_rows.begin(), changed_rows.end(), [](int row) { return row % 7 == 6; }));
+    changed_rows.clear();
+    string_filter->RemoveValue("4");
+    program.Compile(&group, role_ids_map);
+    EXPECT_TRUE(program.TakeChangedRows(&model, changed_rows));
+    EXPECT_EQ(changed_rows.size(), 200);
+
+    static_cast<TestObject*>(model.At(1))->SetId(2);
+    static_cast<TestObject*>(model.At(2))->SetId(3);
+    program.InvalidateCache({ 1, 2 });
+    accepted = program.Evaluate(&model, rows);
+    EXPECT_FALSE(accepted.testBit(1));
+    EXPECT_TRUE(accepted.testBit(2));
+}
+
+TEST_F(SortFilterModelFixture, FilterProgramTextIndex)
+{
+    // результаты поиска по индексу совпадают с перебором всех строк
+    ObjectModel indexed_model, model;
+    indexed_model.CreateTextIndex("name");
+    QVector<int> rows;
+    for (int i = 0; i < 1000; ++i)
+    {
+        indexed_model.Append(new TestObject(i, QString("Item%1").arg(i)));
+        model.Append(new TestObject(i, QString("Item%1").arg(i)));
+        rows.push_back(i);
+    }
+
+    IdsMap role_ids_map;
+    auto   role_ids = model.roleIds();
+    for (auto it = role_ids.begin(); it != role_ids.end(); ++it) role_ids_map[it.key()] = it.value();
+    const auto check = [&](const AbstractFilter& filter) {
+        FilterProgram indexed_program, program;
+        indexed_program.Compile(&filter, role_ids_map);
+        program.Compile(&filter, role_ids_map);
+        auto accepted = program.Evaluate(&model, rows);
+        EXPECT_EQ(indexed_program.Evaluate(&indexed_model, rows), accepted) << filter.metaObject()->className();
+        return accepted.count(true);
+    };
+
+    SubstringFilter substring_filter;
+    substring_filter.SetRole("name");
+    for (auto substring : { "ITEM12", "em99", "m1", "item", "xyz" })
+    {
+        substring_filter.SetSubstring(substring);
+        substring_filter.SetCaseInsensitive(true);
+        check(substring_filter);
+        substring_filter.SetCaseInsensitive(false);
+        check(substring_filter);
+    }
+    substring_filter.SetSubstring("em12");
+    EXPECT_EQ(check(substring_filter), 11);
+
+    RegularExpressionFilter regular_expression_filter;
+    regular_expression_filter.SetRole("name");
+    for (auto pattern : { "^Item1\\d$", "Item12?3", "tem(1|2)0", "Item\\.?5", "^Item99|0$", "Item[0-9]+7", "\\w+42" })
+    {
+        regular_expression_filter.SetPattern(pattern);
+        check(regular_expression_filter);
+    }
+    regular_expression_filter.SetPattern("Item12?3");
+    EXPECT_EQ(check(regular_expression_filter), 12);
+
+    // строки обновляются в индексе по сигналам изменения свойств
+    static_cast<TestObject*>(indexed_model.At(5))->SetName("renamed");
+    static_cast<TestObject*>(model.At(5))->SetName("renamed");
+    substring_filter.SetSubstring("name");
+    EXPECT_EQ(check(substring_filter), 1);
+}
@@ -134,6 +134,11 @@ class GeneratorQtObjectFile:
                 self.classes += printer.print_forward_class_definition(generated_model[0])
                 self.definitions += generated_model[1]
                 self.implementations += generated_model[2]
+                generated_virtual_model = generate_qt_message_virtual_model_type(message)
+                self.initialize += printer.print_qml_register_type(generated_virtual_model[0], self.package_name)
+                self.classes += printer.print_forward_class_definition(generated_virtual_model[0])
+                self.definitions += generated_virtual_model[1]
+                self.implementations += generated_virtual_model[2]
 
     def prepare(self) -> None:
         """
@@ -423,7 +428,8 @@ class GeneratorQtMessageObjectType:
                     self.message.cpp_name(),
                     self.sync_members,
                     self.sync_signals,
-                    self.check_members + self.check_signals,
+                    self.check_members,
+                    self.check_signals,
                     self.initialize,
                     self.function_implementations
             )
@@ -446,7 +452,8 @@ class GeneratorQtMessageObjectType:
             self.sync_members += printer.print_repeated_sync(field.name, field_variable_name)
         else:
             self.sync_members += printer.print_object_sync(field.name, field_variable_name)
-            self.check_members += printer.print_object_check(field.name, field_variable_name)
+            self.check_members += printer.print_object_check(field.name, field_variable_name, field.field_number,
+                                                               field.is_repeated())
 
         self.function_definitions += printer.print_getter_h(field_type_name_ptr, function_name)
         self.function_definitions += printer.print_setter_h(proto_data_lvalue, function_name)
@@ -1042,3 +1049,21 @@ def generate_qt_message_model_type(message: proto_parser.Message) -> typing.Tupl
     return (type_name,
             printer.print_object_model_class_h(type_name, data_type, message_type_name),
             printer.print_object_model_class_cpp(type_name, data_type, message_type_name))
+
+
+def generate_qt_message_virtual_model_type(message: proto_parser.Message) -> typing.Tuple[str, str, str]:
+    """
+    Генерирует тип виртуальной модели для сообщения: объекты строк создаются только по требованию
+    Args:
+        message: Protobuf сообщение
+    Returns:
+        Tuple[str, str, str]: Имя типа, определения и реализации
+    """
+    name = case_converter.to_pascal(message.class_name())
+    type_name = f"{name}VirtualModel"
+    message_type_name = f"{message.namespace_name()}{name}Object"
+    data_type = message.cpp_name()
+
+    return (type_name,
+            printer.print_object_virtual_model_class_h(type_name, data_type, message_type_name),
+            printer.print_object_virtual_model_class_cpp(type_name, data_type, message_type_name))
@@ -11,12 +11,21 @@ def read_template(filename: str) -> Template:
 
 H_FILE_TEMPLATE = Template("""#pragma once
 #include <QObject>
+#include <QIODevice>
 #include <QString>
 #include <QVector>
 #include <QVariant>
 #include <QAbstractListModel>
 #include <array>
+#include <memory>
+#include <gui/object_model/async_applier.h>
+#include <gui/object_model/change_counter.h>
+#include <gui/object_model/change_dispatcher.h>
 #include <gui/object_model/object_model.h>
+#include <gui/object_model/snapshot_file.h>
+#include <gui/object_model/virtual_object_model.h>
+#include <gui/object_model/wire_bytes.h>
+#include <google/protobuf/arena.h>
 #include <google/protobuf/util/message_differencer.h>
 
 ${includes}
@@ -48,9 +57,92 @@ CPP_FILE_TEMPLATE = Template("""#include "${name}_qt_pb.h"
 #include <QQmlEngine>
 #include <algorithm>
 #include <iterator>
+#include <limits>
+#include <numeric>
 #include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/text_format.h>
+#include <google/protobuf/util/delimited_message_util.h>
 #include <google/protobuf/util/message_differencer.h>
 
+namespace
+{
+// Размер блока, которым читаются потоки сообщений с префиксом длины
+const qint64 kDelimitedReadBlockSize = 64 * 1024;
+
+// Сериализует сообщение в data один раз для проверки всего дерева вложенных объектов. Неизвестные байты для сообщений больше 2 ГБ
+om::WireBytes SerializeWireBytes(const google::protobuf::MessageLite& message, std::string& data)
+{
+    auto size = message.ByteSizeLong();
+    if (size > static_cast<size_t>(std::numeric_limits<int>::max()))
+        return om::WireBytes();
+    data.resize(size);
+    message.SerializeWithCachedSizesToArray(reinterpret_cast<uint8_t*>(&data[0]));
+    return om::WireBytes(data.data(), static_cast<int>(size));
+}
+
+// Сериализует элементы поля в один буфер data, байты элемента i - i-й элемент результата. Пусто для данных больше 2 ГБ
+template <typename Message>
+std::vector<om::WireBytes> SerializeItemsWireBytes(const google::protobuf::RepeatedPtrField<Message>& items, std::string& data)
+{
+    size_t size = 0;
+    for (const auto& item : items)
+        size += item.ByteSizeLong();
+    if (size > static_cast<size_t>(std::numeric_limits<int>::max()))
+        return {};
+    data.resize(size);
+    std::vector<om::WireBytes> items_bytes;
+    items_bytes.reserve(items.size());
+    auto begin = reinterpret_cast<uint8_t*>(&data[0]);
+    auto pos   = begin;
+    for (const auto& item : items)
+    {
+        auto end = item.SerializeWithCachedSizesToArray(pos);
+        items_bytes.emplace_back(data.data() + (pos - begin), static_cast<int>(end - pos));
+        pos = end;
+    }
+    return items_bytes;
+}
+
+// Байты элемента row, если байты найдены для всех count сообщений, иначе неизвестные байты
+om::WireBytes GetItemBytes(const std::vector<om::WireBytes>& items_bytes, int count, int row)
+{
+    return items_bytes.size() == static_cast<size_t>(count) ? items_bytes[row] : om::WireBytes();
+}
+
+// Чтение QIODevice блоками буфера CopyingInputStreamAdaptor без промежуточной копии всех данных
+class DeviceInputStream : public google::protobuf::io::CopyingInputStream
+{
+public:
+    explicit DeviceInputStream(QIODevice* device) : device_(device) {}
+
+    int Read(void* buffer, int size) override
+    {
+        return static_cast<int>(device_->read(static_cast<char*>(buffer), size));
+    }
+
+private:
+    QIODevice* device_;
+};
+
+class DeviceOutputStream : public google::protobuf::io::CopyingOutputStream
+{
+public:
+    explicit DeviceOutputStream(QIODevice* device) : device_(device) {}
+
+    bool Write(const void* buffer, int size) override
+    {
+        return device_->write(static_cast<const char*>(buffer), size) == size;
+    }
+
+private:
+    QIODevice* device_;
+};
+}  // namespace
+
 using namespace ${namespace_name};
 
 ${implementations}
@@ -198,7 +290,7 @@ def print_object_class_h(type_name, message_type, properties, enums, function_de
 OBJECT_CLASS_CPP_TEMPLATE = read_template('object_class_template.cpp')
 
 
-def print_object_class_cpp(type_name, message_type, sync_members, sync_signals, check_members,
+def print_object_class_cpp(type_name, message_type, sync_members, sync_signals, check_members, check_values,
                            setup, function_implementations):
     return OBJECT_CLASS_CPP_TEMPLATE.substitute({
         "type_name": type_name,
@@ -206,6 +298,7 @@ def print_object_class_cpp(type_name, message_type, sync_members, sync_signals,
         "sync_members": sync_members,
         "sync_signals": sync_signals,
         "check_members": check_members,
+        "check_values": check_values,
         "setup": setup,
         "function_implementations": function_implementations
     })
@@ -441,6 +534,7 @@ def print_mutable_getter_cpp(type_name, class_name, function_name, get_val, pref
 
 SETTER_CPP_TEMPLATE = Template("""void ${class_name}::Set${function_name}(${type_name} val)
 {
+    MarkChanged(this);
 ${set_val}
 }
 
@@ -457,8 +551,8 @@ def print_setter_cpp(type_name, class_name, function_name, set_val):
 
 
 VAL_CHECK_TEMPLATE = Template("""
-    if (message_->${name}() != new_message.${name}())
-        changed_properties_[${field_index}] = true;
+    if (message.${name}() != new_message.${name}())
+        changed_properties[${field_index}] = true;
 """)
 
 
@@ -471,19 +565,21 @@ def print_val_check(name, field_index):
 
 OBJECT_CHECK_TEMPLATE = Template("""
     if (${variable_name})
-        ${variable_name}->CheckForChangedProperties(new_message.${name}());
+        ${variable_name}->CheckForChangedProperties(new_message.${name}(), bytes.${get_bytes}(${number}), new_bytes.${get_bytes}(${number}));
 """)
 
 
-def print_object_check(name, variable_name):
+def print_object_check(name, variable_name, number, repeated):
     return OBJECT_CHECK_TEMPLATE.substitute({
         "name": name,
-        "variable_name": variable_name
+        "variable_name": variable_name,
+        "number": number,
+        "get_bytes": "GetFields" if repeated else "GetField"
     })
 
 
 OPTIONAL_VAL_CHECK_TEMPLATE = Template(""" ||
-        (message_->has_${name}() && message_->${name}() != new_message.${name}())""")
+        (message.has_${name}() && message.${name}() != new_message.${name}())""")
 
 
 def print_optional_val_check(name):
@@ -493,8 +589,8 @@ def print_optional_val_check(name):
 
 
 ONE_OF_CHECK_TEMPLATE = Template("""
-    if (message_->${one_of_name}() != new_message.${one_of_name}()${one_of_values_check})
-        changed_properties_[${field_index}] = true;
+    if (message.${one_of_name}() != new_message.${one_of_name}()${one_of_values_check})
+        changed_properties[${field_index}] = true;
 """)
 
 
@@ -507,8 +603,8 @@ def print_one_of_check(one_of_name, one_of_values_check, field_index):
 
 
 OPTIONAL_CHECK_TEMPLATE = Template("""
-    if (message_->has_${name}() != new_message.has_${name}()${val_check})
-        changed_properties_[${field_index}] = true;
+    if (message.has_${name}() != new_message.has_${name}()${val_check})
+        changed_properties[${field_index}] = true;
 """)
 
 
@@ -582,7 +678,7 @@ def print_changed_connect(signal_name, type_name, variable_name, variable_type):
 
 OBJECT_SYNC_TEMPLATE = Template("""
     if (${variable_name})
-        ${variable_name}->SetProtoMessage(message_->mutable_${name}(), emit_all_signals);
+        ${variable_name}->SetProtoMessage(message_->mutable_${name}(), emit_all_signals, checked);
 """)
 
 
@@ -1072,6 +1168,28 @@ def print_object_model_class_cpp(type_name, data_type, object_type):
     })
 
 
+OBJECT_VIRTUAL_MODEL_CLASS_H_TEMPLATE = read_template('object_virtual_model_class_template.h')
+
+
+def print_object_virtual_model_class_h(type_name, data_type, object_type):
+    return OBJECT_VIRTUAL_MODEL_CLASS_H_TEMPLATE.substitute({
+        "type_name": type_name,
+        "data_type": data_type,
+        "object_type": object_type
+    })
+
+
+OBJECT_VIRTUAL_MODEL_CLASS_CPP_TEMPLATE = read_template('object_virtual_model_class_template.cpp')
+
+
+def print_object_virtual_model_class_cpp(type_name, data_type, object_type):
+    return OBJECT_VIRTUAL_MODEL_CLASS_CPP_TEMPLATE.substitute({
+        "type_name": type_name,
+        "data_type": data_type,
+        "object_type": object_type
+    })
+
+
 MODEL_GET_VAL_TEMPLATE = "data_->Get(index.row())"
 
 
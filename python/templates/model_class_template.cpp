@@ -6,6 +6,8 @@ ${type_name}::${type_name}(${repeated_field_type}<${cpp_data_type}>* data, QObje
     connect(this, &${type_name}::rowsMoved, this, &${type_name}::changed);
     connect(this, &${type_name}::modelReset, this, &${type_name}::changed);
     connect(this, &${type_name}::dataChanged, this, &${type_name}::changed);
+    // все изменения данных испускают changed сразу, вместе с ним изменение отмечается в дереве объекта
+    connect(this, &${type_name}::changed, this, [this] { MarkChanged(this); });
 
     connect(this, &${type_name}::rowsInserted, this, &${type_name}::rowCountChanged);
     connect(this, &${type_name}::rowsRemoved, this, &${type_name}::rowCountChanged);
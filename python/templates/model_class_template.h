@@ -1,7 +1,7 @@
 
 #include <memory>
 
-class ${type_name} : public QAbstractListModel
+class ${type_name} : public QAbstractListModel, public om::ChangeCounter
 {
     Q_OBJECT
 ${properties}
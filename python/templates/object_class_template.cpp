@@ -1,7 +1,7 @@
 ${type_name}::${type_name}(QObject* parent) : QObject(parent)
 {
     owns_message_ = true;
-    message_ = new ${message_type}();
+    message_ = CreateMessage();
     Setup();
 }
 
@@ -10,7 +10,7 @@ ${type_name}::${type_name}(${message_type}* message, QObject* parent) : QObject(
     if (!message)
     {
         owns_message_ = true;
-        message_ = new ${message_type}();
+        message_ = CreateMessage();
     }
     else
     {
@@ -36,7 +36,18 @@ ${type_name}::${type_name}(${message_type}&& val, QObject* parent) : QObject(par
 
 ${type_name}::~${type_name}() 
 {
-    if (owns_message_)
+    DeleteMessage();
+}
+
+${message_type}* ${type_name}::CreateMessage() const
+{
+    return google::protobuf::Arena::Create<${message_type}>(arena_.get());
+}
+
+void ${type_name}::DeleteMessage()
+{
+    // сообщения на арене освобождаются только вместе с ареной
+    if (owns_message_ && !message_->GetArena())
         delete message_;
 }
 
@@ -45,8 +56,12 @@ void ${type_name}::SyncProtoMessage()
     SyncProtoMessagePrivate(true);
 }
 
-void ${type_name}::SyncProtoMessagePrivate(bool emit_all_signals)
+void ${type_name}::SyncProtoMessagePrivate(bool emit_all_signals, bool checked)
 {
+    MarkChanged(this);
+    // вложенные модели применяют результат своей проверки, только если она сделана для этого сообщения
+    checked  = checked && checked_;
+    checked_ = false;
     EmitChangedProperties(emit_all_signals);
 ${sync_members}
 }
@@ -56,7 +71,7 @@ void ${type_name}::CheckForChangedAndSetProtoMessage(${message_type}* new_messag
     auto check_for_changed = new_message && !emit_all_signals_;
     if (check_for_changed)
         CheckForChangedProperties(*new_message);
-    SetProtoMessage(new_message, !check_for_changed);
+    SetProtoMessage(new_message, !check_for_changed, check_for_changed);
 }
 
 bool ${type_name}::EqualsTo(const ${message_type}& val) const
@@ -79,14 +94,74 @@ bool ${type_name}::ApproximatelyEquivalentTo(const ${message_type}& val) const
     return google::protobuf::util::MessageDifferencer::ApproximatelyEquivalent(Get(), val);
 }
 
-void ${type_name}::CheckForChangedProperties(const ${message_type}& new_message)
+void ${type_name}::CheckForChangedProperties(const ${message_type}& new_message, const om::WireBytes& message_bytes, const om::WireBytes& new_message_bytes)
 {
+    checked_ = false;
+    if (&new_message == message_)
+        return;
+    // байты, найденные родителем, соответствуют message_, если с ними совпадает размер, кэшированный сериализацией родителя
+    std::string serialized, new_serialized;
+    auto bytes = message_bytes.IsValid() && message_bytes.GetSize() == message_->GetCachedSize() ? message_bytes : SerializeWireBytes(*message_, serialized);
+    auto new_bytes = new_message_bytes.IsValid() ? new_message_bytes : SerializeWireBytes(new_message, new_serialized);
+    if (bytes.IsSame(new_bytes))
+        return;
 ${check_members}
+    CheckForChangedValues(*message_, new_message, changed_properties_);
+    checked_ = true;
 }
 
+void ${type_name}::CheckForChangedValues(const ${message_type}& message, const ${message_type}& new_message, ChangedProperties& changed_properties)
+{${check_values}}
+
 void ${type_name}::RevokeProtoMessageOwnership()
 {
+    // сообщение на собственной арене освобождается вместе с ней, поэтому сначала переносится в кучу
+    if (owns_message_)
+        SetArenaEnabled(false);
+    owns_message_ = false;
+}
+
+void ${type_name}::AttachProtoMessage(${message_type}* message)
+{
+    DeleteMessage();
     owns_message_ = false;
+    message_ = message;
+}
+
+bool ${type_name}::IsObserved() const
+{
+    static const auto changed_signal = QMetaMethod::fromSignal(&${type_name}::changed);
+    for (int i = staticMetaObject.methodOffset(); i < staticMetaObject.methodCount(); ++i)
+    {
+        auto method = staticMetaObject.method(i);
+        if (method.methodType() == QMetaMethod::Signal && method != changed_signal && isSignalConnected(method))
+            return true;
+    }
+    return false;
+}
+
+bool ${type_name}::IsArenaEnabled() const
+{
+    return arena_ != nullptr;
+}
+
+void ${type_name}::SetArenaEnabled(bool val)
+{
+    if (val == IsArenaEnabled())
+        return;
+    if (!owns_message_)
+        throw std::logic_error("Only the object, that owns its message, can use arena");
+
+    // старое сообщение нужно вложенным объектам до SyncProtoMessagePrivate, старая арена освобождается после
+    auto old_arena = std::move(arena_);
+    auto old_message = message_;
+    if (val)
+        arena_ = std::make_unique<google::protobuf::Arena>();
+    message_ = CreateMessage();
+    *message_ = std::move(*old_message);
+    SyncProtoMessagePrivate();
+    if (!old_message->GetArena())
+        delete old_message;
 }
 
 ${message_type}* ${type_name}::GetProtoMessage() const 
@@ -94,26 +169,26 @@ ${message_type}* ${type_name}::GetProtoMessage() const
     return message_;
 }
 
-void ${type_name}::SetProtoMessage(${message_type}* message, bool emit_all_signals)
+void ${type_name}::SetProtoMessage(${message_type}* message, bool emit_all_signals, bool checked)
 {
+    std::unique_ptr<google::protobuf::Arena> old_arena;
     if (!message)
     {
-        if (owns_message_)
-            delete message_;
+        DeleteMessage();
         owns_message_ = true;
-        message_ = new ${message_type}();
+        message_ = CreateMessage();
     }
     else if (message != message_)
     {
-        if (owns_message_)
-        {
-            delete message_;
-            owns_message_ = false;
-        }
+        DeleteMessage();
+        owns_message_ = false;
+        // на собственной арене больше нет используемых сообщений, она освобождается после синхронизации вложенных объектов
+        if (arena_ && message_->GetArena() == arena_.get())
+            old_arena = std::move(arena_);
         message_ = message;
     }
 
-    SyncProtoMessagePrivate(emit_all_signals);
+    SyncProtoMessagePrivate(emit_all_signals, checked);
 }
 
 const ${message_type}& ${type_name}::Get() const 
@@ -125,14 +200,14 @@ void ${type_name}::Set(const ${message_type}& message)
 {
     CheckForChangedProperties(message);
     *message_ = message;
-    SyncProtoMessagePrivate();
+    SyncProtoMessagePrivate(false, true);
 }
 
 void ${type_name}::Set(${message_type}&& message)
 {
     CheckForChangedProperties(message);
     *message_ = std::move(message);
-    SyncProtoMessagePrivate();
+    SyncProtoMessagePrivate(false, true);
 }
 
 void ${type_name}::Setup()
@@ -148,12 +223,7 @@ void ${type_name}::EmitChangedProperties(bool emit_all_signals)
     if (sync_signals_queued_)
         return;
     sync_signals_queued_ = true;
-    QMetaObject::invokeMethod(this, [=] {
-${sync_signals}
-        changed_properties_.fill(false);
-        emit_all_signals_ = false;
-        sync_signals_queued_ = false;
-    }, Qt::QueuedConnection);
+    dispatch_entry_.Enqueue();
 }
 
 void ${type_name}::EmitChanged()
@@ -161,15 +231,58 @@ void ${type_name}::EmitChanged()
     if (changed_signal_queued_)
         return;
     changed_signal_queued_ = true;
-    QMetaObject::invokeMethod(this, [this] {
-        emit changed();
-        changed_signal_queued_ = false;
-    }, Qt::QueuedConnection);
+    // changed, вызванный сигналами свойств, испускается тем же сбросом после них
+    if (!sync_signals_queued_)
+        dispatch_entry_.Enqueue();
+}
+
+void ${type_name}::EmitQueuedSignals(QObject* object)
+{
+    auto self = static_cast<${type_name}*>(object);
+    if (self->sync_signals_queued_)
+    {
+        self->EmitPropertiesSignals();
+        self->changed_properties_.fill(false);
+        self->emit_all_signals_ = false;
+        self->sync_signals_queued_ = false;
+    }
+    if (self->changed_signal_queued_)
+    {
+        emit self->changed();
+        self->changed_signal_queued_ = false;
+    }
+}
+
+bool ${type_name}::event(QEvent* event)
+{
+    // отложенный сброс сигналов переносится в новый поток вместе с объектом
+    if (event->type() == QEvent::ThreadChange)
+        dispatch_entry_.OnThreadChange();
+    return QObject::event(event);
+}
+
+void ${type_name}::EmitPropertiesSignals()
+{
+${sync_signals}
 }
 
 bool ${type_name}::Parse(const QByteArray& data)
 {
-    if (message_->ParseFromString(data.toStdString()))
+    if (message_->ParseFromArray(data.constData(), data.size()))
+    {
+        SyncProtoMessagePrivate(true);
+        return true;
+    }
+    return false;
+}
+
+bool ${type_name}::Parse(QIODevice* device)
+{
+    if (!device || !device->isReadable())
+        return false;
+    DeviceInputStream stream(device);
+    google::protobuf::io::CopyingInputStreamAdaptor input(&stream);
+    if (message_->ParseFromZeroCopyStream(&input))
     {
         SyncProtoMessagePrivate(true);
         return true;
@@ -179,7 +292,98 @@ bool ${type_name}::Parse(const QByteArray& data)
 
 QByteArray ${type_name}::Serialize() const
 {
-    return QByteArray::fromStdString(message_->SerializeAsString());
+    QByteArray data;
+    SerializeTo(data);
+    return data;
+}
+
+bool ${type_name}::SerializeTo(QByteArray& data) const
+{
+    // размер вычисляется один раз, сообщение пишется прямо в память массива, емкость массива переиспользуется
+    auto size = message_->ByteSizeLong();
+    if (size > static_cast<size_t>(std::numeric_limits<int>::max()))
+        return false;
+    data.resize(static_cast<int>(size));
+    message_->SerializeWithCachedSizesToArray(reinterpret_cast<uint8_t*>(data.data()));
+    return true;
+}
+
+void ${type_name}::ApplyAsync(const QByteArray& data)
+{
+    if (!async_applier_)
+        async_applier_ = std::make_unique<om::AsyncApplier>(this);
+    // message_ изменяется только в потоке объекта. Если дерево объекта не менялось после предыдущего ApplyAsync, образцом для сравнения
+    // в пуле потоков служат его сообщение и байты, иначе байты message_, сериализованные здесь. Они же кэшируют размеры для вложенных объектов
+    auto change_count = GetChangeCount();
+    auto old_message  = applied_change_count_ == change_count ? applied_message_ : nullptr;
+    auto old_data     = old_message ? applied_data_ : nullptr;
+    if (!old_data)
+    {
+        auto serialized = std::make_shared<std::string>();
+        if (SerializeWireBytes(*message_, *serialized).IsValid())
+            old_data = serialized;
+        old_message = nullptr;
+    }
+    async_applier_->Start([this, data, old_message, old_data, change_count]() -> om::AsyncApplier::Apply {
+        auto new_message = std::make_shared<${message_type}>();
+        if (!new_message->ParseFromArray(data.constData(), data.size()))
+            return {};
+        // сериализация кэширует размеры нового сообщения, его копия и байты остаются образцом для следующего ApplyAsync
+        std::shared_ptr<std::string> new_data = std::make_shared<std::string>();
+        auto new_bytes = SerializeWireBytes(*new_message, *new_data);
+        if (!new_bytes.IsValid())
+            new_data = nullptr;
+        std::shared_ptr<const ${message_type}> applied = std::make_shared<const ${message_type}>(*new_message);
+
+        om::WireBytes bytes;
+        std::shared_ptr<ChangedProperties> changed_properties;
+        ${message_type} parsed_message;
+        if (old_data && new_data && (old_message || parsed_message.ParseFromString(*old_data)))
+        {
+            bytes = om::WireBytes(old_data->data(), static_cast<int>(old_data->size()));
+            changed_properties = std::make_shared<ChangedProperties>();
+            changed_properties->fill(false);
+            CheckForChangedValues(old_message ? *old_message : parsed_message, *new_message, *changed_properties);
+        }
+        return [this, new_message, new_data, applied, old_data, bytes, new_bytes, changed_properties, change_count] {
+            // не с чем было сравнить или объект изменен во время сравнения: сообщение проверяется заново
+            if (!changed_properties || change_count != GetChangeCount())
+                Set(std::move(*new_message));
+            else
+                ApplyChecked(std::move(*new_message), *changed_properties, bytes, new_bytes);
+            applied_message_      = applied;
+            applied_data_         = new_data;
+            applied_change_count_ = GetChangeCount();
+        };
+    });
+}
+
+bool ${type_name}::IsApplyingAsync() const
+{
+    return async_applier_ && async_applier_->IsRunning();
+}
+
+void ${type_name}::ApplyChecked(${message_type}&& new_message, const ChangedProperties& changed_properties, const om::WireBytes& bytes,
+                                const om::WireBytes& new_bytes)
+{
+    if (bytes.IsSame(new_bytes))
+        return;
+    // вложенные объекты сравнивают свои части байтов, найденные без разбора
+${check_members}
+    for (size_t i = 0; i < changed_properties.size(); ++i)
+        changed_properties_[i] = changed_properties_[i] || changed_properties[i];
+    checked_ = true;
+    *message_ = std::move(new_message);
+    SyncProtoMessagePrivate(false, true);
+}
+
+bool ${type_name}::Serialize(QIODevice* device) const
+{
+    if (!device || !device->isWritable())
+        return false;
+    DeviceOutputStream stream(device);
+    google::protobuf::io::CopyingOutputStreamAdaptor output(&stream);
+    return message_->SerializeToZeroCopyStream(&output) && output.Flush();
 }
 
 bool ${type_name}::EqualsTo(${type_name} *val) const
@@ -225,7 +429,7 @@ void ${type_name}::CopyFrom(${type_name} *val)
     auto message = val->Get();
     CheckForChangedProperties(message);
     message_->CopyFrom(message);
-    SyncProtoMessagePrivate();
+    SyncProtoMessagePrivate(false, true);
 }
 
 void ${type_name}::MergeFrom(${type_name} *val)
@@ -240,6 +444,15 @@ void ${type_name}::MergeFrom(${type_name} *val)
 
 void ${type_name}::Reset()
 {
+    if (arena_ && owns_message_)
+    {
+        // вся память сообщения освобождается одним шагом вместе со старой ареной
+        auto old_arena = std::move(arena_);
+        arena_ = std::make_unique<google::protobuf::Arena>();
+        message_ = CreateMessage();
+        SyncProtoMessagePrivate(true);
+        return;
+    }
     message_->Clear();
     SyncProtoMessagePrivate(true);
 }
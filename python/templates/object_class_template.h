@@ -1,8 +1,9 @@
-class ${type_name} : public QObject
+class ${type_name} : public QObject, public om::ChangeCounter
 {
     Q_OBJECT
 ${properties}
 public:
+    using ChangedProperties = std::array<bool, ${fields_count}>;
 ${using}
 ${enums}
     Q_INVOKABLE ${type_name}(QObject* parent = nullptr);
@@ -13,8 +14,24 @@ ${enums}
 
     void SyncProtoMessage();
     void CheckForChangedAndSetProtoMessage(${message_type}* new_message);
-    void CheckForChangedProperties(const ${message_type}& new_message);
+    // Unchanged message is skipped as a whole by comparing the serialized bytes, nested objects are checked only if they differ.
+    // bytes, new_bytes - serialized old and new messages, that the parent object found in its own bytes. Unknown bytes are serialized here once
+    // for the whole tree of the nested objects, they compare their parts of them
+    void CheckForChangedProperties(const ${message_type}& new_message, const om::WireBytes& bytes = om::WireBytes(), const om::WireBytes& new_bytes = om::WireBytes());
+    // Marks the changed own properties without nested objects. Doesn't use the object, so can be called in any thread
+    static void CheckForChangedValues(const ${message_type}& message, const ${message_type}& new_message, ChangedProperties& changed_properties);
+    // The caller takes the message. Message on the own arena is moved to the heap first, so arena mode is turned off
     void RevokeProtoMessageOwnership();
+    // Points the object to the message without syncing nested objects and signals, so only its own scalar properties can be read after it.
+    // Is used by the virtual models to read rows without creating objects for them
+    void AttachProtoMessage(${message_type}* message);
+    // Notifiers of the properties are connected (by QML bindings for example). changed() is not checked, because models connect it
+    bool IsObserved() const;
+
+    // Arena mode: message and all its nested messages are allocated on the own arena, that is released in one step by Reset and destructor.
+    // Only the object, that owns its message, can use arena
+    bool IsArenaEnabled() const;
+    void SetArenaEnabled(bool val);
 
     bool EqualsTo(const ${message_type}& val) const;
     bool EquivalentTo(const ${message_type}& val) const;
@@ -22,12 +39,29 @@ ${enums}
     bool ApproximatelyEquivalentTo(const ${message_type}& val) const;
 
     ${message_type}* GetProtoMessage() const;
-    void SetProtoMessage(${message_type}* message, bool emit_all_signals = false);
+    // checked - the message was checked by CheckForChangedProperties right before (by the parent object), so nested models
+    // can use the result of their keyed check. Otherwise it is dropped
+    void SetProtoMessage(${message_type}* message, bool emit_all_signals = false, bool checked = false);
 
     const ${message_type}& Get() const;
     void Set(const ${message_type}& val);
     void Set(${message_type}&& val);
 
+    // Reads the device to the end through the protobuf zero copy stream
+    bool Parse(QIODevice* device);
+    bool Serialize(QIODevice* device) const;
+    // Serializes into the storage of data, that is reused, if it has enough capacity
+    bool SerializeTo(QByteArray& data) const;
+
+    // Parses and serializes data and compares its own properties with the message of the previous ApplyAsync in the thread pool,
+    // then nested objects compare their parts of the serialized bytes, the parsed message is set by move and signals are emitted in the object's thread.
+    // If the tree of the object is changed otherwise since the previous ApplyAsync (see ChangeCounter), the current message is serialized
+    // in the object's thread for the comparison. If it is changed while the data is compared, the whole message is checked in the object's thread.
+    // Message on the arena of the object (or of its parent) can't take the parsed one by move, so it is copied there.
+    // Only the last data is applied: results of the earlier calls, that are not set yet, are dropped. Invalid data is ignored
+    void ApplyAsync(const QByteArray& data);
+    bool IsApplyingAsync() const;
+
 ${function_definitions}
 public slots:
     void Initialize(${type_name} *val);
@@ -58,23 +92,44 @@ private slots:
 private:
     void Setup();
     void EmitChangedProperties(bool emit_all_signals = false);
-    void SyncProtoMessagePrivate(bool emit_all_signals = false);
+    void EmitPropertiesSignals();
+    static void EmitQueuedSignals(QObject* object);
+    bool event(QEvent* event) override;
+    // checked - сообщение только что проверено CheckForChangedProperties
+    void SyncProtoMessagePrivate(bool emit_all_signals = false, bool checked = false);
+    ${message_type}* CreateMessage() const;
+    void DeleteMessage();
+    // bytes, new_bytes - сериализованные старое и новое сообщения, с которыми сравнивались собственные поля
+    void ApplyChecked(${message_type}&& new_message, const ChangedProperties& changed_properties, const om::WireBytes& bytes, const om::WireBytes& new_bytes);
 
 ${private_function_definitions}
 
 mutable ${message_type}* message_ = nullptr;
 // Класс ли следит за удалением message_
 bool owns_message_ = true;
+// В режиме арены на ней создаются message_ и все вложенные сообщения
+std::unique_ptr<google::protobuf::Arena> arena_;
 // Выставляется в true когда вызывается EmitChanged() и сигнал changed добавляется в очередь на выполнение
 // Сбрасывается в false после эмита сигнала changed()
 bool changed_signal_queued_ = false;
+// Через него сигналы свойств и changed() ставятся в общую очередь потока и испускаются одним событием вместе с другими объектами
+om::ChangeDispatcher::Entry dispatch_entry_{ this, &${type_name}::EmitQueuedSignals };
 // Выставляется в true когда вызывается EmitChangedProperties() и сигналы об изменении полей добавляются в очередь на выполнение
 // Сбрасывается в false после эмита сигналов полей
 bool sync_signals_queued_ = false;
 // Отражает необходимость вызова всех сигналов класса, кроме наследованных
 bool emit_all_signals_ = false;
 // Хранит то, какие поля у message_ изменились
-std::array<bool, ${fields_count}> changed_properties_;
+ChangedProperties changed_properties_;
+// Вложенные объекты проверены последним CheckForChangedProperties, сбрасывается синхронизацией
+bool checked_ = false;
+// Сообщение, примененное последним ApplyAsync, его байты и счетчик изменений дерева после него.
+// Неизменяемы, поэтому читаются в пуле потоков без копирования
+std::shared_ptr<const ${message_type}> applied_message_;
+std::shared_ptr<const std::string> applied_data_;
+quint64 applied_change_count_ = 0;
+// Создается первым ApplyAsync
+std::unique_ptr<om::AsyncApplier> async_applier_;
 
 ${members}
 };
\ No newline at end of file
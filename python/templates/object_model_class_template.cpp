@@ -46,7 +46,16 @@ ${object_type}* ${type_name}::TakeLast()
 
 ${object_type}* ${type_name}::AppendCopy(${object_type} * item)
 {
-    auto new_item = new ${object_type}(item->Get(), this);
+    ${object_type}* new_item = nullptr;
+    if (auto arena = data_->GetArena())
+    {
+        // копия сразу создается на арене поля, арена ей и владеет
+        auto message = google::protobuf::Arena::Create<${data_type}>(arena);
+        message->CopyFrom(item->Get());
+        new_item = new ${object_type}(message, this);
+    }
+    else
+        new_item = new ${object_type}(item->Get(), this);
     Append(new_item);
     return new_item;
 }
@@ -61,37 +70,124 @@ const google::protobuf::RepeatedPtrField<${data_type}>& ${type_name}::Get() cons
     return *data_;
 }
 
-void ${type_name}::SetProtoMessage(google::protobuf::RepeatedPtrField<${data_type}>* data, bool emit_all_signals)
+void ${type_name}::SetProtoMessage(google::protobuf::RepeatedPtrField<${data_type}>* data, bool emit_all_signals, bool checked)
 {
     data_ = data;
-    PrivateSyncData(emit_all_signals);
+    PrivateSyncData(emit_all_signals, checked);
 }
 
 void ${type_name}::CheckForChangedAndSetProtoMessage(google::protobuf::RepeatedPtrField<${data_type}>* data)
 {
     if (data)
         CheckForChangedProperties(*data);
-    SetProtoMessage(data, !data);
+    SetProtoMessage(data, !data, data != nullptr);
 }
 
-void ${type_name}::CheckForChangedProperties(const google::protobuf::RepeatedPtrField<${data_type}>& new_data)
+void ${type_name}::CheckForChangedProperties(const google::protobuf::RepeatedPtrField<${data_type}>& new_data, const std::vector<om::WireBytes>& items_bytes,
+                                             const std::vector<om::WireBytes>& new_items_bytes)
 {
+    if (keyed_sync_)
+        return PrepareKeyedSync(new_data, items_bytes, new_items_bytes);
+    // неизмененные элементы пропускаются сравнением байтов
     for (int i = 0; i < std::min(items_.size(), new_data.size()); ++i)
-        static_cast<${object_type}*>(items_[i])->CheckForChangedProperties(new_data[i]);
+        static_cast<${object_type}*>(items_[i])->CheckForChangedProperties(new_data[i], GetItemBytes(items_bytes, data_->size(), i),
+                                                                          GetItemBytes(new_items_bytes, new_data.size(), i));
+}
+
+bool ${type_name}::IsKeyedSync() const
+{
+    return keyed_sync_;
+}
+
+void ${type_name}::SetKeyedSync(bool val)
+{
+    keyed_sync_ = val;
+    sync_old_rows_count_ = -1;
+}
+
+QByteArray ${type_name}::GetSyncKey() const
+{
+    return sync_key_field_ ? QByteArray::fromStdString(sync_key_field_->name()) : QByteArray();
+}
+
+void ${type_name}::SetSyncKey(const QByteArray& field_name)
+{
+    if (field_name.isEmpty())
+    {
+        sync_key_field_ = nullptr;
+        return;
+    }
+    auto field = ${data_type}::descriptor()->FindFieldByName(field_name.toStdString());
+    if (!field || field->is_repeated())
+        throw std::logic_error("Sync key must be a not repeated field of the message");
+    sync_key_field_ = field;
+}
+
+size_t ${type_name}::GetKey(const ${data_type}& message, const google::protobuf::FieldDescriptor* key_field)
+{
+    // коллизии хэшей только добавляют перемещения строк и сигналы, изменения содержимого проверяются у самих элементов
+    std::string key;
+    if (key_field)
+        google::protobuf::TextFormat::PrintFieldValueToString(message, key_field, -1, &key);
+    else
+        message.SerializeToString(&key);
+    return std::hash<std::string>()(key);
+}
+
+QVector<int> ${type_name}::MatchKeys(const std::vector<size_t>& keys, const std::vector<size_t>& new_keys)
+{
+    std::unordered_map<size_t, std::vector<int>> old_rows;
+    for (int row = static_cast<int>(keys.size()) - 1; row >= 0; --row)
+        old_rows[keys[row]].push_back(row);
+
+    QVector<int> new_to_old(static_cast<int>(new_keys.size()), -1);
+    for (int new_row = 0; new_row < new_to_old.size(); ++new_row)
+    {
+        auto rows = old_rows.find(new_keys[new_row]);
+        if (rows == old_rows.end() || rows->second.empty())
+            continue;
+        new_to_old[new_row] = rows->second.back();
+        rows->second.pop_back();
+    }
+    return new_to_old;
+}
+
+void ${type_name}::PrepareKeyedSync(const google::protobuf::RepeatedPtrField<${data_type}>& new_data, const std::vector<om::WireBytes>& items_bytes,
+                                    const std::vector<om::WireBytes>& new_items_bytes)
+{
+    // старые данные еще не перезаписаны, элементы сопоставляются по ключам
+    std::vector<size_t> keys, new_keys;
+    int old_rows_count = std::min(items_.size(), data_->size());
+    keys.reserve(old_rows_count);
+    for (int row = 0; row < old_rows_count; ++row)
+        keys.push_back(GetKey(data_->Get(row), sync_key_field_));
+    new_keys.reserve(new_data.size());
+    for (const auto& message : new_data)
+        new_keys.push_back(GetKey(message, sync_key_field_));
+
+    sync_old_rows_ = MatchKeys(keys, new_keys);
+    for (int new_row = 0; new_row < new_data.size(); ++new_row)
+    {
+        auto row = sync_old_rows_[new_row];
+        if (row >= 0)
+            static_cast<${object_type}*>(items_[row])->CheckForChangedProperties(new_data[new_row], GetItemBytes(items_bytes, data_->size(), row),
+                                                                                GetItemBytes(new_items_bytes, new_data.size(), new_row));
+    }
+    sync_old_rows_count_ = items_.size();
 }
 
 void ${type_name}::Set(const google::protobuf::RepeatedPtrField<${data_type}>& data)
 {
     CheckForChangedProperties(data);
     data_->CopyFrom(data);
-    PrivateSyncData();
+    PrivateSyncData(false, true);
 }
 
 void ${type_name}::Set(google::protobuf::RepeatedPtrField<${data_type}>&& data)
 {
     CheckForChangedProperties(data);
     data_->Swap(&data);
-    PrivateSyncData();
+    PrivateSyncData(false, true);
 }
 
 void ${type_name}::SyncData()
@@ -99,12 +195,246 @@ void ${type_name}::SyncData()
     PrivateSyncData(true);
 }
 
-void ${type_name}::PrivateSyncData(bool emit_all_signals)
+void ${type_name}::BeginStreamAppend(int chunk_size)
+{
+    stream_chunk_size_ = std::max(chunk_size, 1);
+    stream_buffer_.clear();
+}
+
+int ${type_name}::AppendDelimited(QIODevice* device)
+{
+    if (!device || !device->isReadable())
+        return -1;
+    if (!IsStreamAppending())
+        BeginStreamAppend();
+
+    // в памяти одновременно только блок данных, неполное сообщение и порция еще не добавленных строк
+    auto first_row = data_->size();
+    for (;;)
+    {
+        auto block = device->read(kDelimitedReadBlockSize);
+        if (block.isEmpty())
+            break;
+        stream_buffer_.append(block);
+        if (ParseStreamBuffer() < 0)
+        {
+            // разобранные до ошибки сообщения остаются в модели
+            AppendStreamChunk();
+            stream_buffer_.clear();
+            return -1;
+        }
+    }
+    AppendStreamChunk();
+    return data_->size() - first_row;
+}
+
+bool ${type_name}::EndStreamAppend()
 {
+    AppendStreamChunk();
+    auto complete = stream_buffer_.isEmpty();
+    stream_chunk_size_ = 0;
+    stream_buffer_.clear();
+    return complete;
+}
+
+bool ${type_name}::IsStreamAppending() const
+{
+    return stream_chunk_size_ > 0;
+}
+
+bool ${type_name}::WriteDelimited(QIODevice* device) const
+{
+    if (!device || !device->isWritable())
+        return false;
+    DeviceOutputStream stream(device);
+    google::protobuf::io::CopyingOutputStreamAdaptor output(&stream);
+    {
+        // кодирующий поток дописывает свой буфер в адаптер при удалении, до сброса адаптера
+        google::protobuf::io::CodedOutputStream coded_output(&output);
+        for (const auto& message : *data_)
+            if (!google::protobuf::util::SerializeDelimitedToCodedStream(message, &coded_output))
+                return false;
+    }
+    return output.Flush();
+}
+
+void ${type_name}::ApplyAsync(const QByteArray& data)
+{
+    if (!async_applier_)
+        async_applier_ = std::make_unique<om::AsyncApplier>(this);
+    // data_ изменяется только в потоке модели. Если дерево модели не менялось после предыдущего ApplyAsync, образцом для сравнения
+    // в пуле потоков служат его байты и ключи, иначе байты data_, сериализованные здесь. Они же кэшируют размеры для элементов
+    auto change_count = GetChangeCount();
+    auto keyed        = keyed_sync_;
+    auto key_field    = sync_key_field_;
+    auto snapshot     = applied_snapshot_;
+    if (applied_change_count_ != change_count || !snapshot || snapshot->keyed != keyed || snapshot->key_field != key_field)
+    {
+        auto serialized = std::make_shared<ItemsSnapshot>();
+        serialized->items_bytes = SerializeItemsWireBytes(*data_, serialized->data);
+        snapshot = serialized;
+    }
+    // элементы, не синхронизированные с данными (при потоковом добавлении), не с чем сравнивать
+    if (items_.size() != data_->size() || snapshot->items_bytes.size() != static_cast<size_t>(data_->size()))
+        snapshot = nullptr;
+
+    async_applier_->Start([this, data, snapshot, keyed, key_field, change_count]() -> om::AsyncApplier::Apply {
+        auto new_data = std::make_shared<google::protobuf::RepeatedPtrField<${data_type}>>();
+        if (!ParseDelimited(data, *new_data))
+            return {};
+        // сериализация кэширует размеры новых сообщений, байты и ключи остаются образцом для следующего ApplyAsync
+        auto new_snapshot = std::make_shared<ItemsSnapshot>();
+        new_snapshot->items_bytes = SerializeItemsWireBytes(*new_data, new_snapshot->data);
+        new_snapshot->keyed       = keyed;
+        new_snapshot->key_field   = key_field;
+        if (keyed)
+        {
+            new_snapshot->keys.reserve(new_data->size());
+            for (const auto& message : *new_data)
+                new_snapshot->keys.push_back(GetKey(message, key_field));
+        }
+
+        // строки новых данных сопоставляются со старыми, проверяются только элементы с измененными байтами
+        auto compared = snapshot && new_snapshot->items_bytes.size() == static_cast<size_t>(new_data->size());
+        QVector<int> new_to_old;
+        QVector<QPair<int, int>> changed_rows;
+        if (compared && keyed)
+        {
+            auto keys = snapshot->keys;
+            if (keys.size() != snapshot->items_bytes.size())
+            {
+                // ключи данных, сериализованных в потоке модели, находятся по их байтам
+                keys.clear();
+                ${data_type} message;
+                for (const auto& bytes : snapshot->items_bytes)
+                {
+                    compared = compared && message.ParseFromArray(bytes.GetData(), bytes.GetSize());
+                    keys.push_back(GetKey(message, key_field));
+                }
+            }
+            new_to_old = MatchKeys(keys, new_snapshot->keys);
+        }
+        else if (compared)
+        {
+            new_to_old.resize(std::min(static_cast<int>(snapshot->items_bytes.size()), new_data->size()));
+            std::iota(new_to_old.begin(), new_to_old.end(), 0);
+        }
+        for (int new_row = 0; compared && new_row < new_to_old.size(); ++new_row)
+        {
+            auto row = new_to_old[new_row];
+            if (row >= 0 && !snapshot->items_bytes[row].IsSame(new_snapshot->items_bytes[new_row]))
+                changed_rows.append({ new_row, row });
+        }
+
+        std::shared_ptr<const ItemsSnapshot> applied = new_snapshot;
+        return [this, new_data, applied, snapshot, new_to_old, changed_rows, compared, change_count] {
+            // не с чем было сравнить или модель изменена во время сравнения: данные проверяются заново
+            if (!compared || change_count != GetChangeCount() || applied->keyed != keyed_sync_ || applied->key_field != sync_key_field_)
+                Set(std::move(*new_data));
+            else
+            {
+                for (const auto& rows : changed_rows)
+                    static_cast<${object_type}*>(items_[rows.second])
+                        ->CheckForChangedProperties((*new_data)[rows.first], snapshot->items_bytes[rows.second], applied->items_bytes[rows.first]);
+                if (applied->keyed)
+                {
+                    sync_old_rows_       = new_to_old;
+                    sync_old_rows_count_ = items_.size();
+                }
+                data_->Swap(new_data.get());
+                PrivateSyncData(false, true);
+            }
+            applied_snapshot_     = applied;
+            applied_change_count_ = GetChangeCount();
+        };
+    });
+}
+
+bool ${type_name}::IsApplyingAsync() const
+{
+    return async_applier_ && async_applier_->IsRunning();
+}
+
+bool ${type_name}::ParseDelimited(const QByteArray& data, google::protobuf::RepeatedPtrField<${data_type}>& messages)
+{
+    auto bytes = reinterpret_cast<const uint8_t*>(data.constData());
+    int pos = 0;
+    while (pos < data.size())
+    {
+        google::protobuf::io::CodedInputStream input(bytes + pos, data.size() - pos);
+        uint32_t message_size = 0;
+        if (!input.ReadVarint32(&message_size))
+            return false;
+        auto message_pos = pos + input.CurrentPosition();
+        if (message_size > static_cast<uint32_t>(data.size() - message_pos))
+            return false;
+        auto message = messages.Add();
+        if (!message->ParseFromArray(bytes + message_pos, static_cast<int>(message_size)))
+            return false;
+        message->ByteSizeLong();
+        pos = message_pos + static_cast<int>(message_size);
+    }
+    return true;
+}
+
+int ${type_name}::ParseStreamBuffer()
+{
+    auto data = reinterpret_cast<const uint8_t*>(stream_buffer_.constData());
+    int size = stream_buffer_.size();
+    int pos = 0;
+    while (pos < size)
+    {
+        google::protobuf::io::CodedInputStream input(data + pos, size - pos);
+        uint32_t message_size = 0;
+        if (!input.ReadVarint32(&message_size))
+        {
+            // префикс длины не длиннее 5 байт, иначе данные испорчены
+            if (size - pos >= 5)
+                return -1;
+            break;
+        }
+        auto message_pos = pos + input.CurrentPosition();
+        if (message_size > static_cast<uint32_t>(size - message_pos))
+            break;
+        if (!data_->Add()->ParseFromArray(data + message_pos, static_cast<int>(message_size)))
+        {
+            data_->RemoveLast();
+            return -1;
+        }
+        pos = message_pos + static_cast<int>(message_size);
+        if (data_->size() - items_.size() >= stream_chunk_size_)
+            AppendStreamChunk();
+    }
+    stream_buffer_.remove(0, pos);
+    return pos;
+}
+
+void ${type_name}::AppendStreamChunk()
+{
+    if (data_->size() == items_.size())
+        return;
+    MarkChanged(this);
+    // объекты новых строк создаются для уже добавленных в поле сообщений, одним сигналом вставки
+    synchronizing_ = true;
+    Resize(data_->size());
+    synchronizing_ = false;
+    EmitChanged();
+}
+
+void ${type_name}::PrivateSyncData(bool emit_all_signals, bool checked)
+{
+    MarkChanged(this);
     synchronizing_ = true;
+    // элементы переставляются на строки своих новых данных, сообщения меняются ниже.
+    // Результат проверки, после которой данные заданы без нее, отбрасывается
+    if (checked && sync_old_rows_count_ == items_.size() && sync_old_rows_.size() == data_->size())
+        SyncItems(sync_old_rows_, [this](int row) { return CreateNewInstance(row); });
+    sync_old_rows_count_ = -1;
+    sync_old_rows_.clear();
+
     auto sync_size = std::min(data_->size(), items_.size());
     for (int i = 0; i < sync_size; ++i)
-        static_cast<${object_type}*>(items_[i])->SetProtoMessage(data_->Mutable(i), emit_all_signals);
+        static_cast<${object_type}*>(items_[i])->SetProtoMessage(data_->Mutable(i), emit_all_signals, checked);
     Resize(data_->size());
     synchronizing_ = false;
     EmitChanged();
@@ -118,7 +448,12 @@ void ${type_name}::InstallItem(int row)
 
 QObject* ${type_name}::CreateNewInstance(int row)
 {
-    return new ${object_type}(row >= 0 && row < data_->size() ? data_->Mutable(row) : nullptr, this);
+    ${data_type}* message = nullptr;
+    if (row >= 0 && row < data_->size())
+        message = data_->Mutable(row);
+    else if (data_->GetArena())
+        message = google::protobuf::Arena::Create<${data_type}>(data_->GetArena());  // арена поля владеет сообщением
+    return new ${object_type}(message, this);
 }
 
 void ${type_name}::OnInserted(const QModelIndex& parent, int first, int last)
@@ -128,6 +463,7 @@ void ${type_name}::OnInserted(const QModelIndex& parent, int first, int last)
     int count = last - first + 1;
     if (items_.size() - data_->size() != count)
         throw std::logic_error("Model is not synced");
+    MarkChanged(this);
 
     auto pos = data_->size();
 
@@ -136,10 +472,14 @@ void ${type_name}::OnInserted(const QModelIndex& parent, int first, int last)
         auto item = static_cast<${object_type}*>(items_[i]);
         item->RevokeProtoMessageOwnership();
         data_->AddAllocated(item->GetProtoMessage());
+        // сообщение с другой арены копируется в поле
+        if (data_->Mutable(data_->size() - 1) != item->GetProtoMessage())
+            item->SetProtoMessage(data_->Mutable(data_->size() - 1));
     }
 
+    // добавленные в конец сообщения переносятся на место вставки одним проходом
     if (pos != first)
-        for (int i = 0; i < count; ++i) data_->SwapElements(pos + i, first + i);
+        std::rotate(data_->pointer_begin() + first, data_->pointer_begin() + pos, data_->pointer_begin() + pos + count);
 
     EmitChanged();
 }
@@ -150,26 +490,75 @@ void ${type_name}::OnItemRemoved(const QModelIndex& parent, int first, int last)
         return;
     if (data_->size() - items_.size() != last - first + 1)
         throw std::logic_error("Model is not synced");
+    MarkChanged(this);
     data_->DeleteSubrange(first, last - first + 1);
     EmitChanged();
 }
 
 void ${type_name}::OnItemMoved(const QModelIndex &parent, int start, int end, const QModelIndex &destination, int row)
 {
-    throw std::runtime_error("Not supported yet");
+    if (synchronizing_)
+        return;
+    if (items_.size() != data_->size())
+        throw std::logic_error("Model is not synced");
+    MarkChanged(this);
+
+    // row - позиция вставки до перемещения, сообщения переставляются без копирования
+    auto begin = data_->pointer_begin();
+    if (row > end)
+        std::rotate(begin + start, begin + end + 1, begin + row);
+    else if (row < start)
+        std::rotate(begin + row, begin + start, begin + end + 1);
     EmitChanged();
 }
 
 void ${type_name}::OnReset()
 {
+    // при синхронизации сброс модели удаляет только объекты, сообщения уже новые
+    if (synchronizing_)
+        return;
+    MarkChanged(this);
+    if (items_compacted_)
+    {
+        items_compacted_ = false;
+        EmitChanged();
+        return;
+    }
+    // память сообщений на арене освобождается вместе с ареной корневого объекта
     data_->Clear();
     EmitChanged();
 }
 
+void ${type_name}::ItemsCompacted(const QVector<QPair<int, int>>& removed_ranges)
+{
+    if (synchronizing_)
+        return;
+    int removed_count = 0;
+    for (const auto& range : removed_ranges)
+        removed_count += range.second;
+    if (data_->size() - items_.size() != removed_count)
+        throw std::logic_error("Model is not synced");
+
+    // оставшиеся сообщения сдвигаются перестановкой указателей за один проход, удаленные оказываются в конце
+    int write_row = removed_ranges.first().first;
+    for (int read_row = write_row, range = 0; read_row < data_->size(); ++read_row)
+    {
+        if (range < removed_ranges.size() && read_row == removed_ranges[range].first)
+        {
+            read_row += removed_ranges[range++].second - 1;
+            continue;
+        }
+        data_->SwapElements(write_row++, read_row);
+    }
+    data_->DeleteSubrange(write_row, data_->size() - write_row);
+    items_compacted_ = true;
+}
+
 void ${type_name}::OnDataChanged(const QModelIndex &top_left, const QModelIndex &bottom_right, const QVector<int> &roles)
 {
     if (!roles.isEmpty() || !top_left.isValid() || !bottom_right.isValid())
         return;
+    MarkChanged(this);
     for (int row = top_left.row(); row <= bottom_right.row(); ++row)
     {
         auto item = static_cast<${object_type}*>(items_[row]);
@@ -177,6 +566,8 @@ void ${type_name}::OnDataChanged(const QModelIndex &top_left, const QModelIndex
         data_->AddAllocated(item->GetProtoMessage());
         data_->SwapElements(row, data_->size() - 1);
         data_->RemoveLast();
+        if (data_->Mutable(row) != item->GetProtoMessage())
+            item->SetProtoMessage(data_->Mutable(row));
         EmitChanged();
     }
 }
@@ -186,10 +577,22 @@ void ${type_name}::EmitChanged()
     if (changed_signal_emitted_)
         return;
     changed_signal_emitted_ = true;
-    QMetaObject::invokeMethod(this, [this] {
-        emit changed();
-        changed_signal_emitted_ = false;
-    }, Qt::QueuedConnection);
+    dispatch_entry_.Enqueue();
+}
+
+void ${type_name}::EmitQueuedChanged(QObject* object)
+{
+    auto self = static_cast<${type_name}*>(object);
+    emit self->changed();
+    self->changed_signal_emitted_ = false;
+}
+
+bool ${type_name}::event(QEvent* event)
+{
+    // отложенный сброс сигналов переносится в новый поток вместе с объектом
+    if (event->type() == QEvent::ThreadChange)
+        dispatch_entry_.OnThreadChange();
+    return om::ObjectModel::event(event);
 }
 
 ${type_name}::const_iterator ${type_name}::begin() const
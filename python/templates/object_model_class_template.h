@@ -1,6 +1,8 @@
-class ${type_name} : public om::ObjectModel
+class ${type_name} : public om::ObjectModel, public om::ChangeCounter
 {
     Q_OBJECT
+    Q_PROPERTY(bool keyedSync READ IsKeyedSync WRITE SetKeyedSync)
+    Q_PROPERTY(QByteArray syncKey READ GetSyncKey WRITE SetSyncKey)
 public:
     using iterator       = ${object_type} **;
     using const_iterator = ${object_type} *const *;
@@ -9,16 +11,52 @@ public:
     ~${type_name}() override;
 
     google::protobuf::RepeatedPtrField<${data_type}>* GetProtoMessage() const;
-    void SetProtoMessage(google::protobuf::RepeatedPtrField<${data_type}>* data, bool emit_all_signals = false);
+    // checked - the data was checked by CheckForChangedProperties right before (by the parent object), so the result of the keyed check
+    // is applied. Otherwise it is dropped
+    void SetProtoMessage(google::protobuf::RepeatedPtrField<${data_type}>* data, bool emit_all_signals = false, bool checked = false);
 
     void CheckForChangedAndSetProtoMessage(google::protobuf::RepeatedPtrField<${data_type}>* data);
-    void CheckForChangedProperties(const google::protobuf::RepeatedPtrField<${data_type}>& new_data);
+    // items_bytes, new_items_bytes - serialized old and new messages of the items, that the parent object found in its own bytes.
+    // Without them every item serializes its messages itself
+    void CheckForChangedProperties(const google::protobuf::RepeatedPtrField<${data_type}>& new_data, const std::vector<om::WireBytes>& items_bytes = {},
+                                   const std::vector<om::WireBytes>& new_items_bytes = {});
+
+    // Keyed synchronization: new data, that is checked by CheckForChangedProperties (by Set for example), is matched with the old data by the key field
+    // (by content, when key field is empty) instead of positions. So only inserted, removed and moved rows are signaled
+    // and only items with changed contents emit property signals
+    bool IsKeyedSync() const;
+    void SetKeyedSync(bool val);
+    QByteArray GetSyncKey() const;
+    void SetSyncKey(const QByteArray& field_name);
 
     const google::protobuf::RepeatedPtrField<${data_type}>& Get() const;
     void Set(const google::protobuf::RepeatedPtrField<${data_type}>& data);
     void Set(google::protobuf::RepeatedPtrField<${data_type}>&& data);
     void SyncData();
 
+    // Append of length-delimited messages (from a file or a socket) without reading all of them into memory: the data is read by blocks,
+    // parsed messages are appended by chunks of chunk_size rows with one insert signal per chunk.
+    // Incomplete message at the end of the read data is kept until the next AppendDelimited
+    void BeginStreamAppend(int chunk_size = 1024);
+    // Reads and parses all data, that the device returns now, synchronously in the calling thread: the event loop is blocked until
+    // the device has no more data, so a large file is appended in one call. To append data as it arrives, call it on readyRead of the device.
+    // Begins stream append, if it isn't begun. Returns number of appended rows or -1 for malformed data
+    int AppendDelimited(QIODevice* device);
+    // Returns false, if the stream ends with an incomplete message
+    bool EndStreamAppend();
+    bool IsStreamAppending() const;
+    // Writes all messages with length prefixes, that AppendDelimited reads
+    bool WriteDelimited(QIODevice* device) const;
+
+    // Parses and serializes length-delimited messages (written by WriteDelimited) and matches them with the data of the previous ApplyAsync
+    // by keys or positions in the thread pool, then only the items with changed bytes are checked and the parsed data is set by swap in the model's thread.
+    // If the tree of the model is changed otherwise since the previous ApplyAsync (see ChangeCounter), the current data is serialized
+    // in the model's thread for the comparison. If it is changed while the data is compared, the whole data is checked in the model's thread.
+    // Data on the arena of the parent object can't take the parsed one by swap, so it is copied there.
+    // Only the last data is applied: results of the earlier calls, that are not set yet, are dropped. Invalid data is ignored
+    void ApplyAsync(const QByteArray& data);
+    bool IsApplyingAsync() const;
+
     const_iterator begin() const;
     const_iterator end() const;
 
@@ -48,10 +86,50 @@ private slots:
 private:
     void InstallItem(int row) override;
     QObject* CreateNewInstance(int row) override;
+    void ItemsCompacted(const QVector<QPair<int, int>>& removed_ranges) override;
     
-    void PrivateSyncData(bool emit_all_signals = false);
+    // checked - данные только что проверены CheckForChangedProperties
+    void PrivateSyncData(bool emit_all_signals = false, bool checked = false);
+    void PrepareKeyedSync(const google::protobuf::RepeatedPtrField<${data_type}>& new_data, const std::vector<om::WireBytes>& items_bytes,
+                          const std::vector<om::WireBytes>& new_items_bytes);
+    static size_t GetKey(const ${data_type}& message, const google::protobuf::FieldDescriptor* key_field);
+    // Старые строки новых ключей или -1, повторяющиеся ключи сопоставляются по порядку
+    static QVector<int> MatchKeys(const std::vector<size_t>& keys, const std::vector<size_t>& new_keys);
+    int ParseStreamBuffer();
+    static bool ParseDelimited(const QByteArray& data, google::protobuf::RepeatedPtrField<${data_type}>& messages);
+    void AppendStreamChunk();
+    static void EmitQueuedChanged(QObject* object);
+    bool event(QEvent* event) override;
 
     bool synchronizing_ = false;
+    // Сообщения удаленных строк уже удалены ItemsCompacted, сброс модели не очищает данные
+    bool items_compacted_ = false;
     bool changed_signal_emitted_ = false;
+    // changed() испускается общим для потока событием после изменений элементов
+    om::ChangeDispatcher::Entry dispatch_entry_{ this, &${type_name}::EmitQueuedChanged };
+    bool keyed_sync_ = false;
+    const google::protobuf::FieldDescriptor* sync_key_field_ = nullptr;
+    // Старые строки элементов новых данных или -1 для новых элементов. Применяется только синхронизацией сразу после проверки
+    // и только если sync_old_rows_count_ равен количеству элементов, любая синхронизация его сбрасывает
+    QVector<int> sync_old_rows_;
+    int sync_old_rows_count_ = -1;
+    // Размер порции строк потокового добавления, 0 - добавление не начато
+    int stream_chunk_size_ = 0;
+    // Прочитанные, но еще не разобранные данные потока: неполное сообщение
+    QByteArray stream_buffer_;
+    // Сериализованные данные и ключи их элементов для сравнения в пуле потоков. Ключи есть, только если keyed
+    struct ItemsSnapshot
+    {
+        std::string data;
+        std::vector<om::WireBytes> items_bytes;
+        bool keyed = false;
+        const google::protobuf::FieldDescriptor* key_field = nullptr;
+        std::vector<size_t> keys;
+    };
+    // Данные, примененные последним ApplyAsync, и счетчик изменений дерева после него. Неизменяемы, поэтому читаются в пуле потоков без копирования
+    std::shared_ptr<const ItemsSnapshot> applied_snapshot_;
+    quint64 applied_change_count_ = 0;
+    // Создается первым ApplyAsync
+    std::unique_ptr<om::AsyncApplier> async_applier_;
     google::protobuf::RepeatedPtrField<${data_type}>* data_ = nullptr;
 };
\ No newline at end of file
@@ -0,0 +1,235 @@
+${type_name}::${type_name}(google::protobuf::RepeatedPtrField<${data_type}>* data, QObject* parent) : om::VirtualObjectModel(${object_type}::staticMetaObject, parent)
+{
+    reader_ = std::make_unique<${object_type}>();
+    SetProtoMessage(data);
+}
+
+${type_name}::~${type_name}() = default;
+
+${object_type}* ${type_name}::At(int row) const
+{
+    return static_cast<${object_type}*>(om::VirtualObjectModel::At(row));
+}
+
+${object_type}* ${type_name}::First() const
+{
+    return static_cast<${object_type}*>(om::VirtualObjectModel::First());
+}
+
+${object_type}* ${type_name}::Last() const
+{
+    return static_cast<${object_type}*>(om::VirtualObjectModel::Last());
+}
+
+google::protobuf::RepeatedPtrField<${data_type}>* ${type_name}::GetProtoMessage() const
+{
+    ParseSnapshot();
+    return data_;
+}
+
+void ${type_name}::SetProtoMessage(google::protobuf::RepeatedPtrField<${data_type}>* data)
+{
+    if (!data)
+        data = &own_data_;
+    ResetDataRows(data->size(), [&] {
+        CloseSnapshot();
+        data_ = data;
+    });
+    EmitChanged();
+}
+
+const google::protobuf::RepeatedPtrField<${data_type}>& ${type_name}::Get() const
+{
+    ParseSnapshot();
+    return *data_;
+}
+
+void ${type_name}::Set(const google::protobuf::RepeatedPtrField<${data_type}>& data)
+{
+    ResetDataRows(data.size(), [&] {
+        CloseSnapshot();
+        data_->CopyFrom(data);
+    });
+    EmitChanged();
+}
+
+void ${type_name}::Set(google::protobuf::RepeatedPtrField<${data_type}>&& data)
+{
+    ResetDataRows(data.size(), [&] {
+        CloseSnapshot();
+        data_->Swap(&data);
+    });
+    EmitChanged();
+}
+
+bool ${type_name}::OpenSnapshot(const QString& file_path)
+{
+    auto snapshot = std::make_unique<om::SnapshotFile>();
+    if (!snapshot->Open(file_path))
+        return false;
+
+    auto count = snapshot->GetCount();
+    ResetDataRows(count, [&] {
+        // снимок нужен представлениям уже при сбросе модели
+        snapshot_ = std::move(snapshot);
+        snapshot_parsed_.assign(count, false);
+        snapshot_unparsed_count_ = count;
+        data_->Clear();
+        data_->Reserve(count);
+        for (int row = 0; row < count; ++row) data_->Add();
+    });
+    if (!count)
+        CloseSnapshot();
+    EmitChanged();
+    return true;
+}
+
+void ${type_name}::ParseSnapshot() const
+{
+    for (int row = 0; snapshot_ && row < static_cast<int>(snapshot_parsed_.size()); ++row) ParseSnapshotRow(row);
+}
+
+bool ${type_name}::IsSnapshotOpened() const
+{
+    return snapshot_ != nullptr;
+}
+
+bool ${type_name}::WriteSnapshot(const QString& file_path) const
+{
+    return WriteSnapshot(file_path, Get());
+}
+
+bool ${type_name}::WriteSnapshot(const QString& file_path, const google::protobuf::RepeatedPtrField<${data_type}>& data)
+{
+    // размеры вычисляются для индекса, сообщения пишутся по их кэшу
+    return om::SnapshotFile::Write(
+        file_path, data.size(), [&](int row) { return static_cast<quint32>(data.Get(row).ByteSizeLong()); },
+        [&](int row, char* buffer, quint32) { data.Get(row).SerializeWithCachedSizesToArray(reinterpret_cast<uint8_t*>(buffer)); });
+}
+
+void ${type_name}::ParseSnapshotRow(int row) const
+{
+    if (!snapshot_ || row < 0 || row >= static_cast<int>(snapshot_parsed_.size()) || snapshot_parsed_[row])
+        return;
+    snapshot_parsed_[row] = true;
+    int size = 0;
+    auto record = snapshot_->GetRecord(row, &size);
+    // сообщение испорченной записи остается пустым
+    if (!record || !data_->Mutable(row)->ParseFromArray(record, size))
+        data_->Mutable(row)->Clear();
+    if (--snapshot_unparsed_count_ == 0)
+        CloseSnapshot();
+}
+
+void ${type_name}::CloseSnapshot() const
+{
+    snapshot_.reset();
+    snapshot_parsed_.clear();
+    snapshot_unparsed_count_ = 0;
+}
+
+void ${type_name}::SyncData()
+{
+    ResetDataRows(data_->size());
+    EmitChanged();
+}
+
+void ${type_name}::Append(const ${data_type}& val)
+{
+    InsertDataRows(rowCount(), 1, [&] { data_->Add()->CopyFrom(val); });
+    EmitChanged();
+}
+
+void ${type_name}::Append(${data_type}&& val)
+{
+    InsertDataRows(rowCount(), 1, [&] { *data_->Add() = std::move(val); });
+    EmitChanged();
+}
+
+${object_type}* ${type_name}::AppendCopy(${object_type}* item)
+{
+    if (!item)
+        return nullptr;
+    Append(item->Get());
+    return Last();
+}
+
+void ${type_name}::Remove(int row, int count)
+{
+    if (count < 1 || row < 0 || row + count > data_->size())
+        return;
+    // строки снимка сдвигаются, поэтому он разбирается целиком
+    ParseSnapshot();
+    RemoveDataRows(row, count, [&] { data_->DeleteSubrange(row, count); });
+    EmitChanged();
+}
+
+void ${type_name}::Clear()
+{
+    if (data_->empty())
+        return;
+    // память сообщений на арене освобождается вместе с ареной
+    ResetDataRows(0, [&] {
+        CloseSnapshot();
+        data_->Clear();
+    });
+    EmitChanged();
+}
+
+QObject* ${type_name}::CreateItem(int row) const
+{
+    // объект указывает на сообщение поля, поле им и владеет
+    ParseSnapshotRow(row);
+    return new ${object_type}(data_->Mutable(row));
+}
+
+QObject* ${type_name}::GetRowReader(int row) const
+{
+    ParseSnapshotRow(row);
+    reader_->AttachProtoMessage(data_->Mutable(row));
+    return reader_.get();
+}
+
+bool ${type_name}::IsItemIdle(QObject* item) const
+{
+    return !static_cast<${object_type}*>(item)->IsObserved();
+}
+
+bool ${type_name}::SetItem(int row, QObject* val)
+{
+    auto item = qobject_cast<${object_type}*>(val);
+    if (!item || row < 0 || row >= data_->size())
+        return false;
+    At(row)->Set(item->Get());
+    emit dataChanged(index(row), index(row));
+    return true;
+}
+
+void ${type_name}::InstallItem(int row)
+{
+    om::VirtualObjectModel::InstallItem(row);
+    connect(static_cast<${object_type}*>(GetItem(row)), &${object_type}::changed, this, &${type_name}::EmitChanged);
+}
+
+void ${type_name}::EmitChanged()
+{
+    if (changed_signal_emitted_)
+        return;
+    changed_signal_emitted_ = true;
+    dispatch_entry_.Enqueue();
+}
+
+void ${type_name}::EmitQueuedChanged(QObject* object)
+{
+    auto self = static_cast<${type_name}*>(object);
+    emit self->changed();
+    self->changed_signal_emitted_ = false;
+}
+
+bool ${type_name}::event(QEvent* event)
+{
+    // отложенный сброс сигналов переносится в новый поток вместе с объектом
+    if (event->type() == QEvent::ThreadChange)
+        dispatch_entry_.OnThreadChange();
+    return om::VirtualObjectModel::event(event);
+}
\ No newline at end of file
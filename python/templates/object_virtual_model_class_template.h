@@ -0,0 +1,69 @@
+class ${type_name} : public om::VirtualObjectModel
+{
+    Q_OBJECT
+public:
+    // Without data model uses its own repeated field
+    ${type_name}(google::protobuf::RepeatedPtrField<${data_type}>* data = nullptr, QObject* parent = nullptr);
+    ~${type_name}() override;
+
+    google::protobuf::RepeatedPtrField<${data_type}>* GetProtoMessage() const;
+    void SetProtoMessage(google::protobuf::RepeatedPtrField<${data_type}>* data);
+
+    const google::protobuf::RepeatedPtrField<${data_type}>& Get() const;
+    void Set(const google::protobuf::RepeatedPtrField<${data_type}>& data);
+    void Set(google::protobuf::RepeatedPtrField<${data_type}>&& data);
+    // Resets the model after the data was changed not through the model
+    void SyncData();
+
+    void Append(const ${data_type}& val);
+    void Append(${data_type}&& val);
+
+    // Snapshot is the file of the rows messages (see om::SnapshotFile), that is mapped to memory. Rows count is known right after opening,
+    // messages are parsed from the mapping, when their rows are accessed first. Get, GetProtoMessage and Remove parse all rows.
+    // Opening still takes O(rows) time and memory: an empty message is allocated for every row, so the rows keep their addresses
+    bool OpenSnapshot(const QString& file_path);
+    // Parses all rows, that are not parsed yet, and closes the snapshot file
+    void ParseSnapshot() const;
+    bool IsSnapshotOpened() const;
+    // Writes atomically: file_path is replaced only by the completely written file
+    bool WriteSnapshot(const QString& file_path) const;
+    static bool WriteSnapshot(const QString& file_path, const google::protobuf::RepeatedPtrField<${data_type}>& data);
+
+signals:
+    void changed();
+
+public slots:
+    ${object_type}* At(int row) const;
+    ${object_type}* First() const;
+    ${object_type}* Last() const;
+    ${object_type}* AppendCopy(${object_type}* item);
+    void Remove(int row, int count = 1);
+    void Clear();
+
+protected:
+    QObject* CreateItem(int row) const override;
+    QObject* GetRowReader(int row) const override;
+    bool IsItemIdle(QObject* item) const override;
+    bool SetItem(int row, QObject* val) override;
+    void InstallItem(int row) override;
+
+private slots:
+    void EmitChanged();
+
+private:
+    static void EmitQueuedChanged(QObject* object);
+    bool event(QEvent* event) override;
+    void ParseSnapshotRow(int row) const;
+    void CloseSnapshot() const;
+
+    bool changed_signal_emitted_ = false;
+    om::ChangeDispatcher::Entry dispatch_entry_{ this, &${type_name}::EmitQueuedChanged };
+    google::protobuf::RepeatedPtrField<${data_type}> own_data_;
+    google::protobuf::RepeatedPtrField<${data_type}>* data_ = nullptr;
+    // Читает простые свойства строк, для которых объекты не созданы
+    std::unique_ptr<${object_type}> reader_;
+    // Открытый снимок: сообщения строк созданы пустыми и разбираются из отображения файла при первом обращении
+    mutable std::unique_ptr<om::SnapshotFile> snapshot_;
+    mutable std::vector<bool> snapshot_parsed_;
+    mutable int snapshot_unparsed_count_ = 0;
+};
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include <test_qt_pb.h>
+
+#include <QCoreApplication>
+#include <benchmark/benchmark.h>
+#include <string>
+
+namespace
+{
+constexpr int kItemsCount = 1000;
+
+// Снимок сообщения Test с kItemsCount элементами повторяющегося поля, в котором изменена доля элементов в процентах.
+// Порты меняются без изменения размера сообщения, так что пропуск не решается одним сравнением размеров
+protogeneratorqt::Test CreateSnapshot(int changed_percent)
+{
+    protogeneratorqt::Test message;
+    message.set_integer_field(changed_percent == 100 ? 512 : 511);
+    message.set_string_field("GG WP");
+    message.set_state_integer(993);
+    message.mutable_ip_endpoint_field()->set_address("127.0.0.1");
+    message.mutable_ip_endpoint_field()->set_port(changed_percent == 100 ? 2 : 1);
+    message.mutable_optional_ip_endpoint()->set_address("192.168.0.1");
+    message.mutable_optional_ip_endpoint()->set_port(20);
+
+    // изменения распределены по всему полю
+    int changed_count = kItemsCount * changed_percent / 100;
+    int changed_step  = changed_count ? kItemsCount / changed_count : 0;
+    for (int i = 0; i < kItemsCount; ++i)
+    {
+        auto item = message.add_repeated_ip_endpoint();
+        item->set_address("10.0.0." + std::to_string(i % 256));
+        item->set_port(changed_step && i % changed_step == 0 ? 2001 + i : 2000 + i);
+    }
+    return message;
+}
+}  // namespace
+
+static void BM_CheckForChangedProperties(benchmark::State& state)
+{
+    protogeneratorqt::TestObject object(CreateSnapshot(0));
+    // вложенные объекты создаются при первом обращении, как у привязок QML
+    object.GetIpEndpointField();
+    object.GetOptionalIpEndpoint();
+    object.GetRepeatedIpEndpoint();
+    const auto snapshot = CreateSnapshot(state.range(0));
+    for (auto _ : state) object.CheckForChangedProperties(snapshot);
+}
+BENCHMARK(BM_CheckForChangedProperties)->Arg(0)->Arg(1)->Arg(100)->ArgName("changed_percent");
+
+// Set чередует два снимка, сигналы измененных свойств испускаются в каждой итерации
+static void BM_Set(benchmark::State& state)
+{
+    protogeneratorqt::TestObject object(CreateSnapshot(0));
+    object.GetIpEndpointField();
+    object.GetRepeatedIpEndpoint();
+    const protogeneratorqt::Test snapshots[] = { CreateSnapshot(0), CreateSnapshot(state.range(0)) };
+    int                          index       = 0;
+    for (auto _ : state)
+    {
+        object.Set(snapshots[index ^= 1]);
+        QCoreApplication::processEvents();
+    }
+}
+BENCHMARK(BM_Set)->Arg(1)->Arg(100)->ArgName("changed_percent");
+
+static void BM_Parse(benchmark::State& state)
+{
+    protogeneratorqt::TestObject object;
+    const auto                   serialized = CreateSnapshot(0).SerializeAsString();
+    const auto                   data       = QByteArray::fromStdString(serialized);
+    for (auto _ : state) benchmark::DoNotOptimize(object.Parse(data));
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_Parse);
+
+// Синхронизация всех элементов модели с их сообщениями с испусканием всех сигналов
+static void BM_ModelSyncData(benchmark::State& state)
+{
+    protogeneratorqt::TestObject object(CreateSnapshot(0));
+    auto                         model = object.GetRepeatedIpEndpoint();
+    for (int i = 0; i < model->rowCount(); ++i) model->At(i);
+    for (auto _ : state)
+    {
+        model->SyncData();
+        QCoreApplication::processEvents();
+    }
+    state.SetItemsProcessed(state.iterations() * model->rowCount());
+}
+BENCHMARK(BM_ModelSyncData);
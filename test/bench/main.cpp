@@ -0,0 +1,20 @@
+#include <QCoreApplication>
+#include <benchmark/benchmark.h>
+#include <cstdio>
+
+int main(int argc, char** argv)
+{
+    // сообщения библиотеки не смешиваются с результатами
+    qInstallMessageHandler([](QtMsgType type, const QMessageLogContext&, const QString& message) {
+        if (type != QtDebugMsg && type != QtInfoMsg)
+            fprintf(stderr, "%s\n", qPrintable(message));
+    });
+
+    QCoreApplication app(argc, argv);
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
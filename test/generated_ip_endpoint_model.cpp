@@ -3,7 +3,11 @@
 #include "qt_core_test.h"
 
 #include <google/protobuf/repeated_ptr_field.h>
+#include <QBuffer>
+#include <QTest>
+#include <array>
 #include <memory>
+#include <string>
 
 namespace prototest
 {
@@ -437,6 +441,370 @@ TEST_F(IpEndpointModelFixture, Last)
     EXPECT_EQ(last_element_third, nullptr);
 }
 
+//++> KeyedSync
+// ----------------------------------------------------------------------------------------------------
+
+TEST_F(IpEndpointModelFixture, KeyedSync)
+{
+    google::protobuf::RepeatedPtrField<protogeneratorqt::IpEndpoint> data_in_first;
+    data_in_first.Add(CreateIpEndpoint(kAddress1, kPort1));
+    data_in_first.Add(CreateIpEndpoint(kAddress2, kPort2));
+    data_in_first.Add(CreateIpEndpoint(kAddress3, kPort3));
+    ip_endpoint_model_->Set(data_in_first);
+    std::array<protogeneratorqt::IpEndpointObject*, 3> items = { ip_endpoint_model_->At(0), ip_endpoint_model_->At(1), ip_endpoint_model_->At(2) };
+    ProcessEvents(100);
+
+    ip_endpoint_model_->SetKeyedSync(true);
+    ip_endpoint_model_->SetSyncKey("address");
+    QSignalSpy rows_inserted(ip_endpoint_model_.get(), &protogeneratorqt::IpEndpointModel::rowsInserted);
+    QSignalSpy rows_removed(ip_endpoint_model_.get(), &protogeneratorqt::IpEndpointModel::rowsRemoved);
+    QSignalSpy rows_moved(ip_endpoint_model_.get(), &protogeneratorqt::IpEndpointModel::rowsMoved);
+    QSignalSpy model_reset(ip_endpoint_model_.get(), &protogeneratorqt::IpEndpointModel::modelReset);
+    QSignalSpy first_port(items[0], &protogeneratorqt::IpEndpointObject::portChanged);
+    QSignalSpy third_port(items[2], &protogeneratorqt::IpEndpointObject::portChanged);
+
+    // Новый элемент в начале, третий элемент изменен и перемещен перед вторым
+    google::protobuf::RepeatedPtrField<protogeneratorqt::IpEndpoint> data_in_second;
+    data_in_second.Add(CreateIpEndpoint(kAddress4, kPort4));
+    data_in_second.Add(CreateIpEndpoint(kAddress1, kPort1));
+    data_in_second.Add(CreateIpEndpoint(kAddress3, kPort4));
+    data_in_second.Add(CreateIpEndpoint(kAddress2, kPort2));
+    ip_endpoint_model_->Set(data_in_second);
+    ProcessEvents(100);
+
+    EXPECT_EQ(rows_inserted.count(), 1);
+    EXPECT_EQ(rows_moved.count(), 1);
+    EXPECT_EQ(rows_removed.count(), 0);
+    EXPECT_EQ(model_reset.count(), 0);
+    ASSERT_EQ(ip_endpoint_model_->rowCount(), 4);
+    EXPECT_EQ(ip_endpoint_model_->At(0)->GetAddress(), kAddress4);
+    EXPECT_EQ(ip_endpoint_model_->At(1), items[0]);
+    EXPECT_EQ(ip_endpoint_model_->At(2), items[2]);
+    EXPECT_EQ(ip_endpoint_model_->At(3), items[1]);
+    EXPECT_EQ(items[2]->GetPort(), kPort4);
+    EXPECT_EQ(items[2]->GetProtoMessage(), ip_endpoint_model_->GetProtoMessage()->Mutable(2));
+    // Сигналы свойств только у измененного элемента
+    EXPECT_EQ(first_port.count(), 0);
+    EXPECT_EQ(third_port.count(), 1);
+
+    // Удаление элемента
+    data_in_second.DeleteSubrange(0, 1);
+    ip_endpoint_model_->Set(data_in_second);
+    EXPECT_EQ(rows_removed.count(), 1);
+    EXPECT_EQ(rows_moved.count(), 1);
+    ASSERT_EQ(ip_endpoint_model_->rowCount(), 3);
+    EXPECT_EQ(ip_endpoint_model_->At(0), items[0]);
+
+    // Проверка без синхронизации не применяется к следующей синхронизации других данных того же размера
+    google::protobuf::RepeatedPtrField<protogeneratorqt::IpEndpoint> data_in_third(data_in_second.rbegin(), data_in_second.rend());
+    ip_endpoint_model_->CheckForChangedProperties(data_in_third);
+    ip_endpoint_model_->SyncData();
+    EXPECT_EQ(rows_moved.count(), 1);
+    EXPECT_EQ(ip_endpoint_model_->At(0), items[0]);
+    EXPECT_EQ(ip_endpoint_model_->At(2), items[1]);
+}
+
+//++> KeyedSyncReshuffle
+// ----------------------------------------------------------------------------------------------------
+
+TEST_F(IpEndpointModelFixture, KeyedSyncReshuffle)
+{
+    constexpr int kCount = 200;
+    google::protobuf::RepeatedPtrField<protogeneratorqt::IpEndpoint> data_in_first;
+    for (int i = 0; i < kCount; ++i) data_in_first.Add(CreateIpEndpoint(std::to_string(i).c_str(), kPort1));
+    ip_endpoint_model_->SetKeyedSync(true);
+    ip_endpoint_model_->SetSyncKey("address");
+    ip_endpoint_model_->Set(data_in_first);
+    auto first_item = ip_endpoint_model_->At(0);
+    auto last_item  = ip_endpoint_model_->At(kCount - 1);
+    ProcessEvents(100);
+
+    QSignalSpy rows_inserted(ip_endpoint_model_.get(), &protogeneratorqt::IpEndpointModel::rowsInserted);
+    QSignalSpy rows_moved(ip_endpoint_model_.get(), &protogeneratorqt::IpEndpointModel::rowsMoved);
+    QSignalSpy layout_changed(ip_endpoint_model_.get(), &protogeneratorqt::IpEndpointModel::layoutChanged);
+
+    // Обратный порядок и новые элементы двумя диапазонами: в начале и в конце
+    google::protobuf::RepeatedPtrField<protogeneratorqt::IpEndpoint> data_in_second;
+    data_in_second.Add(CreateIpEndpoint(kAddress1, kPort1));
+    data_in_second.Add(CreateIpEndpoint(kAddress2, kPort1));
+    for (int i = kCount - 1; i >= 0; --i) data_in_second.Add(CreateIpEndpoint(std::to_string(i).c_str(), kPort1));
+    data_in_second.Add(CreateIpEndpoint(kAddress3, kPort1));
+    ip_endpoint_model_->Set(data_in_second);
+
+    EXPECT_EQ(rows_moved.count(), 0);
+    EXPECT_EQ(layout_changed.count(), 1);
+    EXPECT_EQ(rows_inserted.count(), 2);
+    ASSERT_EQ(ip_endpoint_model_->rowCount(), kCount + 3);
+    EXPECT_EQ(ip_endpoint_model_->At(2), last_item);
+    EXPECT_EQ(ip_endpoint_model_->At(kCount + 1), first_item);
+    EXPECT_EQ(ip_endpoint_model_->At(1)->GetAddress(), kAddress2);
+    EXPECT_EQ(ip_endpoint_model_->At(kCount + 2)->GetAddress(), kAddress3);
+}
+
+//++> KeyedSyncRemoveRanges
+// ----------------------------------------------------------------------------------------------------
+
+TEST_F(IpEndpointModelFixture, KeyedSyncRemoveRanges)
+{
+    constexpr int kCount = 10;
+    google::protobuf::RepeatedPtrField<protogeneratorqt::IpEndpoint> data_in_first;
+    for (int i = 0; i < kCount; ++i) data_in_first.Add(CreateIpEndpoint(std::to_string(i).c_str(), kPort1));
+    ip_endpoint_model_->SetKeyedSync(true);
+    ip_endpoint_model_->SetSyncKey("address");
+    ip_endpoint_model_->Set(data_in_first);
+    auto first_item = ip_endpoint_model_->At(0);
+    ProcessEvents(100);
+
+    QSignalSpy model_reset(ip_endpoint_model_.get(), &protogeneratorqt::IpEndpointModel::modelReset);
+
+    // Удаляется больше половины строк тремя диапазонами: 1-2, 4-5, 7-8
+    const std::array<int, 4>                                         kept = { 0, 3, 6, 9 };
+    google::protobuf::RepeatedPtrField<protogeneratorqt::IpEndpoint> data_in_second;
+    for (auto i : kept) data_in_second.Add(CreateIpEndpoint(std::to_string(i).c_str(), kPort1));
+    ip_endpoint_model_->Set(data_in_second);
+
+    EXPECT_EQ(model_reset.count(), 1);
+    ASSERT_EQ(ip_endpoint_model_->rowCount(), static_cast<int>(kept.size()));
+    ASSERT_EQ(ip_endpoint_model_->Get().size(), static_cast<int>(kept.size()));
+    EXPECT_EQ(ip_endpoint_model_->At(0), first_item);
+    for (int row = 0; row < static_cast<int>(kept.size()); ++row)
+    {
+        EXPECT_EQ(ip_endpoint_model_->Get()[row].address(), std::to_string(kept[row]));
+        EXPECT_EQ(&ip_endpoint_model_->At(row)->Get(), &ip_endpoint_model_->Get()[row]);
+    }
+}
+
+//++> RemoveAllReset
+// ----------------------------------------------------------------------------------------------------
+
+TEST_F(IpEndpointModelFixture, RemoveAllReset)
+{
+    google::protobuf::RepeatedPtrField<protogeneratorqt::IpEndpoint> data_in;
+    for (auto port : { kPort1, kPort2, kPort1, kPort2, kPort1, kPort1 }) data_in.Add(CreateIpEndpoint(kAddress1, port));
+    ip_endpoint_model_->Set(data_in);
+    auto kept_item = ip_endpoint_model_->At(1);
+
+    QSignalSpy model_reset(ip_endpoint_model_.get(), &protogeneratorqt::IpEndpointModel::modelReset);
+
+    // Удаляются 4 строки из 6 тремя диапазонами: 0, 2, 4-5
+    ip_endpoint_model_->RemoveAll("port", kPort1);
+
+    EXPECT_EQ(model_reset.count(), 1);
+    ASSERT_EQ(ip_endpoint_model_->rowCount(), 2);
+    ASSERT_EQ(ip_endpoint_model_->Get().size(), 2);
+    EXPECT_EQ(ip_endpoint_model_->At(0), kept_item);
+    for (int row = 0; row < 2; ++row)
+    {
+        EXPECT_EQ(ip_endpoint_model_->Get()[row].port(), kPort2);
+        EXPECT_EQ(&ip_endpoint_model_->At(row)->Get(), &ip_endpoint_model_->Get()[row]);
+    }
+
+    // данные остались синхронизированными с элементами
+    ip_endpoint_model_->AppendCopy(kept_item);
+    ASSERT_EQ(ip_endpoint_model_->Get().size(), 3);
+    EXPECT_EQ(&ip_endpoint_model_->At(2)->Get(), &ip_endpoint_model_->Get()[2]);
+}
+
+//++> MoveAndInsert
+// ----------------------------------------------------------------------------------------------------
+TEST_F(IpEndpointModelFixture, MoveAndInsert)
+{
+    google::protobuf::RepeatedPtrField<protogeneratorqt::IpEndpoint> data_in;
+    data_in.Add(CreateIpEndpoint(kAddress1, kPort1));
+    data_in.Add(CreateIpEndpoint(kAddress2, kPort2));
+    data_in.Add(CreateIpEndpoint(kAddress3, kPort3));
+    ip_endpoint_model_->Set(data_in);
+    std::array<protogeneratorqt::IpEndpointObject*, 3> items = { ip_endpoint_model_->At(0), ip_endpoint_model_->At(1), ip_endpoint_model_->At(2) };
+    auto data = ip_endpoint_model_->GetProtoMessage();
+
+    // Перемещение первых двух элементов в конец
+    ip_endpoint_model_->Move(0, 1, 2);
+    ASSERT_EQ(data->size(), 3);
+    EXPECT_EQ(data->Get(0).address(), kAddress3);
+    EXPECT_EQ(data->Get(1).address(), kAddress1);
+    EXPECT_EQ(data->Get(2).address(), kAddress2);
+    EXPECT_EQ(ip_endpoint_model_->At(0), items[2]);
+    EXPECT_EQ(ip_endpoint_model_->At(2), items[1]);
+
+    // Перемещение последнего элемента в начало
+    ip_endpoint_model_->Move(2, 0);
+    EXPECT_EQ(data->Get(0).address(), kAddress2);
+    EXPECT_EQ(data->Get(1).address(), kAddress3);
+    EXPECT_EQ(data->Get(2).address(), kAddress1);
+
+    // Вставка в середину сохраняет порядок остальных элементов
+    ip_endpoint_model_->Insert(1, new protogeneratorqt::IpEndpointObject(CreateIpEndpoint(kAddress4, kPort4)));
+    ASSERT_EQ(data->size(), 4);
+    EXPECT_EQ(data->Get(0).address(), kAddress2);
+    EXPECT_EQ(data->Get(1).address(), kAddress4);
+    EXPECT_EQ(data->Get(2).address(), kAddress3);
+    EXPECT_EQ(data->Get(3).address(), kAddress1);
+    for (int row = 0; row < data->size(); ++row) EXPECT_EQ(ip_endpoint_model_->At(row)->GetProtoMessage(), data->Mutable(row));
+}
+
+//++> StreamAppend
+// ----------------------------------------------------------------------------------------------------
+TEST_F(IpEndpointModelFixture, StreamAppend)
+{
+    google::protobuf::RepeatedPtrField<protogeneratorqt::IpEndpoint> data_in;
+    for (int i = 0; i < 5; ++i) data_in.Add(CreateIpEndpoint(kAddress1, kPort1 + i));
+    protogeneratorqt::IpEndpointModel source(&data_in);
+    QBuffer written;
+    written.open(QIODevice::WriteOnly);
+    ASSERT_TRUE(source.WriteDelimited(&written));
+
+    QSignalSpy rows_inserted(ip_endpoint_model_.get(), &protogeneratorqt::IpEndpointModel::rowsInserted);
+    ip_endpoint_model_->BeginStreamAppend(2);
+    EXPECT_TRUE(ip_endpoint_model_->IsStreamAppending());
+
+    // Данные приходят двумя частями, граница проходит внутри третьего сообщения
+    auto split = written.data().indexOf(kAddress1, written.data().indexOf(kAddress1, written.data().indexOf(kAddress1) + 1) + 1) + 2;
+    QBuffer first_part;
+    first_part.setData(written.data().left(split));
+    first_part.open(QIODevice::ReadOnly);
+    EXPECT_EQ(ip_endpoint_model_->AppendDelimited(&first_part), 2);
+    EXPECT_EQ(ip_endpoint_model_->rowCount(), 2);
+
+    QBuffer second_part;
+    second_part.setData(written.data().mid(split));
+    second_part.open(QIODevice::ReadOnly);
+    EXPECT_EQ(ip_endpoint_model_->AppendDelimited(&second_part), 3);
+    EXPECT_TRUE(ip_endpoint_model_->EndStreamAppend());
+    EXPECT_FALSE(ip_endpoint_model_->IsStreamAppending());
+
+    // Одна вставка на порцию строк
+    EXPECT_EQ(rows_inserted.count(), 3);
+    ASSERT_EQ(ip_endpoint_model_->rowCount(), 5);
+    for (int i = 0; i < 5; ++i)
+    {
+        EXPECT_EQ(ip_endpoint_model_->At(i)->GetPort(), kPort1 + i);
+        EXPECT_EQ(ip_endpoint_model_->At(i)->GetProtoMessage(), ip_endpoint_model_->GetProtoMessage()->Mutable(i));
+    }
+
+    // Неполное сообщение в конце потока
+    QBuffer truncated;
+    truncated.setData(written.data().left(written.data().size() - 1));
+    truncated.open(QIODevice::ReadOnly);
+    EXPECT_EQ(ip_endpoint_model_->AppendDelimited(&truncated), 4);
+    EXPECT_FALSE(ip_endpoint_model_->EndStreamAppend());
+    EXPECT_EQ(ip_endpoint_model_->rowCount(), 9);
+}
+
+//++> ApplyAsync
+// ----------------------------------------------------------------------------------------------------
+TEST_F(IpEndpointModelFixture, ApplyAsync)
+{
+    google::protobuf::RepeatedPtrField<protogeneratorqt::IpEndpoint> data_in;
+    for (int i = 0; i < 3; ++i) data_in.Add(CreateIpEndpoint(kAddress1, kPort1 + i));
+    protogeneratorqt::IpEndpointModel source(&data_in);
+    QBuffer written;
+    written.open(QIODevice::WriteOnly);
+    ASSERT_TRUE(source.WriteDelimited(&written));
+
+    auto wait_applied = [this] {
+        for (int i = 0; i < 500 && ip_endpoint_model_->IsApplyingAsync(); ++i) QTest::qWait(10);
+        EXPECT_FALSE(ip_endpoint_model_->IsApplyingAsync());
+    };
+
+    // Первый вызов заменяется вторым до применения
+    ip_endpoint_model_->ApplyAsync(written.data().left(written.data().size() / 2));
+    ip_endpoint_model_->ApplyAsync(written.data());
+    wait_applied();
+    ASSERT_EQ(ip_endpoint_model_->rowCount(), 3);
+    for (int i = 0; i < 3; ++i)
+    {
+        EXPECT_EQ(ip_endpoint_model_->At(i)->GetPort(), kPort1 + i);
+        EXPECT_EQ(ip_endpoint_model_->At(i)->GetProtoMessage(), data_->Mutable(i));
+    }
+
+    // Изменяется только порт второго элемента, испорченные данные не применяются
+    auto item = ip_endpoint_model_->At(1);
+    QSignalSpy port_changed(item, &protogeneratorqt::IpEndpointObject::portChanged);
+    QSignalSpy address_changed(item, &protogeneratorqt::IpEndpointObject::addressChanged);
+    data_in.Mutable(1)->set_port(kPort4);
+    written.buffer().clear();
+    written.seek(0);
+    ASSERT_TRUE(source.WriteDelimited(&written));
+    ip_endpoint_model_->ApplyAsync(written.data());
+    wait_applied();
+    ip_endpoint_model_->ApplyAsync(written.data().left(written.data().size() - 1));
+    wait_applied();
+    ProcessEvents(100);
+    EXPECT_EQ(ip_endpoint_model_->At(1), item);
+    EXPECT_EQ(item->GetPort(), kPort4);
+    EXPECT_EQ(port_changed.count(), 1);
+    EXPECT_EQ(address_changed.count(), 0);
+    EXPECT_EQ(ip_endpoint_model_->rowCount(), 3);
+}
+
+//++> ApplyAsyncKeyed
+// Строки сопоставляются по ключам в пуле потоков, элементы, измененные после ApplyAsync, сравниваются заново
+// ----------------------------------------------------------------------------------------------------
+TEST_F(IpEndpointModelFixture, ApplyAsyncKeyed)
+{
+    auto write_delimited = [](const google::protobuf::RepeatedPtrField<protogeneratorqt::IpEndpoint>& data) {
+        google::protobuf::RepeatedPtrField<protogeneratorqt::IpEndpoint> copy(data);
+        protogeneratorqt::IpEndpointModel source(&copy);
+        QBuffer written;
+        written.open(QIODevice::WriteOnly);
+        EXPECT_TRUE(source.WriteDelimited(&written));
+        return written.data();
+    };
+    auto wait_applied = [this] {
+        for (int i = 0; i < 500 && ip_endpoint_model_->IsApplyingAsync(); ++i) QTest::qWait(10);
+        EXPECT_FALSE(ip_endpoint_model_->IsApplyingAsync());
+        ProcessEvents(100);
+    };
+
+    google::protobuf::RepeatedPtrField<protogeneratorqt::IpEndpoint> data_in_first;
+    data_in_first.Add(CreateIpEndpoint(kAddress1, kPort1));
+    data_in_first.Add(CreateIpEndpoint(kAddress2, kPort2));
+    data_in_first.Add(CreateIpEndpoint(kAddress3, kPort3));
+    ip_endpoint_model_->SetKeyedSync(true);
+    ip_endpoint_model_->SetSyncKey("address");
+    ip_endpoint_model_->ApplyAsync(write_delimited(data_in_first));
+    wait_applied();
+    ASSERT_EQ(ip_endpoint_model_->rowCount(), 3);
+    std::array<protogeneratorqt::IpEndpointObject*, 3> items = { ip_endpoint_model_->At(0), ip_endpoint_model_->At(1), ip_endpoint_model_->At(2) };
+
+    QSignalSpy rows_inserted(ip_endpoint_model_.get(), &protogeneratorqt::IpEndpointModel::rowsInserted);
+    QSignalSpy rows_moved(ip_endpoint_model_.get(), &protogeneratorqt::IpEndpointModel::rowsMoved);
+    QSignalSpy model_reset(ip_endpoint_model_.get(), &protogeneratorqt::IpEndpointModel::modelReset);
+    QSignalSpy first_port(items[0], &protogeneratorqt::IpEndpointObject::portChanged);
+    QSignalSpy third_port(items[2], &protogeneratorqt::IpEndpointObject::portChanged);
+
+    // Новый элемент в начале, третий элемент изменен и перемещен перед вторым
+    google::protobuf::RepeatedPtrField<protogeneratorqt::IpEndpoint> data_in_second;
+    data_in_second.Add(CreateIpEndpoint(kAddress4, kPort4));
+    data_in_second.Add(CreateIpEndpoint(kAddress1, kPort1));
+    data_in_second.Add(CreateIpEndpoint(kAddress3, kPort4));
+    data_in_second.Add(CreateIpEndpoint(kAddress2, kPort2));
+    auto second = write_delimited(data_in_second);
+    ip_endpoint_model_->ApplyAsync(second);
+    wait_applied();
+    EXPECT_EQ(rows_inserted.count(), 1);
+    EXPECT_EQ(rows_moved.count(), 1);
+    EXPECT_EQ(model_reset.count(), 0);
+    ASSERT_EQ(ip_endpoint_model_->rowCount(), 4);
+    EXPECT_EQ(ip_endpoint_model_->At(1), items[0]);
+    EXPECT_EQ(ip_endpoint_model_->At(2), items[2]);
+    EXPECT_EQ(ip_endpoint_model_->At(3), items[1]);
+    EXPECT_EQ(items[2]->GetPort(), kPort4);
+    EXPECT_EQ(first_port.count(), 0);
+    EXPECT_EQ(third_port.count(), 1);
+
+    // Элемент изменен сеттером после ApplyAsync: те же данные возвращают его значение
+    items[0]->SetPort(kPort3);
+    ip_endpoint_model_->ApplyAsync(second);
+    wait_applied();
+    EXPECT_EQ(ip_endpoint_model_->At(1), items[0]);
+    EXPECT_EQ(items[0]->GetPort(), kPort1);
+    EXPECT_EQ(first_port.count(), 2);
+    EXPECT_EQ(rows_inserted.count(), 1);
+    EXPECT_EQ(rows_moved.count(), 1);
+    for (int i = 0; i < 4; ++i) EXPECT_EQ(ip_endpoint_model_->At(i)->GetProtoMessage(), data_->Mutable(i));
+}
+
 // // ++> Take
 // // ----------------------------------------------------------------------------------------------------
 // TEST_F(IpEndpointModelFixture, Take)
@@ -1,3 +1,4 @@
+#include <QBuffer>
 #include <QByteArray>
 #include <QDebug>
 #include <QSignalSpy>
@@ -483,4 +484,96 @@ TEST_F(IpEndpointObjectFixture, ParseSerializeEmpty)
 TEST_F(IpEndpointObjectFixture, ParseSerializeEmptyFull)
 {
     ParseSerialized(false);
-}
\ No newline at end of file
+}
+
+//++> ParseSerializeDevice
+// Проверка чтения и записи через QIODevice и сериализации в готовый массив
+// ----------------------------------------------------------------------------------------------------
+
+TEST_F(IpEndpointObjectFixture, ParseSerializeDevice)
+{
+    ip_endpoint_object_->SetAddress(kAddress1);
+    ip_endpoint_object_->SetPort(kPort1);
+    IncAllSignals();
+    ApplicationCheckSignals();
+
+    QByteArray data;
+    ASSERT_TRUE(ip_endpoint_object_->SerializeTo(data));
+    EXPECT_EQ(data, ip_endpoint_object_->Serialize());
+    EXPECT_EQ(data.toStdString(), ip_endpoint_object_->Get().SerializeAsString());
+
+    QBuffer buffer;
+    buffer.open(QIODevice::ReadWrite);
+    ASSERT_TRUE(ip_endpoint_object_->Serialize(&buffer));
+    EXPECT_EQ(buffer.data(), data);
+
+    protogeneratorqt::IpEndpointObject parsed;
+    buffer.seek(0);
+    ASSERT_TRUE(parsed.Parse(&buffer));
+    EXPECT_EQ(parsed.GetAddress(), kAddress1);
+    EXPECT_EQ(parsed.GetPort(), kPort1);
+
+    // Массив с большей емкостью переиспользуется
+    ip_endpoint_object_->SetPort(kPort2);
+    auto storage = data.constData();
+    ASSERT_TRUE(ip_endpoint_object_->SerializeTo(data));
+    EXPECT_EQ(data.constData(), storage);
+    EXPECT_TRUE(parsed.Parse(data));
+    EXPECT_EQ(parsed.GetPort(), kPort2);
+    IncSignals({ kChanged, kPortChanged });
+    ApplicationCheckSignals();
+}
+
+//++> ApplyAsync
+// Разбор и сравнение в пуле потоков, применяется только последний вызов
+// ----------------------------------------------------------------------------------------------------
+
+TEST_F(IpEndpointObjectFixture, ApplyAsync)
+{
+    ip_endpoint_object_->SetAddress(kAddress1);
+    ip_endpoint_object_->SetPort(kPort1);
+    IncAllSignals();
+    ApplicationCheckSignals();
+
+    auto wait_applied = [this] {
+        for (int i = 0; i < 500 && ip_endpoint_object_->IsApplyingAsync(); ++i) QTest::qWait(10);
+        EXPECT_FALSE(ip_endpoint_object_->IsApplyingAsync());
+    };
+
+    // Результат первого вызова отбрасывается, в последнем изменился только порт
+    ip_endpoint_object_->ApplyAsync(QByteArray::fromStdString(CreateIpEndpoint(kAddress2, kPort2).SerializeAsString()));
+    ip_endpoint_object_->ApplyAsync(QByteArray::fromStdString(CreateIpEndpoint(kAddress1, kPort3).SerializeAsString()));
+    EXPECT_TRUE(ip_endpoint_object_->IsApplyingAsync());
+    wait_applied();
+    EXPECT_EQ(ip_endpoint_object_->GetAddress(), kAddress1);
+    EXPECT_EQ(ip_endpoint_object_->GetPort(), kPort3);
+    IncSignals({ kChanged, kPortChanged });
+    ApplicationCheckSignals();
+
+    // Неизмененные и испорченные данные не изменяют объект
+    ip_endpoint_object_->ApplyAsync(QByteArray::fromStdString(CreateIpEndpoint(kAddress1, kPort3).SerializeAsString()));
+    wait_applied();
+    ip_endpoint_object_->ApplyAsync(QByteArray("\xff\xff"));
+    wait_applied();
+    EXPECT_EQ(ip_endpoint_object_->GetPort(), kPort3);
+    ApplicationCheckSignals();
+
+    // Объект, измененный до применения результата, сравнивается заново
+    QSignalSpy address_changed(ip_endpoint_object_.get(), &protogeneratorqt::IpEndpointObject::addressChanged);
+    ip_endpoint_object_->ApplyAsync(QByteArray::fromStdString(CreateIpEndpoint(kAddress1, kPort4).SerializeAsString()));
+    ip_endpoint_object_->SetAddress(kAddress2);
+    wait_applied();
+    ProcessEvents(100);
+    EXPECT_EQ(ip_endpoint_object_->GetAddress(), kAddress1);
+    EXPECT_EQ(ip_endpoint_object_->GetPort(), kPort4);
+    EXPECT_EQ(address_changed.count(), 2);
+
+    // Объект, измененный сеттером после предыдущего ApplyAsync, не сравнивается с его сообщением
+    QSignalSpy port_changed(ip_endpoint_object_.get(), &protogeneratorqt::IpEndpointObject::portChanged);
+    ip_endpoint_object_->SetPort(kPort1);
+    ip_endpoint_object_->ApplyAsync(QByteArray::fromStdString(CreateIpEndpoint(kAddress1, kPort4).SerializeAsString()));
+    wait_applied();
+    ProcessEvents(100);
+    EXPECT_EQ(ip_endpoint_object_->GetPort(), kPort4);
+    EXPECT_EQ(port_changed.count(), 2);
+}
@@ -0,0 +1,225 @@
+﻿#include "data_test.h"
+#include "test_qt_pb.h"
+#include "qt_core_test.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtEndian>
+#include <google/protobuf/repeated_ptr_field.h>
+#include <limits>
+#include <memory>
+
+namespace prototest
+{
+enum IpEndpointVirtualModelSignals { kChanged = 0 };
+
+class IpEndpointVirtualModelFixture : public QtCoreTest
+{
+protected:
+    void SetUp() override;
+    void TearDown() override;
+    void SignalsTrackingSetUp() override;
+
+    // Проверка совпадения ожидаемого количества сигналов и пойманного
+    void CheckSignals() override;
+
+protected:
+    static constexpr int kRowsCount = 1000;
+
+    std::unique_ptr<google::protobuf::RepeatedPtrField<protogeneratorqt::IpEndpoint>> data_;
+    std::unique_ptr<protogeneratorqt::IpEndpointVirtualModel>                          model_;
+};
+
+void IpEndpointVirtualModelFixture::SetUp()
+{
+    AppSetUp();
+    data_ = std::make_unique<google::protobuf::RepeatedPtrField<protogeneratorqt::IpEndpoint>>();
+    for (int i = 0; i < kRowsCount; ++i) data_->Add(CreateIpEndpoint(kAddress1, i));
+    model_ = std::make_unique<protogeneratorqt::IpEndpointVirtualModel>(data_.get());
+    SignalsTrackingSetUp();
+}
+
+void IpEndpointVirtualModelFixture::TearDown()
+{
+    AppTearDown();
+    model_.reset();
+    data_.reset();
+}
+
+void IpEndpointVirtualModelFixture::SignalsTrackingSetUp()
+{
+    signals_counts_ = std::vector(1, 0);
+    signals_spies_.push_back(std::make_unique<QSignalSpy>(model_.get(), &protogeneratorqt::IpEndpointVirtualModel::changed));
+}
+
+void IpEndpointVirtualModelFixture::CheckSignals()
+{
+    EXPECT_EQ(signals_spies_[IpEndpointVirtualModelSignals::kChanged]->count(), signals_counts_[IpEndpointVirtualModelSignals::kChanged]);
+}
+
+//++> ReadRowsWithoutObjects
+// ----------------------------------------------------------------------------------------------------
+
+TEST_F(IpEndpointVirtualModelFixture, ReadRowsWithoutObjects)
+{
+    ASSERT_EQ(model_->rowCount(), kRowsCount);
+    for (int row = 0; row < kRowsCount; ++row)
+    {
+        EXPECT_EQ(model_->GetData(row, "port").toInt(), row);
+        EXPECT_EQ(model_->GetValue<int>(row, model_->GetRoleId("port")), row);
+        EXPECT_EQ(model_->GetData(row, "address").toString(), kAddress1);
+    }
+    // Объекты строк не создаются для чтения простых ролей
+    EXPECT_EQ(model_->GetItemsCount(), 0);
+}
+
+//++> CreateObjectsOnDemand
+// ----------------------------------------------------------------------------------------------------
+
+TEST_F(IpEndpointVirtualModelFixture, CreateObjectsOnDemand)
+{
+    auto item = model_->At(10);
+    ASSERT_NE(item, nullptr);
+    EXPECT_EQ(item->GetProtoMessage(), data_->Mutable(10));
+    EXPECT_EQ(model_->GetItemsCount(), 1);
+    EXPECT_EQ(model_->GetData(10, om::AbstractObjectModel::kItemRoleName).value<QObject*>(), item);
+
+    // Изменения объекта пишутся в данные
+    item->SetPort(kPort4);
+    EXPECT_EQ(data_->Get(10).port(), kPort4);
+    EXPECT_EQ(model_->GetData(10, "port").toInt(), kPort4);
+
+    // Запись данных создает объект строки
+    EXPECT_TRUE(model_->SetData(20, kAddress2, "address"));
+    EXPECT_EQ(data_->Get(20).address(), kAddress2);
+    EXPECT_TRUE(model_->HasItem(20));
+    EXPECT_EQ(model_->GetItemsCount(), 2);
+    IncAllSignals();
+    ApplicationCheckSignals(100);
+}
+
+//++> ReleaseIdleObjects
+// ----------------------------------------------------------------------------------------------------
+
+TEST_F(IpEndpointVirtualModelFixture, ReleaseIdleObjects)
+{
+    model_->SetMaxItems(2);
+    for (int row = 0; row < 5; ++row) model_->At(row);
+    // Объекты удаляются после возврата в цикл событий
+    EXPECT_EQ(model_->GetItemsCount(), 5);
+    ProcessEvents(100);
+    EXPECT_EQ(model_->GetItemsCount(), 2);
+    EXPECT_TRUE(model_->HasItem(3));
+    EXPECT_TRUE(model_->HasItem(4));
+
+    // Объект с подключенными сигналами свойств используется и не удаляется
+    QSignalSpy port_signal(model_->At(0), &protogeneratorqt::IpEndpointObject::portChanged);
+    model_->At(1);
+    model_->At(2);
+    ProcessEvents(100);
+    EXPECT_TRUE(model_->HasItem(0));
+    EXPECT_EQ(model_->GetItemsCount(), 2);
+
+    model_->ReleaseItems();
+    EXPECT_EQ(model_->GetItemsCount(), 1);
+    EXPECT_TRUE(model_->HasItem(0));
+}
+
+//++> AppendRemove
+// ----------------------------------------------------------------------------------------------------
+
+TEST_F(IpEndpointVirtualModelFixture, AppendRemove)
+{
+    QSignalSpy rows_inserted(model_.get(), &QAbstractItemModel::rowsInserted);
+    QSignalSpy rows_removed(model_.get(), &QAbstractItemModel::rowsRemoved);
+
+    auto item = model_->At(kRowsCount - 1);
+    model_->Append(CreateIpEndpoint(kAddress3, kPort3));
+    EXPECT_EQ(rows_inserted.count(), 1);
+    ASSERT_EQ(model_->rowCount(), kRowsCount + 1);
+    EXPECT_EQ(data_->size(), kRowsCount + 1);
+    EXPECT_EQ(model_->GetData(kRowsCount, "address").toString(), kAddress3);
+    EXPECT_EQ(model_->At(kRowsCount - 1), item);
+
+    model_->Remove(0, 2);
+    EXPECT_EQ(rows_removed.count(), 1);
+    ASSERT_EQ(model_->rowCount(), kRowsCount - 1);
+    EXPECT_EQ(data_->size(), kRowsCount - 1);
+    EXPECT_EQ(model_->GetData(0, "port").toInt(), 2);
+    // Объекты остальных строк указывают на свои сообщения
+    EXPECT_EQ(model_->At(kRowsCount - 3), item);
+    EXPECT_EQ(item->GetPort(), kRowsCount - 1);
+
+    model_->Clear();
+    EXPECT_EQ(model_->rowCount(), 0);
+    EXPECT_EQ(data_->size(), 0);
+    EXPECT_EQ(model_->GetItemsCount(), 0);
+    IncAllSignals();
+    ApplicationCheckSignals(100);
+}
+
+//++> Snapshot
+// ----------------------------------------------------------------------------------------------------
+
+TEST_F(IpEndpointVirtualModelFixture, Snapshot)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    auto file_path = dir.filePath("ip_endpoints.snapshot");
+    ASSERT_TRUE(protogeneratorqt::IpEndpointVirtualModel::WriteSnapshot(file_path, *data_));
+
+    protogeneratorqt::IpEndpointVirtualModel model;
+    EXPECT_FALSE(model.OpenSnapshot(dir.filePath("absent.snapshot")));
+    ASSERT_TRUE(model.OpenSnapshot(file_path));
+    // Количество строк известно сразу, сообщения разбираются при обращении к строкам
+    EXPECT_TRUE(model.IsSnapshotOpened());
+    EXPECT_EQ(model.rowCount(), kRowsCount);
+    EXPECT_EQ(model.GetItemsCount(), 0);
+    EXPECT_EQ(model.GetData(10, "port").toInt(), 10);
+    EXPECT_EQ(model.At(kRowsCount - 1)->GetPort(), kRowsCount - 1);
+    EXPECT_EQ(model.GetData(20, "address").toString(), kAddress1);
+
+    // Полный разбор закрывает файл
+    model.ParseSnapshot();
+    EXPECT_FALSE(model.IsSnapshotOpened());
+    ASSERT_EQ(model.Get().size(), kRowsCount);
+    for (int row = 0; row < kRowsCount; ++row) EXPECT_EQ(model.Get().Get(row).port(), row);
+
+    // Запись из модели заменяет файл целиком
+    model.Remove(0, kRowsCount - 1);
+    ASSERT_TRUE(model.WriteSnapshot(file_path));
+    ASSERT_TRUE(model_->OpenSnapshot(file_path));
+    EXPECT_EQ(model_->rowCount(), 1);
+    EXPECT_EQ(model_->Get().Get(0).port(), kRowsCount - 1);
+    EXPECT_FALSE(model_->IsSnapshotOpened());
+    IncAllSignals();
+    ApplicationCheckSignals(100);
+}
+
+//++> SnapshotRecordOutOfFile
+// ----------------------------------------------------------------------------------------------------
+
+TEST_F(IpEndpointVirtualModelFixture, SnapshotRecordOutOfFile)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    auto file_path = dir.filePath("ip_endpoints.snapshot");
+    ASSERT_TRUE(protogeneratorqt::IpEndpointVirtualModel::WriteSnapshot(file_path, *data_));
+
+    // Смещение первой записи у конца диапазона quint64: сумма смещения и размера записи переполняется
+    QFile file(file_path);
+    ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+    constexpr qint64 kIndexOffset = 16;
+    char offset[sizeof(quint64)];
+    qToLittleEndian<quint64>(std::numeric_limits<quint64>::max() - 1, offset);
+    ASSERT_TRUE(file.seek(kIndexOffset));
+    ASSERT_EQ(file.write(offset, sizeof(offset)), static_cast<qint64>(sizeof(offset)));
+    file.close();
+
+    om::SnapshotFile snapshot;
+    ASSERT_TRUE(snapshot.Open(file_path));
+    int size = 0;
+    EXPECT_EQ(snapshot.GetRecord(0, &size), nullptr);
+    EXPECT_NE(snapshot.GetRecord(1, &size), nullptr);
+}
+}  // namespace prototest
@@ -634,6 +634,154 @@ TEST_F(TestObjectFixture, RevokeProtoMessageOwnership)
     EXPECT_EQ(message->integer_field(), 0);
 }
 
+//++> RevokeProtoMessageOwnershipArena
+// ----------------------------------------------------------------------------------------------------
+
+TEST_F(TestObjectFixture, RevokeProtoMessageOwnershipArena)
+{
+    PresetDataOne();
+    test_object_->Set(*test_);
+    test_object_->SetArenaEnabled(true);
+    auto optional_ip_endpoint = test_object_->GetOptionalIpEndpoint();
+
+    // Сообщение переносится с арены в кучу, вложенные объекты указывают на новое сообщение
+    test_object_->RevokeProtoMessageOwnership();
+    EXPECT_FALSE(test_object_->IsArenaEnabled());
+    std::unique_ptr<protogeneratorqt::Test> message(test_object_->GetProtoMessage());
+    EXPECT_EQ(message->GetArena(), nullptr);
+    EXPECT_EQ(optional_ip_endpoint->GetProtoMessage(), message->mutable_optional_ip_endpoint());
+    EXPECT_EQ(test_object_->GetRepeatedIpEndpoint()->At(0)->GetProtoMessage(), message->mutable_repeated_ip_endpoint(0));
+
+    // Объект больше не владеет сообщением и не может включить арену
+    EXPECT_THROW(test_object_->SetArenaEnabled(true), std::logic_error);
+    test_object_.reset();
+    EXPECT_TRUE(google::protobuf::util::MessageDifferencer::Equals(*message, *test_));
+}
+
+//++> ArenaEnabled
+// ----------------------------------------------------------------------------------------------------
+
+TEST_F(TestObjectFixture, ArenaEnabled)
+{
+    PresetDataOne();
+    test_object_->Set(*test_);
+    EXPECT_FALSE(test_object_->IsArenaEnabled());
+    EXPECT_EQ(test_object_->GetProtoMessage()->GetArena(), nullptr);
+
+    test_object_->SetArenaEnabled(true);
+    auto arena = test_object_->GetProtoMessage()->GetArena();
+    ASSERT_NE(arena, nullptr);
+    EXPECT_TRUE(test_object_->EqualsTo(*test_));
+    EXPECT_EQ(test_object_->GetOptionalIpEndpoint()->GetAddress(), kAddress1);
+    EXPECT_EQ(test_object_->GetOptionalIpEndpoint()->GetProtoMessage()->GetArena(), arena);
+
+    // Новые элементы модели создаются на арене объекта
+    protogeneratorqt::IpEndpointObject ip_endpoint(CreateIpEndpoint(kAddress1, kPort1));
+    auto new_item = test_object_->GetRepeatedIpEndpoint()->AppendCopy(&ip_endpoint);
+    EXPECT_EQ(new_item->GetProtoMessage()->GetArena(), arena);
+    ASSERT_EQ(test_object_->GetProtoMessage()->repeated_ip_endpoint_size(), 2);
+    EXPECT_EQ(test_object_->GetProtoMessage()->repeated_ip_endpoint(1).address(), kAddress1);
+
+    // Элемент с сообщением в куче забирается ареной без копирования
+    auto heap_item = new protogeneratorqt::IpEndpointObject(CreateIpEndpoint(kAddress2, kPort2));
+    auto heap_message = heap_item->GetProtoMessage();
+    test_object_->GetRepeatedIpEndpoint()->Append(heap_item);
+    EXPECT_EQ(heap_item->GetProtoMessage(), heap_message);
+    EXPECT_EQ(test_object_->GetProtoMessage()->mutable_repeated_ip_endpoint(2), heap_message);
+
+    test_object_->Reset();
+    EXPECT_TRUE(test_object_->IsArenaEnabled());
+    EXPECT_NE(test_object_->GetProtoMessage()->GetArena(), nullptr);
+    EXPECT_EQ(test_object_->GetProtoMessage()->repeated_ip_endpoint_size(), 0);
+    EXPECT_EQ(test_object_->GetIntegerField(), 0);
+
+    test_object_->Set(*test_);
+    test_object_->SetArenaEnabled(false);
+    EXPECT_EQ(test_object_->GetProtoMessage()->GetArena(), nullptr);
+    EXPECT_TRUE(test_object_->EqualsTo(*test_));
+}
+
+//++> CheckForChangedByFingerprint
+// ----------------------------------------------------------------------------------------------------
+
+TEST_F(TestObjectFixture, CheckForChangedByFingerprint)
+{
+    PresetDataOne();
+    test_object_->Set(*test_);
+    IncSignals({ TestObjectSignals::kChanged, TestObjectSignals::kOptionalIpEndpoint, TestObjectSignals::kOptionalEnum, TestObjectSignals::kStringField,
+        TestObjectSignals::kIntegerField, TestObjectSignals::kState });
+    ApplicationCheckSignals();
+
+    // Неизмененное сообщение пропускается целиком
+    test_object_->Set(*test_);
+    ApplicationCheckSignals();
+
+    // Изменение вложенного сообщения без изменения размера находится побайтным сравнением
+    QSignalSpy port_changed(test_object_->GetOptionalIpEndpoint(), &protogeneratorqt::IpEndpointObject::portChanged);
+    QSignalSpy item_port_changed(test_object_->GetRepeatedIpEndpoint()->At(0), &protogeneratorqt::IpEndpointObject::portChanged);
+    test_->mutable_optional_ip_endpoint()->set_port(kPort2);
+    test_object_->Set(*test_);
+    ProcessEvents();
+    EXPECT_EQ(port_changed.count(), 1);
+    EXPECT_EQ(item_port_changed.count(), 0);
+    EXPECT_EQ(test_object_->GetOptionalIpEndpoint()->GetPort(), kPort2);
+
+    // Элемент повторяющегося поля сравнивается по своей части байтов сообщения, неизмененные вложенные объекты пропускаются
+    test_->mutable_repeated_ip_endpoint(0)->set_port(kPort1);
+    test_object_->Set(*test_);
+    ProcessEvents();
+    EXPECT_EQ(port_changed.count(), 1);
+    EXPECT_EQ(item_port_changed.count(), 1);
+    EXPECT_EQ(test_object_->GetRepeatedIpEndpoint()->At(0)->GetPort(), kPort1);
+}
+
+//++> ApplyAsyncNested
+// Изменения вложенных объектов и моделей после ApplyAsync учитываются следующим ApplyAsync
+// ----------------------------------------------------------------------------------------------------
+
+TEST_F(TestObjectFixture, ApplyAsyncNested)
+{
+    PresetDataOne();
+    auto data = QByteArray::fromStdString(test_->SerializeAsString());
+    auto wait_applied = [this] {
+        for (int i = 0; i < 500 && test_object_->IsApplyingAsync(); ++i) QTest::qWait(10);
+        EXPECT_FALSE(test_object_->IsApplyingAsync());
+        ProcessEvents(100);
+    };
+    test_object_->ApplyAsync(data);
+    wait_applied();
+    EXPECT_TRUE(test_object_->EqualsTo(*test_));
+
+    // Вложенный объект изменен своим сеттером: те же данные возвращают его значение
+    auto optional_ip_endpoint = test_object_->GetOptionalIpEndpoint();
+    QSignalSpy port_changed(optional_ip_endpoint, &protogeneratorqt::IpEndpointObject::portChanged);
+    optional_ip_endpoint->SetPort(kPort4);
+    test_object_->ApplyAsync(data);
+    wait_applied();
+    EXPECT_EQ(optional_ip_endpoint->GetPort(), kPort1);
+    EXPECT_EQ(port_changed.count(), 2);
+
+    // Элемент модели и модель строк изменены после ApplyAsync
+    auto item = test_object_->GetRepeatedIpEndpoint()->At(0);
+    QSignalSpy item_port_changed(item, &protogeneratorqt::IpEndpointObject::portChanged);
+    item->SetPort(kPort4);
+    test_object_->GetRepeatedString()->Append("Extra");
+    test_object_->ApplyAsync(data);
+    wait_applied();
+    EXPECT_EQ(test_object_->GetRepeatedIpEndpoint()->At(0), item);
+    EXPECT_EQ(item->GetPort(), kPort2);
+    EXPECT_EQ(item_port_changed.count(), 2);
+    EXPECT_EQ(test_object_->GetRepeatedString()->rowCount(), 1);
+    EXPECT_TRUE(test_object_->EqualsTo(*test_));
+
+    // Неизмененные данные сравниваются с образцом предыдущего ApplyAsync и не испускают сигналов
+    test_object_->ApplyAsync(data);
+    wait_applied();
+    EXPECT_EQ(port_changed.count(), 2);
+    EXPECT_EQ(item_port_changed.count(), 2);
+    EXPECT_TRUE(test_object_->EqualsTo(*test_));
+}
+
 //++> SetGetClearStateCase
 // ----------------------------------------------------------------------------------------------------
 